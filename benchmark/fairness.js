@@ -0,0 +1,114 @@
+// measures round trip latency of quiet associations while others are busy
+//
+// usage: node benchmark/fairness.js [numberOfQuietAssociations] [numberOfBusyAssociations] [seconds]
+//
+// busy associations send as fast as backpressure allows, every quiet one
+// sends a message every millisecond which the server echoes, the latency
+// percentiles of the quiet associations show how well busy ones are
+// kept from starving them
+
+const perf_hooks = require("node:perf_hooks");
+const benchmark = require("./lib/index.js");
+
+const performance = perf_hooks.performance;
+
+const port = 12350;
+const numberOfQuietAssociations = parseInt(process.argv[2] || "16", 10);
+const numberOfBusyAssociations = parseInt(process.argv[3] || "4", 10);
+const seconds = parseFloat(process.argv[4] || "5");
+const busyMessageSize = 1024;
+
+const busyMessage = Buffer.alloc(busyMessageSize);
+
+// only pings are echoed
+const echoPings = (connection) => {
+  connection.on("data", (data) => {
+    if (data.length === 8) {
+      connection.write(data);
+    }
+  });
+};
+
+const sendBusy = ({ client, isRunning }) => {
+  const sendMore = () => {
+    while (isRunning()) {
+      if (!client.write(busyMessage)) {
+        client.once("drain", sendMore);
+        return;
+      }
+    }
+  };
+
+  sendMore();
+};
+
+const pingQuiet = ({ client, latencies }) => {
+  client.on("data", (data) => {
+    latencies.push(performance.now() - data.readDoubleLE(0));
+  });
+
+  return setInterval(() => {
+    const ping = Buffer.alloc(8);
+    ping.writeDoubleLE(performance.now(), 0);
+    client.write(ping);
+  }, 1);
+};
+
+const percentile = ({ sorted, p }) => {
+  if (sorted.length === 0) {
+    return NaN;
+  }
+
+  return Number(sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))].toFixed(3));
+};
+
+benchmark.runMain(async () => {
+  const server = await benchmark.listen({
+    port,
+    backlog: numberOfQuietAssociations + numberOfBusyAssociations,
+    onConnection: echoPings
+  });
+
+  const quietClients = await benchmark.connectMany({ port, count: numberOfQuietAssociations });
+  const busyClients = await benchmark.connectMany({ port, count: numberOfBusyAssociations });
+
+  let running = true;
+  const isRunning = () => {
+    return running;
+  };
+
+  const latencies = [];
+  const pingTimers = quietClients.map((client) => {
+    return pingQuiet({ client, latencies });
+  });
+
+  busyClients.forEach((client) => {
+    sendBusy({ client, isRunning });
+  });
+
+  await benchmark.sleep({ seconds });
+
+  running = false;
+  pingTimers.forEach((timer) => {
+    clearInterval(timer);
+  });
+
+  const sorted = latencies.sort((a, b) => {
+    return a - b;
+  });
+
+  console.table([{
+    quiet: numberOfQuietAssociations,
+    busy: numberOfBusyAssociations,
+    pings: sorted.length,
+    p50Ms: percentile({ sorted, p: 0.5 }),
+    p99Ms: percentile({ sorted, p: 0.99 }),
+    p999Ms: percentile({ sorted, p: 0.999 }),
+    maxMs: percentile({ sorted, p: 1 })
+  }]);
+
+  [...quietClients, ...busyClients].forEach((client) => {
+    client.destroy();
+  });
+  server.close();
+});
@@ -0,0 +1,97 @@
+// opens a number of idle associations and reports memory used per association
+//
+// usage: node --expose-gc benchmark/idle-associations.js [numberOfAssociations]
+//
+// both ends of every association live in this process, so one association
+// accounts for two sockets
+
+const lksctp = require("../lib/index.js");
+
+const port = 12346;
+const numberOfAssociations = parseInt(process.argv[2] || "1000", 10);
+
+const collectGarbage = () => {
+  if (global.gc === undefined) {
+    console.warn("run with --expose-gc for more accurate numbers");
+    return;
+  }
+
+  global.gc();
+};
+
+const measure = () => {
+  collectGarbage();
+
+  const { rss, arrayBuffers } = process.memoryUsage();
+  return { rss, arrayBuffers };
+};
+
+const report = ({ before, after }) => {
+  const rssPerAssociation = (after.rss - before.rss) / numberOfAssociations;
+  const arrayBuffersPerAssociation = (after.arrayBuffers - before.arrayBuffers) / numberOfAssociations;
+
+  console.log({
+    numberOfAssociations,
+    rssBefore: before.rss,
+    rssAfter: after.rss,
+    rssPerAssociation: Math.round(rssPerAssociation),
+    arrayBuffersPerAssociation: Math.round(arrayBuffersPerAssociation)
+  });
+};
+
+const before = measure();
+
+const server = lksctp.createServer();
+
+let serverConnections = [];
+let clients = [];
+let connected = 0;
+
+const maybeReport = () => {
+  if (connected < numberOfAssociations * 2) {
+    return;
+  }
+
+  // let pending microtasks and timers settle
+  setTimeout(() => {
+    const after = measure();
+    report({ before, after });
+
+    clients.forEach((client) => {
+      client.destroy();
+    });
+
+    serverConnections.forEach((connection) => {
+      connection.destroy();
+    });
+
+    server.close();
+  }, 1000);
+};
+
+server.on("error", (error) => {
+  console.error("server error", error);
+});
+
+server.on("connection", (connection) => {
+  serverConnections = [...serverConnections, connection];
+  connected += 1;
+  maybeReport();
+});
+
+server.listen({ host: "127.0.0.1", port, backlog: numberOfAssociations }, () => {
+  for (let i = 0; i < numberOfAssociations; i += 1) {
+    const client = lksctp.connect({ host: "127.0.0.1", port });
+
+    client.on("connect", () => {
+      connected += 1;
+      maybeReport();
+    });
+
+    client.on("error", (error) => {
+      console.error("client error", error);
+    });
+
+    clients = [...clients, client];
+  }
+});
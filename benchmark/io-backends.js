@@ -0,0 +1,38 @@
+// compares message throughput of the io backends on loopback
+//
+// usage: node benchmark/io-backends.js [numberOfAssociations] [messagesPerAssociation]
+//
+// every association sends its messages from client to server as fast as
+// backpressure allows, each backend runs the same load one after another
+
+const ioUring = require("../lib/io-uring.js");
+const benchmark = require("./lib/index.js");
+
+const port = 12347;
+const numberOfAssociations = parseInt(process.argv[2] || "16", 10);
+const messagesPerAssociation = parseInt(process.argv[3] || "100000", 10);
+const messageSize = 270;
+
+const backends = ["poll", "thread", "io_uring"];
+
+benchmark.runMain(async () => {
+  const results = [];
+
+  if (!ioUring.isAvailable()) {
+    console.warn("io_uring is not available, its numbers are those of the poll backend");
+  }
+
+  for (const ioBackend of backends) {
+    const result = await benchmark.measureThroughput({
+      port,
+      numberOfAssociations,
+      messagesPerAssociation,
+      messageSize,
+      options: { ioBackend }
+    });
+
+    results.push({ ioBackend, ...result });
+  }
+
+  console.table(results);
+});
@@ -0,0 +1,31 @@
+// compares message throughput of duplex sockets and lean associations on loopback
+//
+// usage: node benchmark/lean-association.js [numberOfAssociations] [messagesPerAssociation]
+//
+// every association sends its messages from client to server as fast as
+// backpressure allows, both apis run the same load one after another
+
+const benchmark = require("./lib/index.js");
+
+const port = 12348;
+const numberOfAssociations = parseInt(process.argv[2] || "16", 10);
+const messagesPerAssociation = parseInt(process.argv[3] || "100000", 10);
+const messageSize = 270;
+
+benchmark.runMain(async () => {
+  const results = [];
+
+  for (const lean of [false, true]) {
+    const result = await benchmark.measureThroughput({
+      port,
+      numberOfAssociations,
+      messagesPerAssociation,
+      messageSize,
+      options: { lean }
+    });
+
+    results.push({ api: lean ? "lean" : "duplex", ...result });
+  }
+
+  console.table(results);
+});
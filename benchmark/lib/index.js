@@ -1,6 +1,7 @@
 /* eslint-disable max-statements */
 
 const perf_hooks = require("node:perf_hooks");
+const lksctp = require("../../lib/index.js");
 
 const performance = perf_hooks.performance;
 
@@ -125,6 +126,152 @@ const run = ({ server, connect }) => {
   }
 };
 
+// helpers of the loopback benchmarks, which compare variants of the same load
+
+const createRandomMessage = ({ size }) => {
+  const message = Buffer.alloc(size);
+  for (let i = 0; i < message.length; i += 1) {
+    message[i] = Math.floor(Math.random() * 256);
+  }
+
+  return message;
+};
+
+// options are passed to createServer(), e.g. ioBackend or lean
+const listen = ({ port, backlog, options = {}, onConnection }) => {
+  return new Promise((resolve, reject) => {
+    const server = lksctp.createServer(options);
+
+    server.on("error", reject);
+    server.on("connection", onConnection);
+
+    server.listen({ host: "127.0.0.1", port, backlog }, () => {
+      resolve(server);
+    });
+  });
+};
+
+const connect = ({ port, options = {} }) => {
+  return new Promise((resolve, reject) => {
+    const client = lksctp.connect({ host: "127.0.0.1", port, ...options });
+
+    client.on("error", reject);
+    client.on("connect", () => {
+      resolve(client);
+    });
+  });
+};
+
+// one after another, so the backlog is never exceeded
+const connectMany = async ({ port, count, options }) => {
+  const clients = [];
+  for (let i = 0; i < count; i += 1) {
+    clients.push(await connect({ port, options }));
+  }
+
+  return clients;
+};
+
+// sends as fast as backpressure allows, then ends the association
+const sendAll = ({ client, lean, message, count }) => {
+  let sent = 0;
+
+  const sendMore = () => {
+    while (sent < count) {
+      sent += 1;
+
+      const accepted = lean ? client.send(message) : client.write(message);
+      if (!accepted) {
+        client.once("drain", sendMore);
+        return;
+      }
+    }
+
+    client.end();
+  };
+
+  sendMore();
+};
+
+// every association sends its messages from client to server, with the
+// same options on both sides, resolves to throughput and cpu time
+const measureThroughput = async ({ port, numberOfAssociations, messagesPerAssociation, messageSize, options = {} }) => {
+  const expected = numberOfAssociations * messagesPerAssociation;
+  const message = createRandomMessage({ size: messageSize });
+  let received = 0;
+  let resolveDone = undefined;
+
+  const done = new Promise((resolve) => {
+    resolveDone = resolve;
+  });
+
+  const onMessage = () => {
+    received += 1;
+    if (received === expected) {
+      resolveDone();
+    }
+  };
+
+  const server = await listen({
+    port,
+    backlog: numberOfAssociations,
+    options,
+    onConnection: (connection) => {
+      if (options.lean) {
+        connection.onMessage = onMessage;
+      } else {
+        connection.on("data", onMessage);
+      }
+    }
+  });
+
+  const clients = await connectMany({ port, count: numberOfAssociations, options });
+
+  const start = performance.now();
+  const cpuStart = process.cpuUsage();
+
+  clients.forEach((client) => {
+    sendAll({ client, lean: options.lean, message, count: messagesPerAssociation });
+  });
+
+  await done;
+
+  const seconds = (performance.now() - start) / 1000;
+  const cpu = process.cpuUsage(cpuStart);
+
+  clients.forEach((client) => {
+    client.destroy();
+  });
+  server.close();
+
+  return {
+    messagesPerSecond: Math.round(expected / seconds),
+    megabytesPerSecond: Math.round(expected * messageSize / seconds / 1e6),
+    cpuSecondsPerMillionMessages: Number(((cpu.user + cpu.system) / 1e6 / (expected / 1e6)).toFixed(3))
+  };
+};
+
+const sleep = ({ seconds }) => {
+  return new Promise((resolve) => {
+    setTimeout(resolve, seconds * 1000);
+  });
+};
+
+const runMain = (main) => {
+  main().catch((error) => {
+    console.error(error);
+    process.exitCode = 1;
+  });
+};
+
 module.exports = {
-  run
+  run,
+  createRandomMessage,
+  listen,
+  connect,
+  connectMany,
+  sendAll,
+  measureThroughput,
+  sleep,
+  runMain
 };
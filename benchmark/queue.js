@@ -0,0 +1,59 @@
+// measures how long it takes to fill and drain queues of growing depth
+//
+// usage: node benchmark/queue.js
+//
+// drain time per entry should stay about constant, a queue that copies
+// on every dequeue would show time per entry growing with the depth
+
+const queueFactory = require("../lib/queue.js");
+const microtaskSchedulerFactory = require("../lib/microtask-scheduler.js");
+
+const depths = [1000, 10000, 50000, 100000, 200000];
+
+const measureQueue = ({ depth }) => {
+  const queue = queueFactory.create();
+
+  const start = process.hrtime.bigint();
+
+  for (let i = 0; i < depth; i += 1) {
+    queue.push({ chunks: [], sent: 0, callback: undefined });
+  }
+
+  while (queue.length > 0) {
+    queue.shift();
+  }
+
+  return Number(process.hrtime.bigint() - start);
+};
+
+const measureScheduler = async ({ depth }) => {
+  // no limit per macrotask, so the whole queue drains in one go
+  const scheduler = microtaskSchedulerFactory.create({ maxMicrotasksPerMacrotask: Infinity });
+
+  const start = process.hrtime.bigint();
+
+  await new Promise((resolve) => {
+    for (let i = 0; i < depth - 1; i += 1) {
+      scheduler.scheduleMicrotask(() => {});
+    }
+
+    scheduler.scheduleMicrotask(resolve);
+  });
+
+  return Number(process.hrtime.bigint() - start);
+};
+
+const run = async () => {
+  for (const depth of depths) {
+    const queueNanoseconds = measureQueue({ depth });
+    const schedulerNanoseconds = await measureScheduler({ depth });
+
+    console.log({
+      depth,
+      queueNanosecondsPerEntry: Math.round(queueNanoseconds / depth),
+      schedulerNanosecondsPerEntry: Math.round(schedulerNanoseconds / depth)
+    });
+  }
+};
+
+run();
@@ -0,0 +1,178 @@
+// measures connection rate and message throughput of sharded listeners
+//
+// usage: node benchmark/shards.js [numberOfShards] [numberOfAssociations] [messagesPerAssociation]
+//
+// numberOfShards worker threads listen on the same port with SO_REUSEPORT,
+// the associations are opened and driven by as many client threads, run it
+// with 1 shard and with several to compare how it scales across cores
+
+const lksctp = require("../lib/index.js");
+const nodeWorkerThreadsModule = require("node:worker_threads");
+const perf_hooks = require("node:perf_hooks");
+
+const performance = perf_hooks.performance;
+
+const port = 12349;
+const messageSize = 270;
+
+const runShard = () => {
+  let received = 0;
+
+  lksctp.shards.listen((connection) => {
+    connection.on("data", () => {
+      received += 1;
+    });
+  });
+
+  setInterval(() => {
+    nodeWorkerThreadsModule.parentPort.postMessage({ received });
+  }, 100);
+};
+
+const connect = () => {
+  return new Promise((resolve, reject) => {
+    const client = lksctp.connect({ host: "127.0.0.1", port });
+
+    client.on("error", reject);
+    client.on("connect", () => {
+      resolve(client);
+    });
+  });
+};
+
+const sendAll = ({ client, messagesPerAssociation, messageBuffer }) => {
+  let sent = 0;
+
+  const sendMore = () => {
+    while (sent < messagesPerAssociation) {
+      sent += 1;
+
+      if (!client.write(messageBuffer)) {
+        client.once("drain", sendMore);
+        return;
+      }
+    }
+  };
+
+  sendMore();
+};
+
+const runClients = async () => {
+  const { numberOfAssociations, messagesPerAssociation } = nodeWorkerThreadsModule.workerData;
+  const messageBuffer = Buffer.alloc(messageSize);
+
+  const connectStart = performance.now();
+  const clients = await Promise.all(Array.from({ length: numberOfAssociations }, connect));
+  const connectSeconds = (performance.now() - connectStart) / 1000;
+
+  nodeWorkerThreadsModule.parentPort.postMessage({ connectSeconds });
+
+  nodeWorkerThreadsModule.parentPort.once("message", () => {
+    clients.forEach((client) => {
+      sendAll({ client, messagesPerAssociation, messageBuffer });
+    });
+  });
+};
+
+const startClientThread = ({ numberOfAssociations, messagesPerAssociation }) => {
+  const worker = new nodeWorkerThreadsModule.Worker(__filename, {
+    workerData: { role: "client", numberOfAssociations, messagesPerAssociation }
+  });
+
+  const connected = new Promise((resolve, reject) => {
+    worker.once("message", resolve);
+    worker.once("error", reject);
+  });
+
+  return { worker, connected };
+};
+
+const main = async () => {
+  const numberOfShards = parseInt(process.argv[2] || "4", 10);
+  const numberOfAssociations = parseInt(process.argv[3] || "1000", 10);
+  const messagesPerAssociation = parseInt(process.argv[4] || "1000", 10);
+
+  const expected = numberOfAssociations * messagesPerAssociation;
+  const associationsPerClientThread = Math.ceil(numberOfAssociations / numberOfShards);
+
+  const shards = lksctp.shards.start({
+    filename: __filename,
+    count: numberOfShards,
+    listenOptions: { host: "127.0.0.1", port, backlog: numberOfAssociations },
+    workerData: { role: "shard" }
+  });
+
+  await shards.listening;
+
+  const receivedByShard = new Array(numberOfShards).fill(0);
+  let resolveDone = undefined;
+  const done = new Promise((resolve) => {
+    resolveDone = resolve;
+  });
+
+  shards.workers.forEach((worker, idx) => {
+    worker.on("message", ({ received }) => {
+      if (received === undefined) {
+        return;
+      }
+
+      receivedByShard[idx] = received;
+      if (receivedByShard.reduce((sum, value) => sum + value, 0) === expected) {
+        resolveDone();
+      }
+    });
+  });
+
+  const connectStart = performance.now();
+  const clientThreads = [];
+  for (let remaining = numberOfAssociations; remaining > 0; remaining -= associationsPerClientThread) {
+    clientThreads.push(startClientThread({
+      numberOfAssociations: Math.min(remaining, associationsPerClientThread),
+      messagesPerAssociation
+    }));
+  }
+
+  await Promise.all(clientThreads.map(({ connected }) => {
+    return connected;
+  }));
+  const connectSeconds = (performance.now() - connectStart) / 1000;
+
+  const start = performance.now();
+  clientThreads.forEach(({ worker }) => {
+    worker.postMessage("send");
+  });
+
+  await done;
+  const seconds = (performance.now() - start) / 1000;
+
+  console.table([{
+    shards: numberOfShards,
+    associationsPerSecond: Math.round(numberOfAssociations / connectSeconds),
+    messagesPerSecond: Math.round(expected / seconds),
+    megabytesPerSecond: Math.round(expected * messageSize / seconds / 1e6),
+    associationsPerShard: receivedByShard.map((received) => {
+      return Math.round(received / messagesPerAssociation);
+    }).join(" / ")
+  }]);
+
+  await Promise.all(clientThreads.map(({ worker }) => {
+    return worker.terminate();
+  }));
+  await shards.close();
+};
+
+const role = nodeWorkerThreadsModule.workerData?.role;
+
+if (role === "shard") {
+  runShard();
+} else if (role === "client") {
+  runClients().catch((error) => {
+    console.error(error);
+    process.exitCode = 1;
+  });
+} else {
+  main().catch((error) => {
+    console.error(error);
+    process.exitCode = 1;
+  });
+}
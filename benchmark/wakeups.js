@@ -0,0 +1,100 @@
+// measures poll wakeups per second and garbage collections they cause
+//
+// usage: node benchmark/wakeups.js [numberOfAssociations] [seconds]
+//
+// every association bounces one small message between client and server,
+// so each message is a wakeup of its own, run it before and after a change
+// of the poll path to compare wakeups and collections
+
+const perf_hooks = require("node:perf_hooks");
+const benchmark = require("./lib/index.js");
+
+const performance = perf_hooks.performance;
+
+const port = 12351;
+const numberOfAssociations = parseInt(process.argv[2] || "1", 10);
+const seconds = parseFloat(process.argv[3] || "5");
+
+const message = Buffer.alloc(8);
+
+const bounce = (association) => {
+  association.onMessage = () => {
+    association.send(message);
+  };
+};
+
+const observeGarbageCollections = () => {
+  const counts = { collections: 0, milliseconds: 0 };
+
+  const observer = new perf_hooks.PerformanceObserver((list) => {
+    list.getEntries().forEach((entry) => {
+      counts.collections += 1;
+      counts.milliseconds += entry.duration;
+    });
+  });
+  observer.observe({ entryTypes: ["gc"] });
+
+  return {
+    counts,
+    stop: () => {
+      observer.disconnect();
+    }
+  };
+};
+
+benchmark.runMain(async () => {
+  const server = await benchmark.listen({
+    port,
+    backlog: numberOfAssociations,
+    options: { lean: true },
+    onConnection: bounce
+  });
+
+  const clients = await benchmark.connectMany({ port, count: numberOfAssociations, options: { lean: true } });
+
+  let running = true;
+  let roundTrips = 0;
+
+  clients.forEach((client) => {
+    client.onMessage = () => {
+      roundTrips += 1;
+      if (running) {
+        client.send(message);
+      }
+    };
+  });
+
+  const gc = observeGarbageCollections();
+  const start = performance.now();
+
+  clients.forEach((client) => {
+    client.send(message);
+  });
+
+  await benchmark.sleep({ seconds });
+
+  running = false;
+  const elapsed = (performance.now() - start) / 1000;
+
+  // let the last collections be reported
+  await new Promise((resolve) => {
+    setImmediate(resolve);
+  });
+  gc.stop();
+
+  // a round trip wakes up the server and the client once each
+  const wakeups = roundTrips * 2;
+
+  console.table([{
+    associations: numberOfAssociations,
+    wakeupsPerSecond: Math.round(wakeups / elapsed),
+    collections: gc.counts.collections,
+    collectionsPerMillionWakeups: Number((gc.counts.collections / (wakeups / 1e6)).toFixed(1)),
+    gcMilliseconds: Number(gc.counts.milliseconds.toFixed(1))
+  }]);
+
+  clients.forEach((client) => {
+    client.destroy();
+  });
+  server.close();
+});
@@ -0,0 +1,513 @@
+/* eslint-disable max-statements */
+/* eslint-disable no-use-before-define */
+
+const nodeEventsModule = require("node:events");
+
+const native = require("./native.js");
+const ioPoll = require("./io-poll.js");
+const constants = require("./constants.js");
+const errors = require("./errors.js");
+const queueFactory = require("./queue.js");
+const socketCommon = require("./socket-common.js");
+const socketDriver = require("./socket-driver.js");
+const notifications = require("./notifications.js");
+const statsModule = require("./stats.js");
+const messageAssembler = require("./message-assembler.js");
+
+// lean association, on the same io backends as the duplex, but without
+// node streams: messages are handed to onMessage() as they are received,
+// send() queues without callbacks and reports backpressure like write()
+
+const errnoCodes = constants.errno;
+
+const MAX_MESSAGES_PER_SEND = 64;
+
+// the send queue holds message, sid, ppid, send flags and PR-SCTP value
+// back to back, so queueing a message allocates nothing
+const SEND_QUEUE_STRIDE = 5;
+
+// only used synchronously, so all associations of this thread share them
+const sendInfo = new Uint32Array(MAX_MESSAGES_PER_SEND * native.SENDV_BATCH_INFO_STRIDE);
+const messagesToSend = [];
+
+// ordered and reliable
+const NO_SEND_OPTIONS = Object.freeze({});
+
+const create = ({
+  fd,
+  connected: initiallyConnected,
+  initialRemoteAddress,
+  maxMessagesPerReceive = 64,
+  maxBytesPerReceive = 256 * 1024,
+  highWaterMark = 64 * 1024,
+  ioBackend = ioPoll,
+  onDemandNotifications = [],
+  partialDelivery = "assemble",
+
+  // messages received for the association before it had a socket of its
+  // own, e.g. the rest of a one-to-many batch when it was peeled off,
+  // delivered before anything received on fd
+  pendingBatch = undefined
+}) => {
+
+  const association = new nodeEventsModule.EventEmitter();
+
+  let connected = initiallyConnected;
+  let destroyed = false;
+  let paused = false;
+  let ending = false;
+  let shutdownRequested = false;
+  let remoteEnded = false;
+  let needDrain = false;
+
+  let queuedBytes = 0;
+  const sendQueue = queueFactory.create();
+
+  // the rest of a batch received before pause(), delivered on resume()
+  let receivedBatch = pendingBatch;
+  let receivedBatchIndex = 0;
+
+  // pieces of a message too large to be delivered at once
+  const assembler = messageAssembler.create({ partialDelivery });
+
+  const destroy = (error) => {
+    if (destroyed) {
+      return;
+    }
+
+    destroyed = true;
+
+    if (!shutdownRequested) {
+      // aborts the association, like the duplex does
+      native.setsockopt_linger({ fd, onoff: 1, linger: 0 });
+    }
+
+    // closes the fd as well
+    ioHandle.close();
+
+    process.nextTick(() => {
+      if (error !== undefined) {
+        association.emit("error", error);
+      }
+
+      association.emit("close");
+    });
+  };
+
+  const handleNotification = ({ rawNotification }) => {
+    const type = notifications.decode({ notification: rawNotification });
+
+    if (!connected) {
+      if (type !== constants.SCTP_ASSOC_CHANGE) {
+        destroy(Error("first notification must be SCTP_ASSOC_CHANGE"));
+        return;
+      }
+
+      connected = true;
+      association.emit("connect");
+    }
+
+    notifications.emit({ emitter: association, notification: rawNotification });
+  };
+
+  const handleRemoteEnd = () => {
+    remoteEnded = true;
+    association.emit("end");
+
+    // no half open associations, same as the duplex
+    if (!destroyed) {
+      association.end();
+    }
+  };
+
+  const handleMessage = ({ piece, flags, sid, ppid }) => {
+    const message = assembler.receive({ piece, flags });
+    if (message === undefined) {
+      return;
+    }
+
+    if ((flags & constants.MSG_NOTIFICATION) !== 0) {
+      handleNotification({ rawNotification: message });
+      return;
+    }
+
+    if (!connected) {
+      destroy(Error("first message must be a notification"));
+      return;
+    }
+
+    if (message.length === 0) {
+      handleRemoteEnd();
+      return;
+    }
+
+    association.onMessage(message, sid, ppid, flags);
+  };
+
+  const handleErrno = ({ errno, operation }) => {
+    if (errno === errnoCodes.ECONNRESET || errno === errnoCodes.EPIPE) {
+      destroy(errors.createErrorFromErrno({ errno }));
+      return;
+    }
+
+    destroy(errors.createErrorFromErrno({ operation, errno }));
+  };
+
+  const receivePaused = () => {
+    return connected && paused && !shutdownRequested;
+  };
+
+  const deliverReceivedBatch = () => {
+    const { errno, messages, info } = receivedBatch;
+
+    while (receivedBatchIndex < messages.length && !destroyed && !remoteEnded) {
+      if (receivePaused()) {
+        return true;
+      }
+
+      const offset = receivedBatchIndex * native.RECVV_BATCH_INFO_STRIDE;
+
+      // views into the shared receive slab, wrapping them copies nothing
+      const view = messages[receivedBatchIndex];
+      receivedBatchIndex += 1;
+
+      handleMessage({
+        piece: Buffer.from(view.buffer, view.byteOffset, view.byteLength),
+        flags: info[offset],
+        sid: info[offset + 2],
+        ppid: info[offset + 3]
+      });
+    }
+
+    receivedBatch = undefined;
+
+    if (destroyed) {
+      return true;
+    }
+
+    if (errno === errnoCodes.EAGAIN) {
+      driver.socketMaybeHasMore = false;
+    } else if (errno !== errnoCodes.NO_ERROR) {
+      handleErrno({ errno, operation: "sctp_recvmsg()" });
+      return true;
+    }
+
+    return messages.length > 0;
+  };
+
+  const tryReceiveNext = () => {
+    if (receivePaused()) {
+      return false;
+    }
+
+    if (receivedBatch !== undefined) {
+      return deliverReceivedBatch();
+    }
+
+    if (remoteEnded || !driver.socketMaybeHasMore) {
+      return false;
+    }
+
+    receivedBatch = ioHandle.receiveBatch({
+      maxMessages: maxMessagesPerReceive,
+      maxBytes: maxBytesPerReceive
+    });
+    receivedBatchIndex = 0;
+
+    return deliverReceivedBatch();
+  };
+
+  const completeSentMessages = ({ messagesSent }) => {
+    for (let i = 0; i < messagesSent; i += 1) {
+      queuedBytes -= sendQueue.shift().length;
+      sendQueue.shift();
+      sendQueue.shift();
+      sendQueue.shift();
+      sendQueue.shift();
+    }
+
+    if (needDrain && queuedBytes < highWaterMark) {
+      needDrain = false;
+      association.emit("drain");
+    }
+  };
+
+  const trySendNext = () => {
+    if (sendQueue.length === 0 || !driver.socketMaybeTakesMore || !connected) {
+      return false;
+    }
+
+    const count = Math.min(MAX_MESSAGES_PER_SEND, sendQueue.length / SEND_QUEUE_STRIDE);
+    for (let i = 0; i < count; i += 1) {
+      const queueOffset = i * SEND_QUEUE_STRIDE;
+      const infoOffset = i * native.SENDV_BATCH_INFO_STRIDE;
+
+      messagesToSend[i] = sendQueue.get(queueOffset);
+      sendInfo[infoOffset] = sendQueue.get(queueOffset + 1);
+      sendInfo[infoOffset + 1] = sendQueue.get(queueOffset + 2);
+      sendInfo[infoOffset + 2] = sendQueue.get(queueOffset + 3);
+      sendInfo[infoOffset + 3] = 0;
+      sendInfo[infoOffset + 5] = sendQueue.get(queueOffset + 4);
+    }
+
+    messagesToSend.length = count;
+
+    const { errno, messagesSent } = ioHandle.sendBatch({
+      messages: messagesToSend,
+      info: sendInfo
+    });
+
+    // don't keep sent messages alive
+    messagesToSend.length = 0;
+
+    completeSentMessages({ messagesSent });
+
+    if (destroyed) {
+      return true;
+    }
+
+    if (errno === errnoCodes.EAGAIN) {
+      driver.socketMaybeTakesMore = false;
+    } else if (errno !== errnoCodes.NO_ERROR) {
+      handleErrno({ errno, operation: "sctp_sendv()" });
+      return true;
+    }
+
+    return messagesSent > 0;
+  };
+
+  // once everything queued is sent, the association is shut down,
+  // and closed once the peer has shut down as well
+  const maybeFinish = () => {
+    if (!ending || sendQueue.length > 0) {
+      return;
+    }
+
+    if (!shutdownRequested) {
+      shutdownRequested = true;
+
+      if (!remoteEnded) {
+        const { errno } = ioHandle.shutdown();
+        if (errno !== errnoCodes.NO_ERROR) {
+          destroy(errors.createErrorFromErrno({ operation: "shutdown()", errno }));
+        }
+        return;
+      }
+    }
+
+    if (remoteEnded) {
+      destroy();
+    }
+  };
+
+  const updatePollEvents = () => {
+    const readable = !connected || ((!paused || shutdownRequested) && !remoteEnded);
+    const writable = connected && sendQueue.length > 0;
+
+    ioHandle.update({
+      events: {
+        readable,
+        writable
+      }
+    });
+  };
+
+  const driver = socketDriver.create({
+    fd,
+    ioBackend,
+
+    // optimistic, the first send() needs no poll round trip
+    socketMaybeTakesMore: true,
+
+    isDone: () => {
+      return destroyed;
+    },
+
+    step: () => {
+      return tryReceiveNext() || trySendNext();
+    },
+
+    idle: () => {
+      maybeFinish();
+
+      if (!destroyed) {
+        updatePollEvents();
+      }
+    },
+
+    onError: destroy
+  });
+
+  const ioHandle = driver.handle;
+  const maybeScheduleNextMicrotask = driver.schedule;
+
+  // replaced by the application for the hot path, emitting an event
+  // per message costs noticeably more than a plain call
+  association.onMessage = (message, sid, ppid, flags) => {
+    association.emit("message", message, sid, ppid, flags);
+  };
+
+  // returns false once more than highWaterMark bytes are queued,
+  // "drain" is emitted when the queue fell below it again
+  association.send = (message, sid = 0, ppid = 0, sendOptions = NO_SEND_OPTIONS) => {
+    if (destroyed || ending) {
+      throw Error("send after end or destroy");
+    }
+
+    if (!(message instanceof Uint8Array)) {
+      throw Error("message must be a Buffer or Uint8Array");
+    }
+
+    // throws on invalid options before anything is queued
+    const sendFlags = socketCommon.sendFlagsOf(sendOptions);
+
+    if (sendQueue.length === 0) {
+      maybeScheduleNextMicrotask();
+    }
+
+    sendQueue.push(message);
+    sendQueue.push(sid);
+    sendQueue.push(ppid);
+    sendQueue.push(sendFlags);
+    sendQueue.push(socketCommon.prValueOf(sendOptions));
+    queuedBytes += message.length;
+
+    needDrain = needDrain || queuedBytes >= highWaterMark;
+
+    return !needDrain;
+  };
+
+  // sends what is queued, then shuts the association down gracefully,
+  // "close" is emitted once the peer completed the shutdown
+  association.end = () => {
+    if (destroyed || ending) {
+      return;
+    }
+
+    ending = true;
+    maybeScheduleNextMicrotask();
+  };
+
+  association.destroy = (error) => {
+    destroy(error);
+  };
+
+  // stops onMessage() calls right away, the rest of a received batch is
+  // kept for resume(), the kernel buffers, and eventually the peer is flow
+  // controlled
+  association.pause = () => {
+    paused = true;
+  };
+
+  association.resume = () => {
+    if (paused) {
+      paused = false;
+      maybeScheduleNextMicrotask();
+    }
+  };
+
+  association.abandoned = (sid) => {
+    if (destroyed) {
+      throw Error("abandoned called after destroy");
+    }
+
+    return socketCommon.getAbandonedMessages({ native, fd, sid });
+  };
+
+  association.status = () => {
+    if (destroyed) {
+      throw Error("status called after destroy");
+    }
+
+    return socketCommon.getAssociationStatus({ native, fd });
+  };
+
+  let readStats = undefined;
+
+  // fills buffers.stats and buffers.paths (see stats.js), returns the
+  // number of remote addresses
+  association.stats = (buffers) => {
+    if (destroyed) {
+      throw Error("stats called after destroy");
+    }
+
+    if (readStats === undefined) {
+      readStats = statsModule.createReader({ native, fd });
+    }
+
+    return readStats(buffers);
+  };
+
+  association.setNoDelay = (noDelay = true) => {
+    if (destroyed) {
+      throw Error("setNoDelay called after destroy");
+    }
+
+    socketCommon.setNoDelay({ native, fd, noDelay });
+  };
+
+  association.address = () => {
+    return socketCommon.getCurrentLocalPrimaryAddress({ native, fd });
+  };
+
+  association.remoteAddress = () => {
+    if (!connected) {
+      return initialRemoteAddress;
+    }
+
+    return socketCommon.getCurrentRemotePrimaryAddress({ native, fd }) || initialRemoteAddress;
+  };
+
+  Object.defineProperty(association, "queuedBytes", {
+    get: () => {
+      return queuedBytes;
+    }
+  });
+
+  Object.defineProperty(association, "connected", {
+    get: () => {
+      return connected && !destroyed;
+    }
+  });
+
+  socketCommon.subscribeNotificationsOnDemand({
+    native,
+    emitter: association,
+    fd,
+    types: onDemandNotifications,
+    isOpen: () => {
+      return !destroyed;
+    }
+  });
+
+  maybeScheduleNextMicrotask();
+
+  return association;
+};
+
+// stands in for an association that could not be created, e.g. if the
+// socket could not be connected, it only reports the error
+const createFailed = ({ error }) => {
+  const association = new nodeEventsModule.EventEmitter();
+
+  association.onMessage = () => { };
+  association.send = () => {
+    throw Error("send after end or destroy");
+  };
+  association.end = () => { };
+  association.destroy = () => { };
+  association.pause = () => { };
+  association.resume = () => { };
+
+  process.nextTick(() => {
+    association.emit("error", error);
+    association.emit("close");
+  });
+
+  return association;
+};
+
+module.exports = {
+  create,
+  createFailed
+};
@@ -3,9 +3,13 @@ const sockaddrTranscoder = require("./sockaddr.js");
 const {
   determineAddressFamily,
   createSocketWithOptions,
-  initiallyBindLocalAddresses
+  initiallyBindLocalAddresses,
+  resolveIoBackend,
+  resolvePartialDelivery,
+  resolveNotifications
 } = require("./socket-common.js");
 const socketDuplexFactory = require("./socket-duplex.js");
+const associationFactory = require("./association.js");
 const constants = require("./constants.js");
 const errors = require("./errors.js");
 const nodeNet = require("node:net");
@@ -24,6 +28,45 @@ const createErrorDuplex = ({ error }) => {
   return duplex;
 };
 
+const createFailedConnection = ({ options, error }) => {
+  if (options.lean) {
+    return associationFactory.createFailed({ error });
+  }
+
+  return createErrorDuplex({ error });
+};
+
+const createConnection = ({ options, fd, initialRemoteAddress, ioBackend }) => {
+  const { onDemand: onDemandNotifications, addressGatherInterval } = resolveNotifications({ notifications: options.notifications });
+  const partialDelivery = resolvePartialDelivery({ partialDelivery: options.partialDelivery });
+
+  if (options.lean) {
+    return associationFactory.create({
+      fd,
+      connected: false,
+      initialRemoteAddress,
+      ioBackend,
+      highWaterMark: options.highWaterMark,
+      onDemandNotifications,
+      partialDelivery
+    });
+  }
+
+  return socketDuplexFactory.create({
+    fd,
+    connected: false,
+    initialRemoteAddress,
+    ioBackend,
+    onDemandNotifications,
+    addressGatherInterval,
+    partialDelivery,
+    duplexOptions: {
+      readableHighWaterMark: options.highWaterMark,
+      writableHighWaterMark: options.highWaterMark
+    }
+  });
+};
+
 const initiateConnect = ({ native, sockfd, remoteSockaddrs }) => {
   const { errno: connectErrno } = native.sctp_connectx({
     fd: sockfd,
@@ -163,14 +206,16 @@ const connect = ({ native, options }) => {
     localPort
   } = validateConnectOptions(options);
 
+  const ioBackend = resolveIoBackend({ ioBackend: options.ioBackend, ioRingSize: options.ioRingSize });
+
   const { error: socketError, fd: sockfd } = createSocketWithOptions({ native, options });
   if (socketError !== undefined) {
-    return createErrorDuplex({ error: socketError });
+    return createFailedConnection({ options, error: socketError });
   }
 
   const { error: bindError } = bindLocalAddresses({ native, sockfd, localAddresses, localPort });
   if (bindError !== undefined) {
-    return createErrorDuplex({ error: bindError });
+    return createFailedConnection({ options, error: bindError });
   }
 
   const remoteSockaddrs = remoteAddresses.map((remoteAddress) => {
@@ -187,24 +232,19 @@ const connect = ({ native, options }) => {
     remoteSockaddrs
   });
   if (connectError !== undefined) {
-    return createErrorDuplex({ error: connectError });
+    return createFailedConnection({ options, error: connectError });
   }
 
-  const duplex = socketDuplexFactory.create({
+  return createConnection({
+    options,
     fd: sockfd,
-    connected: false,
     initialRemoteAddress: {
       family: determineAddressFamily({ address: remoteAddresses[0] }),
       address: remoteAddresses[0],
       port: remotePort
     },
-    duplexOptions: {
-      readableHighWaterMark: options.highWaterMark,
-      writableHighWaterMark: options.highWaterMark
-    }
+    ioBackend
   });
-
-  return duplex;
 };
 
 module.exports = {
@@ -54,8 +54,22 @@ module.exports = {
     ETIMEDOUT: 110,
   },
 
+  SCTP_UNORDERED: 0x1,
+  SCTP_ABORT: 0x4,
+  SCTP_EOF: 0x200,
+
+  SCTP_PR_SCTP_TTL: 0x10,
+  SCTP_PR_SCTP_RTX: 0x20,
+  SCTP_PR_SCTP_PRIO: 0x30,
+  SCTP_PR_SCTP_MASK: 0x30,
+
   MSG_EOR: 0x80,
   MSG_NOTIFICATION: 0x8000,
 
+  // not a kernel flag, set by the addon on pieces which are only pieces
+  // because the buffer they were received into was too small, see
+  // message-assembler.js
+  RECEIVE_FLAG_CONTINUED: 0x40000000,
+
   SHUT_RDWR: 2,
 };
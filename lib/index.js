@@ -2,6 +2,10 @@ const native = require("./native.js");
 
 const serverFactory = require("./server.js");
 const clientFactory = require("./client.js");
+const shardsModule = require("./shards.js");
+const statsModule = require("./stats.js");
+const socketDuplexFactory = require("./socket-duplex.js");
+const socketCommon = require("./socket-common.js");
 
 const parseServerArgs = ({ args }) => {
   let options = {};
@@ -75,8 +79,41 @@ const createConnection = (...args) => {
 
 const connect = createConnection;
 
+// takes over an association another thread handed over with detach()
+const adopt = (transfer, options = {}) => {
+  if (typeof transfer !== "object" || !Number.isInteger(transfer.fd)) {
+    throw Error("transfer must be the result of duplex.detach()");
+  }
+
+  return socketDuplexFactory.adopt({
+    transfer,
+    ioBackend: socketCommon.resolveIoBackend({ ioBackend: options.ioBackend }),
+    duplexOptions: {
+      readableHighWaterMark: options.highWaterMark,
+      writableHighWaterMark: options.highWaterMark
+    }
+  });
+};
+
+const shards = {
+  start: shardsModule.start,
+
+  listen: (connectionListener) => {
+    return shardsModule.listen({ createServer, connectionListener });
+  }
+};
+
+const stats = {
+  FIELDS: statsModule.FIELDS,
+  PATH_FIELDS: statsModule.PATH_FIELDS,
+  create: statsModule.create
+};
+
 module.exports = {
   createServer,
   createConnection,
-  connect
+  connect,
+  adopt,
+  shards,
+  stats
 };
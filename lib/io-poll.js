@@ -0,0 +1,45 @@
+const native = require("./native.js");
+const pollerFactory = require("./poller.js");
+const constants = require("./constants.js");
+
+// default io backend, sockets are polled for readiness on this thread,
+// sends and receives are syscalls done right away
+const create = ({ fd, callback }) => {
+
+  const pollHandle = pollerFactory.create({ fd, callback });
+
+  const receiveBatch = ({ maxMessages, maxBytes }) => {
+    return native.sctp_recvv_batch({ fd, maxMessages, maxBytes });
+  };
+
+  const sendBatch = ({ messages, info }) => {
+    return native.sctp_sendv_batch({ fd, messages, info, flags: 0 });
+  };
+
+  const shutdown = () => {
+    return native.shutdown({ fd, how: constants.SHUT_RDWR });
+  };
+
+  const close = () => {
+    pollHandle.close();
+    native.close_fd({ fd });
+  };
+
+  // stops polling but leaves the fd open, e.g. to hand it to another thread
+  const release = () => {
+    pollHandle.close();
+  };
+
+  return {
+    receiveBatch,
+    sendBatch,
+    update: pollHandle.update,
+    shutdown,
+    close,
+    release
+  };
+};
+
+module.exports = {
+  create
+};
@@ -0,0 +1,230 @@
+const native = require("./native.js");
+const errors = require("./errors.js");
+const queueFactory = require("./queue.js");
+const { callWithEventsAndReportExceptions, READABLE, WRITABLE } = require("./poller.js");
+
+// io backends where native code owns the sockets and exchanges messages
+// with javascript through a receive and a send ring per association,
+// the rings are filled either by an io thread or by io_uring
+
+// default size of the receive and the send ring of every association,
+// messages larger than half a ring are received in pieces, and sent from
+// an allocation of their own, larger rings mean fewer wakeups
+const DEFAULT_RING_SIZE = 64 * 1024;
+const MIN_RING_SIZE = 4096;
+
+// notifications reported at once, more are reported in further calls
+const MAX_EVENTS = 1024;
+
+// shared by all backends, one microtask delivers everything that is ready
+const readyEntries = queueFactory.create();
+let deliveryScheduled = false;
+
+const deliverToEntry = ({ entry }) => {
+  const readable = entry.readable && entry.interest.readable;
+  const writable = entry.writable && entry.interest.writable;
+
+  if (!readable && !writable) {
+    // kept until the socket is interested again
+    return;
+  }
+
+  entry.readable = entry.readable && !readable;
+  entry.writable = entry.writable && !writable;
+
+  callWithEventsAndReportExceptions(entry.callback, 0, (readable ? READABLE : 0) | (writable ? WRITABLE : 0));
+};
+
+// same as for the poll backend, callbacks run in a microtask
+// so exceptions are not reported to native code
+const deliver = () => {
+  deliveryScheduled = false;
+
+  while (readyEntries.length > 0) {
+    const entry = readyEntries.shift();
+    entry.queued = false;
+
+    if (!entry.closed) {
+      deliverToEntry({ entry });
+    }
+  }
+};
+
+const markReady = ({ entry, readable, writable }) => {
+  entry.readable = entry.readable || readable;
+  entry.writable = entry.writable || writable;
+
+  if (!entry.queued) {
+    entry.queued = true;
+    readyEntries.push(entry);
+  }
+
+  if (!deliveryScheduled) {
+    deliveryScheduled = true;
+    Promise.resolve().then(deliver);
+  }
+};
+
+const validateRingSize = ({ ringSize }) => {
+  if (!Number.isInteger(ringSize) || ringSize < MIN_RING_SIZE || ringSize > 2 ** 30 || (ringSize & (ringSize - 1)) !== 0) {
+    throw Error(`ioRingSize must be a power of two, at least ${MIN_RING_SIZE}`);
+  }
+};
+
+const createHandle = ({ rings, id, entry }) => {
+
+  const update = ({ events: requestedEvents }) => {
+    if (entry.closed) {
+      throw Error("io handle already closed");
+    }
+
+    // the rings might already hold data, or have room, so newly
+    // requested events are reported once, the socket copes with that
+    const newlyReadable = requestedEvents.readable && !entry.interest.readable;
+    const newlyWritable = requestedEvents.writable && !entry.interest.writable;
+
+    entry.interest = {
+      readable: requestedEvents.readable,
+      writable: requestedEvents.writable
+    };
+
+    if (newlyReadable || newlyWritable) {
+      markReady({ entry, readable: newlyReadable, writable: newlyWritable });
+    }
+  };
+
+  const receiveBatch = ({ maxMessages, maxBytes }) => {
+    return rings.receive_batch({ id, maxMessages, maxBytes });
+  };
+
+  const sendBatch = ({ messages, info }) => {
+    return rings.send_batch({ id, messages, info });
+  };
+
+  // done natively, once all queued messages are sent
+  const shutdown = () => {
+    return rings.shutdown({ id });
+  };
+
+  const close = () => {
+    if (entry.closed) {
+      throw Error("io handle already closed");
+    }
+
+    entry.closed = true;
+    rings.detach({ id });
+  };
+
+  return {
+    receiveBatch,
+    sendBatch,
+    update,
+    shutdown,
+    close
+  };
+};
+
+// createNative is create_io_thread or create_io_uring, it is called once
+// on first use, and may fail if the backend is not supported
+const createBackend = ({ name, createNative }) => {
+
+  const events = new Int32Array(MAX_EVENTS * native.IO_THREAD_EVENT_STRIDE);
+  const entriesById = new Map();
+
+  let rings = undefined;
+
+  const onNotifications = ({ eventCount }) => {
+    for (let i = 0; i < eventCount; i += 1) {
+      const offset = i * native.IO_THREAD_EVENT_STRIDE;
+      const entry = entriesById.get(events[offset]);
+      const notifications = events[offset + 1];
+
+      if (entry !== undefined) {
+        markReady({
+          entry,
+          readable: (notifications & native.IO_THREAD_NOTIFY_READABLE) !== 0,
+          writable: (notifications & native.IO_THREAD_NOTIFY_WRITABLE) !== 0
+        });
+      }
+    }
+  };
+
+  const getRings = () => {
+    if (rings === undefined) {
+      rings = createNative({
+        events,
+        callback: onNotifications
+      });
+    }
+
+    return rings;
+  };
+
+  const isAvailable = () => {
+    return getRings().errno === 0;
+  };
+
+  const create = ({ fd, callback, ringSize = DEFAULT_RING_SIZE }) => {
+
+    const backendRings = getRings();
+    if (backendRings.errno !== 0) {
+      throw errors.createErrorFromErrno({
+        operation: `${name} setup`,
+        errno: backendRings.errno
+      });
+    }
+
+    // from here on, native code owns the fd and closes it
+    const { errno, id } = backendRings.attach({ fd, ringSize });
+    if (errno !== 0) {
+      throw errors.createErrorFromErrno({
+        operation: "attach()",
+        errno
+      });
+    }
+
+    const entry = {
+      callback,
+      readable: false,
+      writable: false,
+      interest: { readable: false, writable: false },
+      queued: false,
+      closed: false
+    };
+
+    entriesById.set(id, entry);
+
+    const handle = createHandle({ rings: backendRings, id, entry });
+
+    return {
+      ...handle,
+
+      close: () => {
+        handle.close();
+        entriesById.delete(id);
+      }
+    };
+  };
+
+  // the same backend, with rings of another size
+  const withRingSize = ({ ringSize }) => {
+    validateRingSize({ ringSize });
+
+    return {
+      create: ({ fd, callback }) => {
+        return create({ fd, callback, ringSize });
+      },
+      isAvailable
+    };
+  };
+
+  return {
+    create,
+    isAvailable,
+    withRingSize
+  };
+};
+
+module.exports = {
+  createBackend
+};
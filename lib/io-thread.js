@@ -0,0 +1,10 @@
+const native = require("./native.js");
+const ioRings = require("./io-rings.js");
+
+// io backend, where a native thread owns the sockets and does the send and
+// receive syscalls, all associations of this javascript thread share one
+// io thread
+module.exports = ioRings.createBackend({
+  name: "io thread",
+  createNative: native.create_io_thread
+});
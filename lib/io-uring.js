@@ -0,0 +1,10 @@
+const native = require("./native.js");
+const ioRings = require("./io-rings.js");
+
+// completion based io backend, receives and sends of all associations of
+// this javascript thread are submitted to one io_uring instance, this
+// needs a kernel with io_uring enabled, see isAvailable()
+module.exports = ioRings.createBackend({
+  name: "io_uring",
+  createNative: native.create_io_uring
+});
@@ -0,0 +1,73 @@
+const constants = require("./constants.js");
+
+// collects the pieces of a message which is handed to us partially, because
+// it is larger than the partial delivery point, and joins them once the last
+// piece (the one with MSG_EOR) arrives
+//
+// complete messages pass through without being copied, with partialDelivery
+// "chunks" the pieces of data messages are passed on as they are, only the
+// last one carries MSG_EOR, notifications are always joined
+//
+// pieces marked RECEIVE_FLAG_CONTINUED were only split by a receive buffer,
+// they are always joined with the piece that follows
+const create = ({ partialDelivery = "assemble" } = {}) => {
+  const streamsChunks = partialDelivery === "chunks";
+
+  let pieces = [];
+  let length = 0;
+
+  const add = (piece) => {
+    pieces.push(piece);
+    length += piece.length;
+  };
+
+  const complete = (last) => {
+    if (pieces.length === 0) {
+      return last;
+    }
+
+    add(last);
+    const message = Buffer.concat(pieces, length);
+
+    pieces = [];
+    length = 0;
+
+    return message;
+  };
+
+  const pending = () => {
+    return pieces.length > 0;
+  };
+
+  // returns the message, or undefined while pieces of it are missing
+  //
+  // a zero length piece is the end of the stream, it is returned as it is,
+  // a message it cut off can't be completed anymore and is dropped
+  const receive = ({ piece, flags }) => {
+    if (piece.length === 0) {
+      pieces = [];
+      length = 0;
+      return piece;
+    }
+
+    if ((flags & constants.MSG_EOR) !== 0) {
+      return complete(piece);
+    }
+
+    if ((flags & (constants.MSG_NOTIFICATION | constants.RECEIVE_FLAG_CONTINUED)) === 0 && streamsChunks) {
+      return complete(piece);
+    }
+
+    add(piece);
+    return undefined;
+  };
+
+  return {
+    receive,
+    pending
+  };
+};
+
+module.exports = {
+  create
+};
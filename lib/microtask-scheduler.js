@@ -1,32 +1,67 @@
+const queueFactory = require("./queue.js");
+
+// sockets queue one I/O step at a time and queue their next step behind
+// everyone else's, so with one scheduler per thread, ready sockets take
+// turns and a busy one can't starve the rest
+//
+// at most maxMicrotasksPerMacrotask steps run per event loop turn, the
+// rest continue in the check phase (setImmediate), so other I/O gets its
+// turn without stalling for a timer tick
+
+const reportException = (ex) => {
+  // keep running the other sockets' steps, but still raise an uncaught
+  // exception, thrown from a tick, as a rejected promise would be
+  // reported as unhandled rejection instead
+  process.nextTick(() => {
+    throw ex;
+  });
+};
+
+const runAndReportExceptions = (fn) => {
+  try {
+    fn();
+  } catch (ex) {
+    reportException(ex);
+  }
+};
+
 const create = ({ maxMicrotasksPerMacrotask }) => {
 
-  let microtaskFunctionQueue = [];
+  // a task is in the queue at most once, a cancelled task is
+  // skipped when it reaches the front of the queue
+  const microtaskQueue = queueFactory.create();
   let microtasksExecutedInCurrentMacrotask = 0;
   let clearMicrotasksCounterSchedule = undefined;
 
   let dispatcherRunning = false;
 
   const maybeStartDispatcher = () => {
-    if (!dispatcherRunning && microtaskFunctionQueue.length > 0 && microtasksExecutedInCurrentMacrotask < maxMicrotasksPerMacrotask) {
+    if (!dispatcherRunning && microtaskQueue.length > 0 && microtasksExecutedInCurrentMacrotask < maxMicrotasksPerMacrotask) {
       dispatcherRunning = true;
 
       Promise.resolve().then(() => {
 
         try {
-          while (microtasksExecutedInCurrentMacrotask < maxMicrotasksPerMacrotask && microtaskFunctionQueue.length > 0) {
-            const fn = microtaskFunctionQueue[0];
-            fn();
+          while (microtasksExecutedInCurrentMacrotask < maxMicrotasksPerMacrotask && microtaskQueue.length > 0) {
+            const task = microtaskQueue.shift();
+            task.inQueue = false;
+
+            if (!task.queued) {
+              continue;
+            }
 
-            microtaskFunctionQueue = microtaskFunctionQueue.slice(1);
+            // the task may queue itself again while it runs
+            task.queued = false;
+            runAndReportExceptions(task.fn);
 
             microtasksExecutedInCurrentMacrotask += 1;
 
             if (clearMicrotasksCounterSchedule === undefined) {
-              clearMicrotasksCounterSchedule = setTimeout(() => {
+              clearMicrotasksCounterSchedule = setImmediate(() => {
                 clearMicrotasksCounterSchedule = undefined;
                 microtasksExecutedInCurrentMacrotask = 0;
                 maybeStartDispatcher();
-              }, 0);
+              });
             }
           }
         } finally {
@@ -36,33 +71,54 @@ const create = ({ maxMicrotasksPerMacrotask }) => {
     }
   };
 
-  const scheduleMicrotask = (fn) => {
+  // a socket creates its task once and schedules it again and again,
+  // so scheduling allocates nothing
+  const createTask = (fn) => {
+    const task = { fn, queued: false, inQueue: false };
 
-    microtaskFunctionQueue.push(fn);
-    maybeStartDispatcher();
+    const schedule = () => {
+      task.queued = true;
+
+      if (!task.inQueue) {
+        task.inQueue = true;
+        microtaskQueue.push(task);
+      }
+
+      maybeStartDispatcher();
+    };
 
     const pending = () => {
-      return microtaskFunctionQueue.includes(fn);
+      return task.queued;
     };
 
     const cancel = () => {
-      const index = microtaskFunctionQueue.indexOf(fn);
-      if (index !== -1) {
-        microtaskFunctionQueue.splice(index, 1);
-      }
+      task.queued = false;
     };
 
     return {
+      schedule,
       pending,
       cancel
     };
   };
 
+  const scheduleMicrotask = (fn) => {
+    const task = createTask(fn);
+    task.schedule();
+
+    return task;
+  };
+
   return {
+    createTask,
     scheduleMicrotask
   };
 };
 
+// shared by all sockets of this thread
+const shared = create({ maxMicrotasksPerMacrotask: 1000 });
+
 module.exports = {
-  create
+  create,
+  shared
 };
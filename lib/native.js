@@ -27,8 +27,10 @@ if (releaseExists) {
 // error handling in native code is noisy, so we
 // assert the parameters here
 
-const create_socket = () => {
-  const { errno, fd } = native.create_socket();
+const create_socket = ({ oneToMany = false } = {}) => {
+  assert(typeof oneToMany === "boolean");
+
+  const { errno, fd } = native.create_socket({ oneToMany });
 
   assert(typeof errno === "number");
 
@@ -115,23 +117,69 @@ const accept = ({ fd, sockaddr }) => {
   };
 };
 
-// eslint-disable-next-line max-statements
-const sctp_recvv = ({ fd, messageBuffer, sockaddr }) => {
+// accepts up to fds.length connections at once, the peer address
+// of fds[i] is found in sockaddrs at i * sockaddrLength
+const accept_batch = ({ fd, fds, sockaddrs, sockaddrLength }) => {
 
   assert(typeof fd === "number");
-  assert(messageBuffer instanceof Uint8Array);
-  assert(sockaddr instanceof Uint8Array);
+  assert(fds instanceof Int32Array && fds.length > 0);
+  assert(sockaddrs instanceof Uint8Array);
+  assert(typeof sockaddrLength === "number" && sockaddrLength > 0);
+  assert(sockaddrs.length >= fds.length * sockaddrLength);
 
-  const { errno, bytesReceived, flags, rcvinfo } = native.sctp_recvv({
+  const { errno, connectionCount } = native.accept_batch({
     fd,
-    messageBuffer,
-    sockaddr
+    fds,
+    sockaddrs,
+    sockaddrLength
+  });
+
+  assert(typeof errno === "number");
+  assert(typeof connectionCount === "number");
+
+  return {
+    errno,
+    connectionCount
+  };
+};
+
+const sctp_peeloff = ({ fd, assocId }) => {
+
+  assert(typeof fd === "number");
+  assert(typeof assocId === "number");
+
+  const { errno, fd: peeledFd } = native.sctp_peeloff({
+    fd,
+    assocId
+  });
+
+  assert(typeof errno === "number");
+
+  if (errno === 0) {
+    assert(typeof peeledFd === "number");
+  }
+
+  return {
+    errno,
+    fd: peeledFd
+  };
+};
+
+// eslint-disable-next-line max-statements
+const sctp_recvv = ({ fd }) => {
+
+  assert(typeof fd === "number");
+
+  const { errno, bytesReceived, flags, rcvinfo, message } = native.sctp_recvv({
+    fd
   });
 
   assert(typeof errno === "number");
   if (errno === 0) {
     assert(typeof bytesReceived === "number");
     assert(typeof flags === "number");
+    assert(message instanceof Uint8Array);
+    assert(message.length === bytesReceived);
 
     if (rcvinfo !== undefined) {
       assert(typeof rcvinfo === "object");
@@ -147,14 +195,57 @@ const sctp_recvv = ({ fd, messageBuffer, sockaddr }) => {
     errno,
     bytesReceived,
     flags,
-    rcvinfo
+    rcvinfo,
+    message
   };
 };
 
+const RECVV_BATCH_INFO_STRIDE = 5;
+
+const sctp_recvv_batch = ({ fd, maxMessages, maxBytes }) => {
+
+  assert(typeof fd === "number");
+  assert(typeof maxMessages === "number" && maxMessages > 0);
+  assert(typeof maxBytes === "number");
+
+  const { errno, messages, info } = native.sctp_recvv_batch({
+    fd,
+    maxMessages,
+    maxBytes
+  });
+
+  assert(typeof errno === "number");
+  assert(Array.isArray(messages));
+  assert(info instanceof Uint32Array);
+  assert(info.length === messages.length * RECVV_BATCH_INFO_STRIDE);
+
+  return {
+    errno,
+    messages,
+    info
+  };
+};
+
+// a message is either a single buffer or an array of buffers, which the
+// kernel gathers into one SCTP message
+const MAX_MESSAGE_PARTS = 1024;
+
+const assertMessage = (message) => {
+  if (!Array.isArray(message)) {
+    assert(message instanceof Uint8Array);
+    return;
+  }
+
+  assert(message.length <= MAX_MESSAGE_PARTS);
+  message.forEach((part) => {
+    assert(part instanceof Uint8Array);
+  });
+};
+
 const sctp_sendv = ({ fd, message, sndinfo, flags }) => {
 
   assert(typeof fd === "number");
-  assert(message instanceof Uint8Array);
+  assertMessage(message);
   assert(typeof sndinfo === "object");
   assert(typeof sndinfo.sid === "number");
   assert(typeof sndinfo.ppid === "number");
@@ -180,6 +271,168 @@ const sctp_sendv = ({ fd, message, sndinfo, flags }) => {
   };
 };
 
+const SENDV_BATCH_INFO_STRIDE = 6;
+
+const sctp_sendv_batch = ({ fd, messages, info, flags }) => {
+
+  assert(typeof fd === "number");
+  assert(Array.isArray(messages));
+  messages.forEach(assertMessage);
+  assert(info instanceof Uint32Array);
+  assert(info.length >= messages.length * SENDV_BATCH_INFO_STRIDE);
+  assert(typeof flags === "number");
+
+  const { errno, messagesSent } = native.sctp_sendv_batch({
+    fd,
+    messages,
+    info,
+    flags
+  });
+
+  assert(typeof errno === "number");
+  assert(typeof messagesSent === "number");
+
+  return {
+    errno,
+    messagesSent
+  };
+};
+
+const IO_THREAD_NOTIFY_READABLE = 1;
+const IO_THREAD_NOTIFY_WRITABLE = 2;
+const IO_THREAD_EVENT_STRIDE = 2;
+
+// both io ring backends, the io thread and io_uring, share one interface,
+// associations are attached by fd and exchange messages through rings
+const wrapIoRings = ({ ioRings }) => {
+
+  assert(typeof ioRings === "object");
+  assert(typeof ioRings.errno === "number");
+
+  if (ioRings.errno !== 0) {
+    return { errno: ioRings.errno };
+  }
+
+  assert(typeof ioRings.attach === "function");
+  assert(typeof ioRings.receive_batch === "function");
+  assert(typeof ioRings.send_batch === "function");
+  assert(typeof ioRings.shutdown === "function");
+  assert(typeof ioRings.detach === "function");
+
+  // wrap functions to make sure this argument
+  // is always correct, as it is required by native code
+
+  const attach = ({ fd, ringSize }) => {
+    assert(typeof fd === "number");
+    assert(typeof ringSize === "number");
+
+    const { errno, id } = ioRings.attach({ fd, ringSize });
+
+    assert(typeof errno === "number");
+    if (errno === 0) {
+      assert(typeof id === "number");
+    }
+
+    return { errno, id };
+  };
+
+  const receive_batch = ({ id, maxMessages, maxBytes }) => {
+    assert(typeof id === "number");
+    assert(typeof maxMessages === "number" && maxMessages > 0);
+    assert(typeof maxBytes === "number");
+
+    const { errno, messages, info } = ioRings.receive_batch({ id, maxMessages, maxBytes });
+
+    assert(typeof errno === "number");
+    assert(Array.isArray(messages));
+    assert(info instanceof Uint32Array);
+    assert(info.length === messages.length * RECVV_BATCH_INFO_STRIDE);
+
+    return { errno, messages, info };
+  };
+
+  const send_batch = ({ id, messages, info }) => {
+    assert(typeof id === "number");
+    assert(Array.isArray(messages));
+    messages.forEach(assertMessage);
+    assert(info instanceof Uint32Array);
+    assert(info.length >= messages.length * SENDV_BATCH_INFO_STRIDE);
+
+    const { errno, messagesSent } = ioRings.send_batch({ id, messages, info });
+
+    assert(typeof errno === "number");
+    assert(typeof messagesSent === "number");
+
+    return { errno, messagesSent };
+  };
+
+  const shutdown = ({ id }) => {
+    assert(typeof id === "number");
+
+    const { errno } = ioRings.shutdown({ id });
+    assert(typeof errno === "number");
+
+    return { errno };
+  };
+
+  const detach = ({ id }) => {
+    assert(typeof id === "number");
+
+    ioRings.detach({ id });
+  };
+
+  return {
+    errno: 0,
+    attach,
+    receive_batch,
+    send_batch,
+    shutdown,
+    detach
+  };
+};
+
+const wrapIoRingsCallback = ({ callback, name }) => {
+  return (eventCount) => {
+    try {
+      callback({ eventCount });
+    } catch (ex) {
+      console.error(`${name} callback error`, ex);
+    }
+  };
+};
+
+// callback receives the number of notified associations, their id and
+// notifications are found in the events array, IO_THREAD_EVENT_STRIDE per id
+const create_io_thread = ({ events, callback }) => {
+
+  assert(events instanceof Int32Array);
+  assert(events.length >= IO_THREAD_EVENT_STRIDE);
+  assert(typeof callback === "function");
+
+  const ioRings = native.create_io_thread({
+    events,
+    callback: wrapIoRingsCallback({ callback, name: "io thread" })
+  });
+
+  return wrapIoRings({ ioRings });
+};
+
+// same as create_io_thread, but completion based on an io_uring instance
+// of the calling thread, fails with errno if the kernel lacks io_uring
+const create_io_uring = ({ events, callback }) => {
+
+  assert(events instanceof Int32Array);
+  assert(events.length >= IO_THREAD_EVENT_STRIDE);
+  assert(typeof callback === "function");
+
+  const ioRings = native.create_io_uring({
+    events,
+    callback: wrapIoRingsCallback({ callback, name: "io_uring" })
+  });
+
+  return wrapIoRings({ ioRings });
+};
+
 const setsockopt_sack_info = ({ fd, sack_assoc_id, sack_delay, sack_freq }) => {
 
   assert(typeof fd === "number");
@@ -217,25 +470,6 @@ const getsockopt_sctp_status = ({ fd }) => {
   };
 };
 
-const getsockopt_peer_addr_info = ({ fd, sockaddr }) => {
-
-  assert(typeof fd === "number");
-  assert(sockaddr instanceof Uint8Array);
-
-  const { errno, info } = native.getsockopt_peer_addr_info({ fd, sockaddr });
-
-  assert(typeof errno === "number");
-
-  if (errno === 0) {
-    assert(typeof info === "object");
-  }
-
-  return {
-    errno,
-    info
-  };
-};
-
 const setsockopt_sctp_initmsg = ({
   fd,
   sinit_num_ostreams,
@@ -295,6 +529,21 @@ const setsockopt_linger = ({ fd, onoff, linger }) => {
   return { errno };
 };
 
+const setsockopt_reuseport = ({ fd, value }) => {
+
+  assert(typeof fd === "number");
+  assert(typeof value === "number");
+
+  const { errno } = native.setsockopt_reuseport({
+    fd,
+    value
+  });
+
+  assert(typeof errno === "number");
+
+  return { errno };
+};
+
 const setsockopt_nodelay = ({ fd, value }) => {
 
   assert(typeof fd === "number");
@@ -327,51 +576,114 @@ const setsockopt_sctp_event = ({ fd, se_type, se_on }) => {
   return { errno };
 };
 
-const create_poller = ({ fd, callback }) => {
+const CONFIGURE_SOCKET_STRIDE = 5;
+
+const CONFIGURE_SOCKET_EVENT = 0;
+const CONFIGURE_SOCKET_SACK_INFO = 1;
+const CONFIGURE_SOCKET_RECVRCVINFO = 2;
+const CONFIGURE_SOCKET_NODELAY = 3;
+const CONFIGURE_SOCKET_INITMSG = 4;
+const CONFIGURE_SOCKET_FRAGMENT_INTERLEAVE = 5;
+const CONFIGURE_SOCKET_PARTIAL_DELIVERY_POINT = 6;
+const CONFIGURE_SOCKET_PR_SUPPORTED = 7;
+
+const configure_socket = ({ fd, options }) => {
 
   assert(typeof fd === "number");
-  assert(typeof callback === "function");
+  assert(options instanceof Uint32Array);
+  assert(options.length % CONFIGURE_SOCKET_STRIDE === 0);
 
-  const pollHandle = native.create_poller({
+  const { errno, failedIndex } = native.configure_socket({
     fd,
-    callback: (args) => {
+    options
+  });
+
+  assert(typeof errno === "number");
+  assert(typeof failedIndex === "number");
+
+  return {
+    errno,
+    failedIndex
+  };
+};
+
+const POLL_DISPATCH_READABLE = 1;
+const POLL_DISPATCH_WRITABLE = 2;
+const POLL_DISPATCH_EVENT_STRIDE = 3;
+
+const assertPollEvents = (events) => {
+  assert(typeof events === "object");
+  assert(typeof events.readable === "boolean");
+  assert(typeof events.writable === "boolean");
+};
+
+// callback(readyCount, status) receives the number of ready fds, their fd,
+// events and status are found in the events array, POLL_DISPATCH_EVENT_STRIDE per fd
+const create_poll_dispatcher = ({ events, callback }) => {
+
+  assert(events instanceof Int32Array);
+  assert(events.length >= POLL_DISPATCH_EVENT_STRIDE);
+  assert(typeof callback === "function");
+
+  const dispatcher = native.create_poll_dispatcher({
+    events,
+    callback: (readyCount, status) => {
       try {
-        callback(args);
+        callback(readyCount, status);
       } catch (ex) {
-        console.error("poll callback error", ex);
+        console.error("poll dispatcher callback error", ex);
       }
     }
   });
 
-  assert(typeof pollHandle === "object");
-  assert(typeof pollHandle.start === "function");
-  assert(typeof pollHandle.stop === "function");
-  assert(typeof pollHandle.close === "function");
+  assert(typeof dispatcher === "object");
+  assert(typeof dispatcher.errno === "number");
+
+  if (dispatcher.errno !== 0) {
+    return { errno: dispatcher.errno };
+  }
+
+  assert(typeof dispatcher.add === "function");
+  assert(typeof dispatcher.modify === "function");
+  assert(typeof dispatcher.remove === "function");
 
   // wrap functions to make sure this argument
   // is always correct, as it is required by native code
 
-  const start = ({ events }) => {
+  const add = ({ fd, events: requestedEvents }) => {
+    assert(typeof fd === "number");
+    assertPollEvents(requestedEvents);
 
-    assert(typeof events === "object");
-    assert(typeof events.readable === "boolean");
-    assert(typeof events.writable === "boolean");
+    const { errno } = dispatcher.add({ fd, events: requestedEvents });
+    assert(typeof errno === "number");
 
-    pollHandle.start({ events });
+    return { errno };
   };
 
-  const stop = () => {
-    pollHandle.stop();
+  const modify = ({ fd, events: requestedEvents }) => {
+    assert(typeof fd === "number");
+    assertPollEvents(requestedEvents);
+
+    const { errno } = dispatcher.modify({ fd, events: requestedEvents });
+    assert(typeof errno === "number");
+
+    return { errno };
   };
 
-  const close = () => {
-    pollHandle.close();
+  const remove = ({ fd }) => {
+    assert(typeof fd === "number");
+
+    const { errno } = dispatcher.remove({ fd });
+    assert(typeof errno === "number");
+
+    return { errno };
   };
 
   return {
-    start,
-    stop,
-    close
+    errno: 0,
+    add,
+    modify,
+    remove
   };
 };
 
@@ -436,11 +748,14 @@ const getpeername = ({ fd, sockaddr }) => {
   return { errno };
 };
 
-const sctp_getpaddrs = ({ fd }) => {
+// assocId selects the association on one-to-many sockets
+const sctp_getpaddrs = ({ fd, assocId = 0 }) => {
   assert(typeof fd === "number");
+  assert(typeof assocId === "number");
 
   const { errno, sockaddrs } = native.sctp_getpaddrs({
-    fd
+    fd,
+    assocId
   });
 
   assert(typeof errno === "number");
@@ -455,6 +770,73 @@ const sctp_getpaddrs = ({ fd }) => {
   return { errno, sockaddrs };
 };
 
+// addresses of an association and, with withPeerInfo, the path info of
+// every remote address, remote fields are undefined if not connected
+const snapshot_association = ({ fd, assocId = 0, withLocal, withPeerInfo }) => {
+  assert(typeof fd === "number");
+  assert(typeof assocId === "number");
+  assert(typeof withLocal === "boolean");
+  assert(typeof withPeerInfo === "boolean");
+
+  const result = native.snapshot_association({
+    fd,
+    assocId,
+    withLocal,
+    withPeerInfo
+  });
+
+  assert(typeof result.errno === "number");
+
+  if (result.errno !== 0) {
+    assert(typeof result.operation === "string");
+  } else if (result.remoteAddresses !== undefined) {
+    assert(Array.isArray(result.remoteAddresses));
+  }
+
+  return result;
+};
+
+const ASSOC_STATS_FIELDS = 22;
+const ASSOC_STATS_PATH_FIELDS = 5;
+
+// polled at high frequency, so the argument object is passed on as it is
+// and callers can reuse it, returns the number of remote addresses or -errno
+const get_association_stats = (args) => {
+  assert(typeof args.fd === "number");
+  assert(typeof args.assocId === "number");
+  assert(args.stats instanceof Float64Array);
+  assert(args.stats.length >= ASSOC_STATS_FIELDS);
+  assert(args.paths instanceof Float64Array);
+
+  const result = native.get_association_stats(args);
+
+  assert(Number.isInteger(result));
+
+  return result;
+};
+
+// sid -1 for all streams of the association
+const getsockopt_pr_status = ({ fd, assocId, sid }) => {
+  assert(typeof fd === "number");
+  assert(typeof assocId === "number");
+  assert(typeof sid === "number");
+
+  const { errno, abandonedUnsent, abandonedSent } = native.getsockopt_pr_status({ fd, assocId, sid });
+
+  assert(typeof errno === "number");
+
+  if (errno === 0) {
+    assert(typeof abandonedUnsent === "number");
+    assert(typeof abandonedSent === "number");
+  }
+
+  return {
+    errno,
+    abandonedUnsent,
+    abandonedSent
+  };
+};
+
 const shutdown = ({ fd, how }) => {
   assert(typeof fd === "number");
   assert(typeof how === "number");
@@ -481,17 +863,26 @@ const close_fd = ({ fd }) => {
   return { errno };
 };
 
-const parse_sctp_notification = ({ notification }) => {
-  assert(Buffer.isBuffer(notification));
+// layout of the fields decode_sctp_notification() fills in
+const NOTIFICATION_FIELD_TYPE = 0;
+const NOTIFICATION_FIELD_FLAGS = 1;
+const NOTIFICATION_FIELD_LENGTH = 2;
+const NOTIFICATION_FIELD_ASSOC_ID = 3;
+const NOTIFICATION_FIELD_VALUES = 4;
+const NOTIFICATION_FIELDS = 12;
 
-  const parsed = native.parse_sctp_notification({
-    notification
-  });
+// called for every received notification, so the argument object is
+// passed on as it is and callers can reuse it
+const decode_sctp_notification = (args) => {
+  assert(args.notification instanceof Uint8Array);
+  assert(args.fields instanceof Uint32Array);
+  assert(args.fields.length >= NOTIFICATION_FIELDS);
+
+  const type = native.decode_sctp_notification(args);
 
-  assert(typeof parsed === "object");
-  assert(typeof parsed.sn_type === "number");
+  assert(typeof type === "number");
 
-  return parsed;
+  return type;
 };
 
 module.exports = {
@@ -500,23 +891,59 @@ module.exports = {
   sctp_connectx,
   listen,
   accept,
+  accept_batch,
+  sctp_peeloff,
   sctp_recvv,
+  sctp_recvv_batch,
+  RECVV_BATCH_INFO_STRIDE,
+  MAX_MESSAGE_PARTS,
   sctp_sendv,
+  sctp_sendv_batch,
+  SENDV_BATCH_INFO_STRIDE,
   setsockopt_sack_info,
   getsockopt_sctp_status,
-  getsockopt_peer_addr_info,
   setsockopt_sctp_initmsg,
   setsockopt_sctp_recvrcvinfo,
   setsockopt_linger,
   setsockopt_nodelay,
+  setsockopt_reuseport,
   setsockopt_sctp_event,
-  create_poller,
+  configure_socket,
+  CONFIGURE_SOCKET_STRIDE,
+  CONFIGURE_SOCKET_EVENT,
+  CONFIGURE_SOCKET_SACK_INFO,
+  CONFIGURE_SOCKET_RECVRCVINFO,
+  CONFIGURE_SOCKET_NODELAY,
+  CONFIGURE_SOCKET_INITMSG,
+  CONFIGURE_SOCKET_FRAGMENT_INTERLEAVE,
+  CONFIGURE_SOCKET_PARTIAL_DELIVERY_POINT,
+  CONFIGURE_SOCKET_PR_SUPPORTED,
+  create_poll_dispatcher,
+  create_io_thread,
+  create_io_uring,
+  IO_THREAD_NOTIFY_READABLE,
+  IO_THREAD_NOTIFY_WRITABLE,
+  IO_THREAD_EVENT_STRIDE,
+  POLL_DISPATCH_READABLE,
+  POLL_DISPATCH_WRITABLE,
+  POLL_DISPATCH_EVENT_STRIDE,
   get_socket_error,
   getsockname,
   sctp_getladdrs,
   getpeername,
   sctp_getpaddrs,
+  snapshot_association,
+  get_association_stats,
+  getsockopt_pr_status,
+  ASSOC_STATS_FIELDS,
+  ASSOC_STATS_PATH_FIELDS,
   shutdown,
   close_fd,
-  parse_sctp_notification
+  decode_sctp_notification,
+  NOTIFICATION_FIELD_TYPE,
+  NOTIFICATION_FIELD_FLAGS,
+  NOTIFICATION_FIELD_LENGTH,
+  NOTIFICATION_FIELD_ASSOC_ID,
+  NOTIFICATION_FIELD_VALUES,
+  NOTIFICATION_FIELDS
 };
@@ -1,6 +1,203 @@
+const nodeOsModule = require("node:os");
+
+const native = require("./native.js");
 const constants = require("./constants.js");
 const sockaddrTranscoder = require("./sockaddr.js");
 
+// every notification is decoded into these fields, they are only valid
+// until the next one is decoded, so read what is needed right away
+const fields = new Uint32Array(native.NOTIFICATION_FIELDS);
+const decodeArgs = { notification: undefined, fields };
+
+// returns the notification type, nothing is allocated
+const decode = ({ notification }) => {
+  decodeArgs.notification = notification;
+  const type = native.decode_sctp_notification(decodeArgs);
+  decodeArgs.notification = undefined;
+
+  return type;
+};
+
+const value = (idx) => {
+  return fields[native.NOTIFICATION_FIELD_VALUES + idx];
+};
+
+// sac_state of the SCTP_ASSOC_CHANGE decoded last
+const assocChangeState = () => {
+  return value(0);
+};
+
+const assocId = () => {
+  return fields[native.NOTIFICATION_FIELD_ASSOC_ID] | 0;
+};
+
+// the stream list is in host byte order
+const readStreamNumber = nodeOsModule.endianness() === "LE" ? "readUInt16LE" : "readUInt16BE";
+
+// variable length parts stay views into the received notification
+const part = ({ notification, offset, length }) => {
+  return Buffer.from(notification.buffer, notification.byteOffset + offset, length);
+};
+
+// member and field prefix as in union sctp_notification, plus the type
+// specific fields in the order decode_sctp_notification() stores them
+const parsers = {
+  [constants.SCTP_ASSOC_CHANGE]: () => {
+    return {
+      member: "sn_assoc_change",
+      prefix: "sac",
+      values: {
+        sac_state: value(0),
+        sac_error: value(1),
+        sac_outbound_streams: value(2),
+        sac_inbound_streams: value(3)
+      }
+    };
+  },
+
+  [constants.SCTP_PEER_ADDR_CHANGE]: ({ notification }) => {
+    return {
+      member: "sn_paddr_change",
+      prefix: "spc",
+      values: {
+        spc_aaddr: part({ notification, offset: value(2), length: value(3) }),
+        spc_state: value(0),
+        spc_error: value(1)
+      }
+    };
+  },
+
+  [constants.SCTP_REMOTE_ERROR]: ({ notification }) => {
+    return {
+      member: "sn_remote_error",
+      prefix: "sre",
+      values: {
+        sre_error: value(0),
+        sre_data: part({ notification, offset: value(1), length: value(2) })
+      }
+    };
+  },
+
+  [constants.SCTP_SEND_FAILED_EVENT]: ({ notification }) => {
+    return {
+      member: "sn_send_failed_event",
+      prefix: "ssf",
+      values: {
+        ssf_error: value(0),
+        ssfe_info: {
+          snd_sid: value(1),
+          snd_flags: value(2),
+          snd_ppid: value(3),
+          snd_context: value(4)
+        },
+        ssf_data: part({ notification, offset: value(5), length: value(6) })
+      }
+    };
+  },
+
+  [constants.SCTP_SHUTDOWN_EVENT]: () => {
+    return { member: "sn_shutdown_event", prefix: "sse", values: {} };
+  },
+
+  [constants.SCTP_ADAPTATION_INDICATION]: () => {
+    return {
+      member: "sn_adaptation_event",
+      prefix: "sai",
+      values: {
+        sai_adaptation_ind: value(0)
+      }
+    };
+  },
+
+  [constants.SCTP_PARTIAL_DELIVERY_EVENT]: () => {
+    return {
+      member: "sn_pdapi_event",
+      prefix: "pdapi",
+      values: {
+        pdapi_indication: value(0),
+        pdapi_stream: value(1),
+        pdapi_seq: value(2)
+      }
+    };
+  },
+
+  [constants.SCTP_AUTHENTICATION_EVENT]: () => {
+    return {
+      member: "sn_authkey_event",
+      prefix: "auth",
+      values: {
+        auth_keynumber: value(0),
+        auth_indication: value(1)
+      }
+    };
+  },
+
+  [constants.SCTP_SENDER_DRY_EVENT]: () => {
+    return { member: "sn_sender_dry_event", prefix: "sender_dry", values: {} };
+  },
+
+  [constants.SCTP_STREAM_RESET_EVENT]: ({ notification }) => {
+    const list = part({ notification, offset: value(0), length: value(1) * 2 });
+    const streams = [];
+    for (let i = 0; i < value(1); i += 1) {
+      streams.push(list[readStreamNumber](i * 2));
+    }
+
+    return {
+      member: "sn_strreset_event",
+      prefix: "strreset",
+      values: {
+        strreset_stream_list: streams
+      }
+    };
+  },
+
+  [constants.SCTP_ASSOC_RESET_EVENT]: () => {
+    return {
+      member: "sn_assocreset_event",
+      prefix: "assocreset",
+      values: {
+        assocreset_local_tsn: value(0),
+        assocreset_remote_tsn: value(1)
+      }
+    };
+  },
+
+  [constants.SCTP_STREAM_CHANGE_EVENT]: () => {
+    return {
+      member: "sn_strchange_event",
+      prefix: "strchange",
+      values: {
+        strchange_instrms: value(0),
+        strchange_outstrms: value(1)
+      }
+    };
+  }
+};
+
+// builds the full object, only done when somebody looks at it
+const parse = ({ notification }) => {
+  const type = decode({ notification });
+  const parsed = { sn_type: type };
+
+  const parser = parsers[type];
+  if (parser === undefined) {
+    return parsed;
+  }
+
+  const { member, prefix, values } = parser({ notification });
+
+  parsed[member] = {
+    [`${prefix}_type`]: type,
+    [`${prefix}_flags`]: fields[native.NOTIFICATION_FIELD_FLAGS],
+    [`${prefix}_length`]: fields[native.NOTIFICATION_FIELD_LENGTH],
+    ...values,
+    [`${prefix}_assoc_id`]: assocId()
+  };
+
+  return parsed;
+};
+
 const sacStateToStringMap = {
   [constants.SCTP_COMM_UP]: "SCTP_COMM_UP",
   [constants.SCTP_COMM_LOST]: "SCTP_COMM_LOST",
@@ -85,6 +282,51 @@ const interpret = ({ notification }) => {
   return interpreter({ notification });
 };
 
+// the event emitted as "notification", parsed and interpreted are built
+// on first access, so notifications nobody looks at cost next to nothing
+const createEvent = ({ notification }) => {
+  let parsed = undefined;
+  let interpreted = undefined;
+  let interpretedBuilt = false;
+
+  const getParsed = () => {
+    if (parsed === undefined) {
+      parsed = parse({ notification });
+    }
+
+    return parsed;
+  };
+
+  return {
+    raw: notification,
+
+    get parsed() {
+      return getParsed();
+    },
+
+    get interpreted() {
+      if (!interpretedBuilt) {
+        interpreted = interpret({ notification: getParsed() });
+        interpretedBuilt = true;
+      }
+
+      return interpreted;
+    }
+  };
+};
+
+// no event object at all without listeners
+const emit = ({ emitter, notification }) => {
+  if (emitter.listenerCount("notification") > 0) {
+    emitter.emit("notification", createEvent({ notification }));
+  }
+};
+
 module.exports = {
-  interpret
+  decode,
+  assocChangeState,
+  parse,
+  interpret,
+  createEvent,
+  emit
 };
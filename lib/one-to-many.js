@@ -0,0 +1,604 @@
+/* eslint-disable max-statements */
+/* eslint-disable no-use-before-define */
+
+const nodeEventsModule = require("node:events");
+
+const native = require("./native.js");
+const ioPoll = require("./io-poll.js");
+const constants = require("./constants.js");
+const errors = require("./errors.js");
+const queueFactory = require("./queue.js");
+const socketCommon = require("./socket-common.js");
+const socketDriver = require("./socket-driver.js");
+const notifications = require("./notifications.js");
+const associationFactory = require("./association.js");
+const messageAssembler = require("./message-assembler.js");
+
+// one-to-many endpoint, all associations share one SOCK_SEQPACKET socket,
+// so they cost no fd and no poll handle each: received messages are routed
+// by association id to lightweight association objects, sends carry the
+// association id they are addressed to
+
+const errnoCodes = constants.errno;
+
+const MAX_MESSAGES_PER_SEND = 64;
+
+// messages taken from one association per send batch, so a busy
+// association can't starve the others
+const MAX_MESSAGES_PER_ASSOCIATION_AND_SEND = 16;
+
+// every association queues message, sid, ppid, flags and PR-SCTP value
+// back to back
+const SEND_QUEUE_STRIDE = 5;
+
+// only used synchronously, so all endpoints of this thread share them
+const sendInfo = new Uint32Array(MAX_MESSAGES_PER_SEND * native.SENDV_BATCH_INFO_STRIDE);
+const messagesToSend = [];
+const recordsToSend = [];
+
+// ordered and reliable
+const NO_SEND_OPTIONS = Object.freeze({});
+
+const isAssociationGone = ({ sacState }) => {
+  return sacState === constants.SCTP_COMM_LOST ||
+    sacState === constants.SCTP_SHUTDOWN_COMP ||
+    sacState === constants.SCTP_CANT_STR_ASSOC;
+};
+
+const create = ({
+  fd,
+  onAssociation,
+  onError,
+  maxMessagesPerReceive = 64,
+  maxBytesPerReceive = 256 * 1024,
+  highWaterMark = 64 * 1024,
+  peeloffIoBackend = ioPoll,
+  onDemandNotifications = [],
+  partialDelivery = "assemble"
+}) => {
+
+  const recordsById = new Map();
+
+  // associations with queued messages, in the order they are served
+  const readyRecords = queueFactory.create();
+
+  let closed = false;
+
+  // notifications are joined here, data per association, as with fragment
+  // interleave level 1 pieces of different associations may alternate
+  const notificationAssembler = messageAssembler.create();
+
+  // only the first piece of a notification tells its association
+  let notificationAssocId = 0;
+
+  // associations peeled off while a batch is delivered, by association id,
+  // the rest of the batch is forwarded to them
+  const peeledInBatch = new Map();
+  let deliveringBatch = false;
+
+  const maybeScheduleNextMicrotask = () => {
+    driver.schedule();
+  };
+
+  const markReady = ({ record }) => {
+    if (!record.ready) {
+      record.ready = true;
+      readyRecords.push(record);
+    }
+
+    maybeScheduleNextMicrotask();
+  };
+
+  const dropQueuedMessages = ({ record }) => {
+    record.sendQueue = queueFactory.create();
+    record.queuedBytes = 0;
+  };
+
+  // the association is gone from the endpoint, queued messages are
+  // dropped, only an abort queued by destroy() is sent afterwards
+  const release = ({ record, error }) => {
+    if (record.released) {
+      return;
+    }
+
+    record.released = true;
+    recordsById.delete(record.assocId);
+    dropQueuedMessages({ record });
+
+    process.nextTick(() => {
+      if (error !== undefined) {
+        record.association.emit("error", error);
+      }
+
+      record.association.emit("close");
+    });
+  };
+
+  const enqueue = ({ record, message, sid, ppid, flags, prValue = 0 }) => {
+    record.sendQueue.push(message);
+    record.sendQueue.push(sid);
+    record.sendQueue.push(ppid);
+    record.sendQueue.push(flags);
+    record.sendQueue.push(prValue);
+    record.queuedBytes += message.length;
+
+    markReady({ record });
+  };
+
+  const createRecord = ({ assocId }) => {
+    const association = new nodeEventsModule.EventEmitter();
+
+    const record = {
+      assocId,
+      association,
+      sendQueue: queueFactory.create(),
+      assembler: messageAssembler.create({ partialDelivery }),
+      queuedBytes: 0,
+      needDrain: false,
+      ending: false,
+      remoteEnded: false,
+      released: false,
+      ready: false
+    };
+
+    association.assocId = assocId;
+
+    association.onMessage = (message, sid, ppid, flags) => {
+      association.emit("message", message, sid, ppid, flags);
+    };
+
+    // returns false once more than highWaterMark bytes are queued for
+    // this association, "drain" is emitted when it fell below again
+    association.send = (message, sid = 0, ppid = 0, sendOptions = NO_SEND_OPTIONS) => {
+      if (record.released || record.ending) {
+        throw Error("send after end or destroy");
+      }
+
+      if (!(message instanceof Uint8Array)) {
+        throw Error("message must be a Buffer or Uint8Array");
+      }
+
+      const flags = socketCommon.sendFlagsOf(sendOptions);
+      enqueue({ record, message, sid, ppid, flags, prValue: socketCommon.prValueOf(sendOptions) });
+
+      record.needDrain = record.needDrain || record.queuedBytes >= highWaterMark;
+
+      return !record.needDrain;
+    };
+
+    // shuts the association down once everything queued before is sent,
+    // "close" is emitted once the shutdown completed
+    association.end = () => {
+      if (record.released || record.ending) {
+        return;
+      }
+
+      record.ending = true;
+      enqueue({ record, message: Buffer.alloc(0), sid: 0, ppid: 0, flags: constants.SCTP_EOF });
+    };
+
+    association.destroy = (error) => {
+      if (record.released) {
+        return;
+      }
+
+      record.ending = true;
+      release({ record, error });
+
+      if (!closed) {
+        enqueue({ record, message: Buffer.alloc(0), sid: 0, ppid: 0, flags: constants.SCTP_ABORT });
+      }
+    };
+
+    // moves the association to a socket of its own, returns it as lean
+    // association, messages queued so far are sent from there
+    association.peeloff = () => {
+      if (record.released) {
+        throw Error("peeloff after end or destroy");
+      }
+
+      return peeloff({ record });
+    };
+
+    association.abandoned = (sid) => {
+      return socketCommon.getAbandonedMessages({ native, fd, assocId, sid });
+    };
+
+    association.remoteAddress = () => {
+      const addresses = socketCommon.getRemoteAddresses({ native, fd, assocId });
+      return addresses === undefined ? undefined : addresses[0];
+    };
+
+    association.remoteAddresses = () => {
+      return socketCommon.getRemoteAddresses({ native, fd, assocId });
+    };
+
+    Object.defineProperty(association, "queuedBytes", {
+      get: () => {
+        return record.queuedBytes;
+      }
+    });
+
+    // subscriptions of one association don't affect the others
+    socketCommon.subscribeNotificationsOnDemand({
+      native,
+      emitter: association,
+      fd,
+      assocId,
+      types: onDemandNotifications,
+      isOpen: () => {
+        return !record.released && !closed;
+      }
+    });
+
+    return record;
+  };
+
+  const peeloff = ({ record }) => {
+    // the rest of the message would be received by the peeled off socket
+    if (record.assembler.pending()) {
+      throw Error("associations can't be peeled off while a message is partially received");
+    }
+
+    // only known while the association is on this socket
+    const remoteAddresses = socketCommon.getRemoteAddresses({ native, fd, assocId: record.assocId });
+    const initialRemoteAddress = remoteAddresses === undefined ? undefined : remoteAddresses[0];
+
+    const { errno, fd: peeledFd } = native.sctp_peeloff({ fd, assocId: record.assocId });
+    if (errno !== errnoCodes.NO_ERROR) {
+      throw errors.createErrorFromErrno({ operation: "sctp_peeloff()", errno });
+    }
+
+    // the kernel moved the association, including what it has received,
+    // but not what is already in the batch being delivered
+    record.released = true;
+    recordsById.delete(record.assocId);
+
+    const pendingBatch = { errno: errnoCodes.NO_ERROR, messages: [], info: [] };
+    if (deliveringBatch) {
+      peeledInBatch.set(record.assocId, pendingBatch);
+    }
+
+    const peeled = associationFactory.create({
+      fd: peeledFd,
+      connected: true,
+      initialRemoteAddress,
+      ioBackend: peeloffIoBackend,
+      highWaterMark,
+      onDemandNotifications,
+      partialDelivery,
+      pendingBatch
+    });
+
+    while (record.sendQueue.length > 0) {
+      const message = record.sendQueue.shift();
+      const sid = record.sendQueue.shift();
+      const ppid = record.sendQueue.shift();
+      const flags = record.sendQueue.shift();
+      const prValue = record.sendQueue.shift();
+
+      if ((flags & constants.SCTP_EOF) === 0) {
+        peeled.send(message, sid, ppid, socketCommon.sendOptionsOf({ flags, prValue }));
+      } else {
+        peeled.end();
+      }
+    }
+
+    record.queuedBytes = 0;
+
+    return peeled;
+  };
+
+  const handleAssocChange = ({ assocId, sacState }) => {
+    let record = recordsById.get(assocId);
+
+    if (record === undefined && sacState === constants.SCTP_COMM_UP) {
+      record = createRecord({ assocId });
+      recordsById.set(assocId, record);
+      onAssociation(record.association);
+      return record;
+    }
+
+    if (record !== undefined && isAssociationGone({ sacState })) {
+      if (!record.remoteEnded) {
+        record.remoteEnded = true;
+        record.association.emit("end");
+      }
+
+      release({ record });
+    }
+
+    return record;
+  };
+
+  // same layout as the info of a received batch
+  const forwardToPeeled = ({ piece, flags, sid, ppid, assocId }) => {
+    const batch = peeledInBatch.get(assocId);
+    if (batch === undefined) {
+      return;
+    }
+
+    batch.messages.push(piece);
+    batch.info.push(flags, 1, sid, ppid, assocId);
+  };
+
+  const handleNotification = ({ rawNotification, assocId }) => {
+    const type = notifications.decode({ notification: rawNotification });
+
+    let record = recordsById.get(assocId);
+
+    if (type === constants.SCTP_ASSOC_CHANGE) {
+      record = handleAssocChange({ assocId, sacState: notifications.assocChangeState() });
+    } else if (type === constants.SCTP_SHUTDOWN_EVENT && record !== undefined && !record.remoteEnded) {
+      // the kernel completes the shutdown, no half open associations,
+      // so nothing queued can be sent anymore
+      record.remoteEnded = true;
+      record.ending = true;
+      dropQueuedMessages({ record });
+      record.association.emit("end");
+    }
+
+    if (record === undefined) {
+      forwardToPeeled({
+        piece: rawNotification,
+        flags: constants.MSG_NOTIFICATION | constants.MSG_EOR,
+        sid: 0,
+        ppid: 0,
+        assocId
+      });
+      return;
+    }
+
+    if (record.released) {
+      return;
+    }
+
+    notifications.emit({ emitter: record.association, notification: rawNotification });
+  };
+
+  const handleNotificationPiece = ({ piece, flags, assocId }) => {
+    if (!notificationAssembler.pending()) {
+      notificationAssocId = assocId;
+    }
+
+    const rawNotification = notificationAssembler.receive({ piece, flags });
+    if (rawNotification !== undefined) {
+      handleNotification({ rawNotification, assocId: notificationAssocId });
+    }
+  };
+
+  const handleMessage = ({ piece, flags, sid, ppid, assocId }) => {
+    if ((flags & constants.MSG_NOTIFICATION) !== 0) {
+      handleNotificationPiece({ piece, flags, assocId });
+      return;
+    }
+
+    const record = recordsById.get(assocId);
+    if (record === undefined) {
+      // association already destroyed, or peeled off during this batch
+      forwardToPeeled({ piece, flags, sid, ppid, assocId });
+      return;
+    }
+
+    const message = record.assembler.receive({ piece, flags });
+    if (message !== undefined) {
+      record.association.onMessage(message, sid, ppid, flags);
+    }
+  };
+
+  const fail = ({ error }) => {
+    if (closed) {
+      return;
+    }
+
+    close();
+    onError(error);
+  };
+
+  const deliverBatch = ({ messages, info }) => {
+    deliveringBatch = true;
+
+    try {
+      for (let i = 0; i < messages.length && !closed; i += 1) {
+        const offset = i * native.RECVV_BATCH_INFO_STRIDE;
+        const view = messages[i];
+
+        handleMessage({
+          piece: Buffer.from(view.buffer, view.byteOffset, view.byteLength),
+          flags: info[offset],
+          sid: info[offset + 2],
+          ppid: info[offset + 3],
+          assocId: info[offset + 4]
+        });
+      }
+    } finally {
+      deliveringBatch = false;
+      peeledInBatch.clear();
+    }
+  };
+
+  const tryReceiveNext = () => {
+    if (!driver.socketMaybeHasMore) {
+      return false;
+    }
+
+    const { errno, messages, info } = ioHandle.receiveBatch({
+      maxMessages: maxMessagesPerReceive,
+      maxBytes: maxBytesPerReceive
+    });
+
+    deliverBatch({ messages, info });
+
+    if (closed) {
+      return true;
+    }
+
+    if (errno === errnoCodes.EAGAIN) {
+      driver.socketMaybeHasMore = false;
+    } else if (errno !== errnoCodes.NO_ERROR) {
+      fail({ error: errors.createErrorFromErrno({ operation: "sctp_recvv()", errno }) });
+      return true;
+    }
+
+    return messages.length > 0;
+  };
+
+  const gatherFromRecord = ({ record, count }) => {
+    const available = record.sendQueue.length / SEND_QUEUE_STRIDE;
+    const taken = Math.min(available, MAX_MESSAGES_PER_ASSOCIATION_AND_SEND, MAX_MESSAGES_PER_SEND - count);
+
+    for (let i = 0; i < taken; i += 1) {
+      const queueOffset = i * SEND_QUEUE_STRIDE;
+      const infoOffset = (count + i) * native.SENDV_BATCH_INFO_STRIDE;
+
+      messagesToSend[count + i] = record.sendQueue.get(queueOffset);
+      recordsToSend[count + i] = record;
+      sendInfo[infoOffset] = record.sendQueue.get(queueOffset + 1);
+      sendInfo[infoOffset + 1] = record.sendQueue.get(queueOffset + 2);
+      sendInfo[infoOffset + 2] = record.sendQueue.get(queueOffset + 3);
+      sendInfo[infoOffset + 3] = 0;
+      sendInfo[infoOffset + 4] = record.assocId;
+      sendInfo[infoOffset + 5] = record.sendQueue.get(queueOffset + 4);
+    }
+
+    return taken;
+  };
+
+  // round robin over the associations with queued messages, every
+  // association is visited at most once per batch
+  const gatherMessagesToSend = () => {
+    const rounds = readyRecords.length;
+    let count = 0;
+
+    for (let round = 0; round < rounds && count < MAX_MESSAGES_PER_SEND; round += 1) {
+      const record = readyRecords.shift();
+
+      if (record.sendQueue.length === 0) {
+        record.ready = false;
+        continue;
+      }
+
+      count += gatherFromRecord({ record, count });
+      readyRecords.push(record);
+    }
+
+    messagesToSend.length = count;
+    recordsToSend.length = count;
+
+    return count;
+  };
+
+  const completeSentMessage = ({ record }) => {
+    record.queuedBytes -= record.sendQueue.shift().length;
+    record.sendQueue.shift();
+    record.sendQueue.shift();
+    record.sendQueue.shift();
+    record.sendQueue.shift();
+
+    if (record.needDrain && record.queuedBytes < highWaterMark && !record.released) {
+      record.needDrain = false;
+      record.association.emit("drain");
+    }
+  };
+
+  // a send error is caused by the association the message was addressed
+  // to, e.g. it is already gone, the endpoint itself keeps working
+  const failSendRecord = ({ record, errno }) => {
+    dropQueuedMessages({ record });
+    release({ record, error: errors.createErrorFromErrno({ operation: "sctp_sendv()", errno }) });
+  };
+
+  const trySendNext = () => {
+    if (!driver.socketMaybeTakesMore || gatherMessagesToSend() === 0) {
+      return false;
+    }
+
+    const { errno, messagesSent } = ioHandle.sendBatch({
+      messages: messagesToSend,
+      info: sendInfo
+    });
+
+    for (let i = 0; i < messagesSent; i += 1) {
+      completeSentMessage({ record: recordsToSend[i] });
+    }
+
+    const failedRecord = recordsToSend[messagesSent];
+
+    // don't keep sent messages alive
+    messagesToSend.length = 0;
+    recordsToSend.length = 0;
+
+    if (closed) {
+      return true;
+    }
+
+    if (errno === errnoCodes.EAGAIN) {
+      driver.socketMaybeTakesMore = false;
+      return messagesSent > 0;
+    }
+
+    if (errno !== errnoCodes.NO_ERROR) {
+      failSendRecord({ record: failedRecord, errno });
+      return true;
+    }
+
+    return messagesSent > 0;
+  };
+
+  const driver = socketDriver.create({
+    fd,
+    ioBackend: ioPoll,
+    socketMaybeTakesMore: true,
+
+    isDone: () => {
+      return closed;
+    },
+
+    step: () => {
+      return tryReceiveNext() || trySendNext();
+    },
+
+    idle: () => {
+      ioHandle.update({
+        events: {
+          readable: true,
+          writable: readyRecords.length > 0
+        }
+      });
+    },
+
+    onError: (error) => {
+      fail({ error });
+    }
+  });
+
+  const ioHandle = driver.handle;
+
+  // closes the socket, which aborts all associations on it
+  const close = () => {
+    if (closed) {
+      return;
+    }
+
+    closed = true;
+    ioHandle.close();
+
+    recordsById.forEach((record) => {
+      release({ record });
+    });
+  };
+
+  maybeScheduleNextMicrotask();
+
+  return {
+    close,
+
+    get associationCount() {
+      return recordsById.size;
+    }
+  };
+};
+
+module.exports = {
+  create
+};
@@ -1,68 +1,179 @@
 const native = require("./native.js");
+const errors = require("./errors.js");
 
-const create = ({ fd, callback }) => {
+// all fds of this thread share one native poll dispatcher, it reports the
+// ready fds of a loop iteration at once, up to this many per iteration
+const MAX_READY_EVENTS = 1024;
 
-  let pending = false;
-  let closed = false;
+const readyEvents = new Int32Array(MAX_READY_EVENTS * native.POLL_DISPATCH_EVENT_STRIDE);
+
+const callbacksByFd = new Map();
+
+// callbacks are called with (status, events), events being a mask of
+// READABLE and WRITABLE, so dispatching a wakeup allocates nothing
+const READABLE = native.POLL_DISPATCH_READABLE;
+const WRITABLE = native.POLL_DISPATCH_WRITABLE;
+
+let dispatcher = undefined;
+let pending = false;
+let pendingReadyCount = 0;
+let pendingStatus = 0;
+
+const reportException = (ex) => {
+  // keep serving the other fds, but still raise an uncaught exception,
+  // see the microtask scheduler
+  process.nextTick(() => {
+    throw ex;
+  });
+};
 
-  const nativePollHandle = native.create_poller({
-    fd,
+const callAndReportExceptions = ({ callback, args }) => {
+  try {
+    callback(args);
+  } catch (ex) {
+    reportException(ex);
+  }
+};
 
-    callback: (args) => {
+const callWithEventsAndReportExceptions = (callback, status, events) => {
+  try {
+    callback(status, events);
+  } catch (ex) {
+    reportException(ex);
+  }
+};
 
-      if (pending) {
-        // raise unhandled exception
-        // this should never happen
-        Promise.resolve().then(() => {
-          throw Error("poller callback before microtask was run, this should not happen");
-        });
-      }
+const dispatchPending = () => {
+  pending = false;
 
-      // schedule a microtask to run the callback
-      // otherwise, exceptions will be reported to native code
-      // we want it to raise an uncaught exception
-      pending = true;
-      Promise.resolve().then(() => {
-        pending = false;
+  if (pendingStatus !== 0) {
+    // the dispatcher itself failed, all fds are affected
+    callbacksByFd.forEach((callback) => {
+      callWithEventsAndReportExceptions(callback, pendingStatus, 0);
+    });
+    return;
+  }
 
-        if (closed) {
-          return;
-        }
+  for (let i = 0; i < pendingReadyCount; i += 1) {
+    const offset = i * native.POLL_DISPATCH_EVENT_STRIDE;
+    const callback = callbacksByFd.get(readyEvents[offset]);
 
-        callback(args);
+    // fd might have been closed by a callback before
+    if (callback !== undefined) {
+      callWithEventsAndReportExceptions(callback, readyEvents[offset + 2], readyEvents[offset + 1]);
+    }
+  }
+};
+
+const onReady = (readyCount, status) => {
+
+  if (pending) {
+    // raise unhandled exception
+    // this should never happen
+    Promise.resolve().then(() => {
+      throw Error("poller callback before microtask was run, this should not happen");
+    });
+  }
+
+  // run the callbacks in a microtask, otherwise exceptions would be
+  // reported to native code, we want them to raise an uncaught exception,
+  // the microtask is always the same function, the counts are kept aside
+  pending = true;
+  pendingReadyCount = readyCount;
+  pendingStatus = status;
+  queueMicrotask(dispatchPending);
+
+  // always report back to native code immediately
+  // and without any exceptions
+
+  // handling errors in native code is tricky
+};
+
+const getDispatcher = () => {
+  if (dispatcher === undefined) {
+    const created = native.create_poll_dispatcher({
+      events: readyEvents,
+      callback: onReady
+    });
+
+    if (created.errno !== 0) {
+      throw errors.createErrorFromErrno({
+        operation: "epoll_create1()",
+        errno: created.errno
       });
+    }
+
+    dispatcher = created;
+  }
+
+  return dispatcher;
+};
 
-      // always report back to native code immediately
-      // and without any exceptions
+const create = ({ fd, callback }) => {
+
+  if (callbacksByFd.has(fd)) {
+    throw Error(`fd ${fd} already has a poller`);
+  }
+
+  callbacksByFd.set(fd, callback);
+
+  let closed = false;
+
+  // events last applied, kept as flags, updates are frequent
+  let lastReadable = false;
+  let lastWritable = false;
 
-      // handling errors in native code is tricky
+  const isRegistered = () => {
+    return lastReadable || lastWritable;
+  };
+
+  const applyEvents = ({ events }) => {
+    const register = events.readable || events.writable;
+
+    if (!isRegistered()) {
+      return getDispatcher().add({ fd, events });
+    }
+
+    if (!register) {
+      return getDispatcher().remove({ fd });
     }
-  });
 
-  let lastEvents = {
-    readable: false,
-    writable: false
+    return getDispatcher().modify({ fd, events });
   };
 
   const update = ({ events }) => {
-    if (events.readable !== lastEvents.readable || events.writable !== lastEvents.writable) {
-
-      if (events.readable || events.writable) {
-        nativePollHandle.start({ events });
-      } else {
-        nativePollHandle.stop();
-      }
-
-      lastEvents = {
-        readable: events.readable,
-        writable: events.writable
-      };
+    if (closed) {
+      throw Error("poll handle already closed");
     }
+
+    if (events.readable === lastReadable && events.writable === lastWritable) {
+      return;
+    }
+
+    const { errno } = applyEvents({ events });
+
+    if (errno !== 0) {
+      throw errors.createErrorFromErrno({
+        operation: "epoll_ctl()",
+        errno
+      });
+    }
+
+    lastReadable = events.readable;
+    lastWritable = events.writable;
   };
 
   const close = () => {
+    if (closed) {
+      throw Error("poll handle already closed");
+    }
+
     closed = true;
-    nativePollHandle.close();
+    callbacksByFd.delete(fd);
+
+    if (isRegistered()) {
+      getDispatcher().remove({ fd });
+    }
   };
 
   return {
@@ -72,5 +183,9 @@ const create = ({ fd, callback }) => {
 };
 
 module.exports = {
-  create
+  create,
+  callAndReportExceptions,
+  callWithEventsAndReportExceptions,
+  READABLE,
+  WRITABLE
 };
@@ -0,0 +1,78 @@
+// FIFO queue on top of a ring buffer
+// push, shift, peek and get are O(1), the buffer doubles when full
+
+const MIN_CAPACITY = 16;
+
+const create = () => {
+
+  let items = new Array(MIN_CAPACITY);
+  let head = 0;
+  let length = 0;
+
+  const slot = (index) => {
+    // capacity is always a power of two
+    return (head + index) & (items.length - 1);
+  };
+
+  const grow = () => {
+    const grown = new Array(items.length * 2);
+    for (let i = 0; i < length; i += 1) {
+      grown[i] = items[slot(i)];
+    }
+
+    items = grown;
+    head = 0;
+  };
+
+  const push = (item) => {
+    if (length === items.length) {
+      grow();
+    }
+
+    items[slot(length)] = item;
+    length += 1;
+  };
+
+  const shift = () => {
+    if (length === 0) {
+      return undefined;
+    }
+
+    const item = items[head];
+
+    // don't keep shifted items alive
+    items[head] = undefined;
+
+    head = slot(1);
+    length -= 1;
+
+    return item;
+  };
+
+  const get = (index) => {
+    if (index < 0 || index >= length) {
+      return undefined;
+    }
+
+    return items[slot(index)];
+  };
+
+  const peek = () => {
+    return get(0);
+  };
+
+  return {
+    push,
+    shift,
+    peek,
+    get,
+
+    get length() {
+      return length;
+    }
+  };
+};
+
+module.exports = {
+  create
+};
@@ -3,6 +3,8 @@ const nodeNetModule = require("node:net");
 
 const sockaddrTranscoder = require("./sockaddr.js");
 const socketDuplexFactory = require("./socket-duplex.js");
+const associationFactory = require("./association.js");
+const oneToManyFactory = require("./one-to-many.js");
 const pollerFactory = require("./poller.js");
 const constants = require("./constants.js");
 const errors = require("./errors.js");
@@ -15,11 +17,40 @@ const {
   initiallyBindLocalAddresses,
   getCurrentLocalPrimaryAddress: socketGetCurrentLocalPrimaryAddress,
   getLocalAddresses: socketGetLocalAddresses,
+  resolveIoBackend,
+  resolvePartialDelivery,
+  resolveNotifications,
 } = require("./socket-common.js");
 
 const DEFAULT_BACKLOG = 128;
 
-const bindAndListen = ({ native, sockfd, localAddresses, port, backlog }) => {
+// must be set before binding, every socket sharing the port needs it
+const maybeApplyReusePort = ({ native, sockfd, reusePort }) => {
+  if (!reusePort) {
+    return { error: undefined };
+  }
+
+  const { errno } = native.setsockopt_reuseport({ fd: sockfd, value: 1 });
+  if (errno !== errnoCodes.NO_ERROR) {
+    return {
+      error: errors.createErrorFromErrno({
+        operation: "setsockopt_reuseport()",
+        errno
+      })
+    };
+  }
+
+  return { error: undefined };
+};
+
+const bindAndListen = ({ native, sockfd, localAddresses, port, backlog, reusePort }) => {
+
+  const { error: reusePortError } = maybeApplyReusePort({ native, sockfd, reusePort });
+  if (reusePortError !== undefined) {
+    return {
+      error: reusePortError
+    };
+  }
 
   let localAddressesToBind = ["0.0.0.0"];
 
@@ -57,32 +88,47 @@ const bindAndListen = ({ native, sockfd, localAddresses, port, backlog }) => {
   return { error: undefined };
 };
 
-const acceptSockaddrBuffer = Buffer.alloc(64);
+// connections accepted per readiness event, the listen socket is polled
+// level triggered, so the rest of the backlog follows in the next round
+const ACCEPT_BATCH_SIZE = 64;
+const SOCKADDR_LENGTH = 64;
+
+const acceptFds = new Int32Array(ACCEPT_BATCH_SIZE);
+const acceptSockaddrs = Buffer.alloc(ACCEPT_BATCH_SIZE * SOCKADDR_LENGTH);
 
-const accept = ({ native, sockfd }) => {
-  const { errno: acceptErrno, fd } = native.accept({
+const acceptBatch = ({ native, sockfd }) => {
+  const { errno, connectionCount } = native.accept_batch({
     fd: sockfd,
-    sockaddr: acceptSockaddrBuffer
+    fds: acceptFds,
+    sockaddrs: acceptSockaddrs,
+    sockaddrLength: SOCKADDR_LENGTH
   });
 
-  if (acceptErrno !== errnoCodes.NO_ERROR) {
+  const connections = [];
+
+  for (let i = 0; i < connectionCount; i += 1) {
+    // parsed right away, the buffers are overwritten by the next batch
+    const sockaddr = acceptSockaddrs.subarray(i * SOCKADDR_LENGTH, (i + 1) * SOCKADDR_LENGTH);
+
+    connections.push({
+      fd: acceptFds[i],
+      initialRemoteAddress: sockaddrTranscoder.parse({ sockaddr })
+    });
+  }
+
+  if (errno !== errnoCodes.NO_ERROR && errno !== errnoCodes.EAGAIN) {
     return {
       error: errors.createErrorFromErrno({
-        operation: "accept()",
-        errno: acceptErrno
-      })
+        operation: "accept4()",
+        errno
+      }),
+      connections
     };
   }
 
-  // copy sockaddr buffer, as it will be overwritten
-  // by future accept calls
-  const sockaddr = Buffer.alloc(acceptSockaddrBuffer.length);
-  sockaddr.set(acceptSockaddrBuffer);
-
   return {
     error: undefined,
-    fd,
-    sockaddr
+    connections
   };
 };
 
@@ -110,15 +156,31 @@ const listenArguments = ({ args }) => {
 const create = ({ native, options: socketOptions }) => {
 
   const emitter = new nodeEventsModule.EventEmitter();
+  const ioBackend = resolveIoBackend({ ioBackend: socketOptions.ioBackend, ioRingSize: socketOptions.ioRingSize });
+  const partialDelivery = resolvePartialDelivery({ partialDelivery: socketOptions.partialDelivery });
+  const { onDemand: onDemandNotifications, addressGatherInterval } = resolveNotifications({
+    notifications: socketOptions.notifications,
+    oneToMany: socketOptions.oneToMany === true
+  });
 
   let errored = false;
   let closed = false;
   let sockfd = undefined;
   let listenPollHandle = undefined;
+  let oneToManyEndpoint = undefined;
 
   const raiseErrorAndClose = ({ error }) => {
+    // the fd needs to leave the shared epoll set before it is closed
     if (listenPollHandle !== undefined) {
-      listenPollHandle.maybeStop();
+      listenPollHandle.close();
+      listenPollHandle = undefined;
+    }
+
+    // closes the fd as well
+    if (oneToManyEndpoint !== undefined) {
+      oneToManyEndpoint.close();
+      oneToManyEndpoint = undefined;
+      sockfd = undefined;
     }
 
     if (sockfd !== undefined) {
@@ -130,6 +192,34 @@ const create = ({ native, options: socketOptions }) => {
     emitter.emit("error", error);
   };
 
+  const createConnection = ({ fd, initialRemoteAddress }) => {
+    if (socketOptions.lean) {
+      return associationFactory.create({
+        fd,
+        connected: true,
+        initialRemoteAddress,
+        ioBackend,
+        highWaterMark: socketOptions.highWaterMark,
+        onDemandNotifications,
+        partialDelivery
+      });
+    }
+
+    return socketDuplexFactory.create({
+      fd,
+      connected: true,
+      initialRemoteAddress,
+      ioBackend,
+      onDemandNotifications,
+      addressGatherInterval,
+      partialDelivery,
+      duplexOptions: {
+        readableHighWaterMark: socketOptions.highWaterMark,
+        writableHighWaterMark: socketOptions.highWaterMark
+      }
+    });
+  };
+
   // eslint-disable-next-line complexity, max-statements
   const listenOptions = ({ options }) => {
     if (typeof options !== "object") {
@@ -179,10 +269,15 @@ const create = ({ native, options: socketOptions }) => {
       throw Error("backlog must be a number");
     }
 
+    if (options.reusePort !== undefined && typeof options.reusePort !== "boolean") {
+      throw Error("reusePort must be a boolean");
+    }
+
     return {
       localAddresses,
       port,
-      backlog
+      backlog,
+      reusePort: options.reusePort === true
     };
   };
 
@@ -193,7 +288,7 @@ const create = ({ native, options: socketOptions }) => {
       throw Error("socket already errored");
     }
 
-    if (listenPollHandle !== undefined) {
+    if (listenPollHandle !== undefined || oneToManyEndpoint !== undefined) {
       throw Error("already listening");
     }
 
@@ -202,11 +297,12 @@ const create = ({ native, options: socketOptions }) => {
     }
 
     const { options, callback } = listenArguments({ args });
-    const { localAddresses, port, backlog } = listenOptions({ options });
+    const { localAddresses, port, backlog, reusePort } = listenOptions({ options });
 
     const { error: socketError, fd: newSockfd } = createSocketWithOptions({
       native,
-      options: socketOptions
+      options: socketOptions,
+      oneToMany: socketOptions.oneToMany === true
     });
 
     if (socketError !== undefined) {
@@ -224,7 +320,8 @@ const create = ({ native, options: socketOptions }) => {
       sockfd,
       localAddresses,
       port,
-      backlog
+      backlog,
+      reusePort
     });
 
     if (bindAndListenError !== undefined) {
@@ -235,33 +332,54 @@ const create = ({ native, options: socketOptions }) => {
       return;
     }
 
+    if (socketOptions.oneToMany) {
+      oneToManyEndpoint = oneToManyFactory.create({
+        fd: sockfd,
+        highWaterMark: socketOptions.highWaterMark,
+        peeloffIoBackend: ioBackend,
+        onDemandNotifications,
+        partialDelivery,
+
+        onAssociation: (association) => {
+          emitter.emit("connection", association);
+        },
+
+        onError: (error) => {
+          // the endpoint closed the fd already
+          oneToManyEndpoint = undefined;
+          sockfd = undefined;
+          raiseErrorAndClose({ error });
+        }
+      });
+
+      callback(null);
+      emitter.emit("listening");
+      return;
+    }
+
     listenPollHandle = pollerFactory.create({
       fd: sockfd,
 
       callback: () => {
 
-        const { error: acceptError, fd: connfd, sockaddr } = accept({
+        const { error: acceptError, connections } = acceptBatch({
           native,
           sockfd
         });
 
-        if (acceptError !== undefined) {
-          raiseErrorAndClose({ error: acceptError });
-          return;
-        }
-
-        const initialRemoteAddress = sockaddrTranscoder.parse({ sockaddr });
+        // all sockets of a batch are set up before any is handed out
+        const sockets = connections.map(({ fd, initialRemoteAddress }) => {
+          return createConnection({ fd, initialRemoteAddress });
+        });
 
-        const socket = socketDuplexFactory.create({
-          fd: connfd,
-          connected: true,
-          initialRemoteAddress,
-          duplexOptions: {
-            readableHighWaterMark: socketOptions.highWaterMark,
-            writableHighWaterMark: socketOptions.highWaterMark
-          }
+        sockets.forEach((socket) => {
+          emitter.emit("connection", socket);
         });
-        emitter.emit("connection", socket);
+
+        // a connection listener might have closed the server meanwhile
+        if (acceptError !== undefined && !closed) {
+          raiseErrorAndClose({ error: acceptError });
+        }
       }
     });
 
@@ -306,6 +424,12 @@ const create = ({ native, options: socketOptions }) => {
       listenPollHandle.close();
     }
 
+    if (oneToManyEndpoint !== undefined) {
+      oneToManyEndpoint.close();
+      oneToManyEndpoint = undefined;
+      sockfd = undefined;
+    }
+
     if (sockfd !== undefined) {
       native.close_fd({ fd: sockfd });
       sockfd = undefined;
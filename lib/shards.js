@@ -0,0 +1,188 @@
+const nodeWorkerThreadsModule = require("node:worker_threads");
+const nodeClusterModule = require("node:cluster");
+
+// runs one listening server per worker thread or cluster process, all on
+// the same addresses and port with SO_REUSEPORT, so the kernel spreads new
+// associations, and with them accept and socket I/O, across cores
+//
+// the primary calls start(), every worker calls listen() with its
+// connection listener, the shard configuration is passed along
+
+const SHARD_ENV_KEY = "LKSCTP_SHARD";
+
+const MODES = ["thread", "cluster"];
+
+const shardMessage = ({ index, type, message }) => {
+  return { lksctpShard: { index, type, message } };
+};
+
+const validateStartOptions = ({ count, mode, listenOptions }) => {
+  if (!Number.isInteger(count) || count < 1) {
+    throw Error("count must be a positive integer");
+  }
+
+  if (!MODES.includes(mode)) {
+    throw Error(`mode must be one of ${MODES.join(", ")}`);
+  }
+
+  // with port 0, every shard would be given a port of its own
+  if (typeof listenOptions !== "object" || !Number.isInteger(listenOptions.port) || listenOptions.port === 0) {
+    throw Error("listenOptions.port must be a fixed port");
+  }
+};
+
+const spawnThread = ({ filename, shard, workerData }) => {
+  const worker = new nodeWorkerThreadsModule.Worker(filename, {
+    workerData: {
+      ...workerData,
+      [SHARD_ENV_KEY]: shard
+    }
+  });
+
+  return {
+    worker,
+    onMessage: (listener) => {
+      worker.on("message", listener);
+    },
+    terminate: () => {
+      return worker.terminate();
+    }
+  };
+};
+
+const spawnProcess = ({ filename, shard }) => {
+  nodeClusterModule.setupPrimary({ exec: filename });
+
+  const worker = nodeClusterModule.fork({
+    [SHARD_ENV_KEY]: JSON.stringify(shard)
+  });
+
+  return {
+    worker,
+    onMessage: (listener) => {
+      worker.on("message", listener);
+    },
+    terminate: () => {
+      worker.kill();
+      return Promise.resolve();
+    }
+  };
+};
+
+// resolves once all shards are listening, rejects if one fails to
+const start = ({
+  filename,
+  count,
+  mode = "thread",
+  serverOptions = {},
+  listenOptions,
+  workerData = {}
+}) => {
+  validateStartOptions({ count, mode, listenOptions });
+
+  const spawn = mode === "thread" ? spawnThread : spawnProcess;
+  const shards = [];
+
+  const listening = new Promise((resolve, reject) => {
+    let listeningCount = 0;
+
+    for (let index = 0; index < count; index += 1) {
+      const shard = spawn({
+        filename,
+        shard: { index, count, serverOptions, listenOptions },
+        workerData
+      });
+
+      shard.onMessage((message) => {
+        const { type, message: errorMessage } = message?.lksctpShard || {};
+
+        if (type === "listening") {
+          listeningCount += 1;
+          if (listeningCount === count) {
+            resolve();
+          }
+        } else if (type === "error") {
+          reject(Error(`shard ${index}: ${errorMessage}`));
+        }
+      });
+
+      shard.worker.once("error", reject);
+      shard.worker.once("exit", (code) => {
+        reject(Error(`shard ${index} exited with code ${code}`));
+      });
+
+      shards.push(shard);
+    }
+  });
+
+  const close = () => {
+    return Promise.all(shards.map((shard) => {
+      return shard.terminate();
+    }));
+  };
+
+  return {
+    workers: shards.map((shard) => {
+      return shard.worker;
+    }),
+    listening,
+    close
+  };
+};
+
+const currentShard = () => {
+  const fromWorkerData = nodeWorkerThreadsModule.workerData?.[SHARD_ENV_KEY];
+  if (fromWorkerData !== undefined) {
+    return {
+      shard: fromWorkerData,
+      report: (message) => {
+        nodeWorkerThreadsModule.parentPort.postMessage(message);
+      }
+    };
+  }
+
+  const fromEnv = process.env[SHARD_ENV_KEY];
+  if (fromEnv !== undefined && nodeClusterModule.isWorker) {
+    return {
+      shard: JSON.parse(fromEnv),
+      report: (message) => {
+        process.send(message);
+      }
+    };
+  }
+
+  return undefined;
+};
+
+// called in a worker started by start(), creates the shard's server
+// and reports back once it listens, returns the server
+const listen = ({ createServer, connectionListener }) => {
+  const current = currentShard();
+  if (current === undefined) {
+    throw Error("not running in a shard started by shards.start()");
+  }
+
+  const { shard, report } = current;
+  const server = createServer(shard.serverOptions, connectionListener);
+
+  server.on("error", (error) => {
+    report(shardMessage({ index: shard.index, type: "error", message: error.message }));
+  });
+
+  server.listen({ ...shard.listenOptions, reusePort: true }, (error) => {
+    if (!error) {
+      report(shardMessage({ index: shard.index, type: "listening" }));
+    }
+  });
+
+  return {
+    server,
+    index: shard.index,
+    count: shard.count
+  };
+};
+
+module.exports = {
+  start,
+  listen
+};
@@ -5,125 +5,278 @@ const constants = require("./constants.js");
 const errors = require("./errors.js");
 const errnoCodes = constants.errno;
 
-const maybeApplySctpSackOptions = ({ native, sockfd, sack }) => {
-  if (sack === undefined) {
-    return { error: undefined };
+const ioPoll = require("./io-poll.js");
+
+const ioBackendsByName = new Map([
+  ["poll", ioPoll],
+  ["thread", require("./io-thread.js")],
+  ["io_uring", require("./io-uring.js")]
+]);
+
+const NOTIFICATION_TYPES = [
+  "SCTP_ASSOC_CHANGE",
+  "SCTP_PEER_ADDR_CHANGE",
+  "SCTP_REMOTE_ERROR",
+  "SCTP_SHUTDOWN_EVENT",
+  "SCTP_PARTIAL_DELIVERY_EVENT",
+  "SCTP_ADAPTATION_INDICATION",
+  "SCTP_AUTHENTICATION_EVENT",
+  "SCTP_SENDER_DRY_EVENT",
+  "SCTP_STREAM_RESET_EVENT",
+  "SCTP_ASSOC_RESET_EVENT",
+  "SCTP_STREAM_CHANGE_EVENT",
+  "SCTP_SEND_FAILED_EVENT"
+].map((name) => {
+  return constants[name];
+});
+
+// connection state follows SCTP_ASSOC_CHANGE, on one-to-many sockets
+// SCTP_SHUTDOWN_EVENT is also needed to end associations
+const mandatoryNotificationTypes = ({ oneToMany }) => {
+  if (oneToMany) {
+    return [constants.SCTP_ASSOC_CHANGE, constants.SCTP_SHUTDOWN_EVENT];
   }
 
-  const { errno: errnoSackInfo } = native.setsockopt_sack_info({
-    fd: sockfd,
-    sack_assoc_id: constants.SCTP_ALL_ASSOC,
-    sack_delay: sack.delay || 0,
-    sack_freq: sack.freq || 0,
-  });
+  return [constants.SCTP_ASSOC_CHANGE];
+};
 
-  if (errnoSackInfo !== errnoCodes.NO_ERROR) {
-    return {
-      error: errors.createErrorFromErrno({
-        operation: "setsockopt()",
-        errno: errnoSackInfo
-      })
-    };
+const parseNotificationType = (type) => {
+  const value = typeof type === "string" ? constants[type] : type;
+
+  if (!NOTIFICATION_TYPES.includes(value)) {
+    throw Error(`unknown notification type ${type}`);
   }
 
-  return { error: undefined };
+  return value;
 };
 
-const maybeApplySctpStreamsOptions = ({ native, sockfd, maximumInputStreams, outputStreams }) => {
-  if (maximumInputStreams === undefined && outputStreams === undefined) {
-    return { error: undefined };
+// connections refresh their addresses this often if they can't rely on
+// SCTP_PEER_ADDR_CHANGE notifications
+const ADDRESS_GATHER_INTERVAL = 5000;
+
+const withAddressGatherInterval = ({ subscribed, onDemand }) => {
+  const notified = subscribed.includes(constants.SCTP_PEER_ADDR_CHANGE);
+
+  return {
+    subscribed,
+    onDemand,
+    addressGatherInterval: notified ? undefined : ADDRESS_GATHER_INTERVAL
+  };
+};
+
+// the notifications option selects which types sockets subscribe to:
+// all of them when not given, the listed ones, or with "auto" those
+// beyond the mandatory ones only while there are "notification" listeners
+const resolveNotifications = ({ notifications, oneToMany = false }) => {
+  const mandatory = mandatoryNotificationTypes({ oneToMany });
+
+  if (notifications === undefined) {
+    return withAddressGatherInterval({ subscribed: NOTIFICATION_TYPES, onDemand: [] });
   }
 
-  const { errno } = native.setsockopt_sctp_initmsg({
-    fd: sockfd,
-    sinit_num_ostreams: outputStreams || 0,
-    sinit_max_instreams: maximumInputStreams || 0,
-    sinit_max_attempts: 0,
-    sinit_max_init_timeo: 0
-  });
+  if (notifications === "auto") {
+    return withAddressGatherInterval({
+      subscribed: mandatory,
+      onDemand: NOTIFICATION_TYPES.filter((type) => {
+        return !mandatory.includes(type);
+      })
+    });
+  }
 
-  return { errno };
+  if (!Array.isArray(notifications)) {
+    throw Error("notifications must be an array of notification types or \"auto\"");
+  }
+
+  const listed = notifications.map(parseNotificationType);
+
+  return withAddressGatherInterval({
+    subscribed: [...new Set([...mandatory, ...listed])],
+    onDemand: []
+  });
 };
 
-const requestRcvinfoStruct = ({ native, sockfd }) => {
-  const { errno } = native.setsockopt_sctp_recvrcvinfo({ fd: sockfd, value: 1 });
-  if (errno !== errnoCodes.NO_ERROR) {
-    const error = errors.createErrorFromErrno({ operation: "setsockopt()", errno });
+const eventRecords = ({ native, types, on, assocId }) => {
+  return types.map((type) => {
+    return { operation: "setsockopt()", values: [native.CONFIGURE_SOCKET_EVENT, type, on ? 1 : 0, assocId] };
+  });
+};
 
-    // we don't expect this error to happen, so we throw it
-    throw error;
+const sackRecords = ({ native, sack }) => {
+  if (sack === undefined) {
+    return [];
   }
+
+  return [{
+    operation: "setsockopt()",
+    values: [native.CONFIGURE_SOCKET_SACK_INFO, constants.SCTP_ALL_ASSOC, sack.delay || 0, sack.freq || 0]
+  }];
 };
 
-const maybeApplyNoDelay = ({ native, sockfd, noDelay }) => {
+const noDelayRecords = ({ native, noDelay }) => {
   if (noDelay === undefined) {
-    return { error: undefined };
+    return [];
   }
 
-  if (typeof noDelay !== "boolean") {
-    throw Error("noDelay must be a boolean");
+  return [{
+    operation: "setsockopt_nodelay()",
+    values: [native.CONFIGURE_SOCKET_NODELAY, noDelay ? 1 : 0]
+  }];
+};
+
+const streamsRecords = ({ native, maximumInputStreams, outputStreams }) => {
+  if (maximumInputStreams === undefined && outputStreams === undefined) {
+    return [];
   }
 
-  const { errno } = native.setsockopt_nodelay({ fd: sockfd, value: noDelay ? 1 : 0 });
-  if (errno !== errnoCodes.NO_ERROR) {
-    return {
-      error: errors.createErrorFromErrno({ operation: "setsockopt_nodelay()", errno })
-    };
+  return [{
+    operation: "setsockopt()",
+    values: [native.CONFIGURE_SOCKET_INITMSG, outputStreams || 0, maximumInputStreams || 0, 0, 0]
+  }];
+};
+
+// messages larger than this are handed to us in pieces, which are joined
+// again unless partialDelivery is "chunks", with fragment interleave level 1
+// a large message of one association doesn't hold back the others
+const DEFAULT_PARTIAL_DELIVERY_POINT = 64 * 1024;
+
+const PARTIAL_DELIVERY_MODES = ["assemble", "chunks"];
+
+const resolvePartialDelivery = ({ partialDelivery = "assemble" }) => {
+  if (!PARTIAL_DELIVERY_MODES.includes(partialDelivery)) {
+    throw Error(`partialDelivery must be one of ${PARTIAL_DELIVERY_MODES.join(", ")}`);
   }
 
-  return { error: undefined };
+  return partialDelivery;
 };
 
-const maybeApplySctpOptions = ({ native, sockfd, options }) => {
-  const { error: sackError } = maybeApplySctpSackOptions({
-    native,
-    sockfd,
-    sack: options.sack
-  });
+const validatePartialDeliveryOptions = ({ partialDelivery, partialDeliveryPoint }) => {
+  resolvePartialDelivery({ partialDelivery });
+
+  if (partialDeliveryPoint === undefined) {
+    return;
+  }
 
-  if (sackError !== undefined) {
-    return { error: sackError };
+  if (!Number.isInteger(partialDeliveryPoint) || partialDeliveryPoint < 1) {
+    throw Error("partialDeliveryPoint must be a positive integer");
   }
+};
+
+const partialDeliveryRecords = ({ native, partialDeliveryPoint = DEFAULT_PARTIAL_DELIVERY_POINT }) => {
+  return [
+    { operation: "setsockopt()", values: [native.CONFIGURE_SOCKET_FRAGMENT_INTERLEAVE, 1] },
+    { operation: "setsockopt()", values: [native.CONFIGURE_SOCKET_PARTIAL_DELIVERY_POINT, partialDeliveryPoint] }
+  ];
+};
+
+// applied in this order, every record knows the operation to report
+// PR-SCTP is offered to every peer, so messages can be sent with a policy
+const socketOptionRecords = ({ native, options, subscribed }) => {
+  return [
+    ...eventRecords({ native, types: subscribed, on: true, assocId: 0 }),
+    ...sackRecords({ native, sack: options.sack }),
+
+    // we don't expect this one to fail, so its error is thrown
+    { operation: "setsockopt()", values: [native.CONFIGURE_SOCKET_RECVRCVINFO, 1], throws: true },
 
-  requestRcvinfoStruct({ native, sockfd });
+    ...noDelayRecords({ native, noDelay: options.noDelay }),
+    ...streamsRecords({ native, maximumInputStreams: options.MIS, outputStreams: options.OS }),
+    ...partialDeliveryRecords({ native, partialDeliveryPoint: options.partialDeliveryPoint }),
+    { operation: "setsockopt()", values: [native.CONFIGURE_SOCKET_PR_SUPPORTED, 1] }
+  ];
+};
 
-  const { error: noDelayError } = maybeApplyNoDelay({ native, sockfd, noDelay: options.noDelay });
-  if (noDelayError !== undefined) {
-    return { error: noDelayError };
+const toDescriptor = ({ native, records }) => {
+  const descriptor = new Uint32Array(records.length * native.CONFIGURE_SOCKET_STRIDE);
+  records.forEach(({ values }, idx) => {
+    descriptor.set(values, idx * native.CONFIGURE_SOCKET_STRIDE);
+  });
+
+  return descriptor;
+};
+
+// sockets are mostly created with a handful of distinct configurations,
+// so the descriptors for configure_socket() of the last few are kept,
+// along with the options they were built from
+const MAX_COMPILED_SOCKET_OPTIONS = 8;
+const compiledSocketOptions = [];
+
+const COMPILED_OPTION_FIELDS = ["hasSack", "sackDelay", "sackFreq", "noDelay", "MIS", "OS", "partialDeliveryPoint"];
+
+const compiledOptionsKey = ({ options, subscribed }) => {
+  const { sack, noDelay, MIS, OS, partialDeliveryPoint } = options;
+
+  return {
+    subscribed,
+    hasSack: sack !== undefined,
+    sackDelay: sack?.delay,
+    sackFreq: sack?.freq,
+    noDelay,
+    MIS,
+    OS,
+    partialDeliveryPoint
+  };
+};
+
+const sameCompiledOptionsKey = (key1, key2) => {
+  const sameFields = COMPILED_OPTION_FIELDS.every((field) => {
+    return key1[field] === key2[field];
+  });
+
+  return sameFields && key1.subscribed.length === key2.subscribed.length && key1.subscribed.every((type, idx) => {
+    return type === key2.subscribed[idx];
+  });
+};
+
+const compileSocketOptions = ({ native, options, oneToMany }) => {
+  if (options.noDelay !== undefined && typeof options.noDelay !== "boolean") {
+    throw Error("noDelay must be a boolean");
   }
 
-  const { error: streamsError } = maybeApplySctpStreamsOptions({
-    native,
-    sockfd,
-    maximumInputStreams: options.MIS,
-    outputStreams: options.OS
+  validatePartialDeliveryOptions(options);
+
+  const { subscribed } = resolveNotifications({ notifications: options.notifications, oneToMany });
+  const key = compiledOptionsKey({ options, subscribed });
+
+  const cached = compiledSocketOptions.find((entry) => {
+    return sameCompiledOptionsKey(entry.key, key);
   });
 
-  if (streamsError !== undefined) {
-    return { error: streamsError };
+  if (cached !== undefined) {
+    return cached.compiled;
   }
 
-  return { error: undefined };
+  const records = socketOptionRecords({ native, options, subscribed });
+  const compiled = { descriptor: toDescriptor({ native, records }), records };
+
+  compiledSocketOptions.push({ key, compiled });
+  if (compiledSocketOptions.length > MAX_COMPILED_SOCKET_OPTIONS) {
+    compiledSocketOptions.shift();
+  }
+
+  return compiled;
 };
 
-const subscribeSctpEvents = ({ native, sockfd, events }) => {
-  for (const event of events) {
-    const { errno: subscribeErrno } = native.setsockopt_sctp_event({ fd: sockfd, se_type: event, se_on: 1 });
-    if (subscribeErrno !== errnoCodes.NO_ERROR) {
-      return {
-        error: errors.createErrorFromErrno({
-          operation: "setsockopt()",
-          errno: subscribeErrno
-        })
-      };
-    }
+// all options are applied with a single call into native code
+const applySocketOptions = ({ native, fd, compiled }) => {
+  const { errno, failedIndex } = native.configure_socket({ fd, options: compiled.descriptor });
+  if (errno === errnoCodes.NO_ERROR) {
+    return { error: undefined };
   }
 
-  return { errno: undefined };
+  const { operation, throws } = compiled.records[failedIndex];
+
+  return {
+    error: errors.createErrorFromErrno({ operation, errno }),
+    throws
+  };
 };
 
-const createSocketWithOptions = ({ native, options }) => {
-  const { errno: errnoSocket, fd } = native.create_socket();
+// only servers may ask for a one-to-many socket
+const createSocketWithOptions = ({ native, options, oneToMany = false }) => {
+  // invalid options throw before there is a socket to clean up
+  const compiled = compileSocketOptions({ native, options, oneToMany });
+
+  const { errno: errnoSocket, fd } = native.create_socket({ oneToMany });
   if (errnoSocket === errnoCodes.EPROTONOSUPPORT) {
     return {
       error: Error(`kernel does not support SCTP sockets`)
@@ -137,30 +290,14 @@ const createSocketWithOptions = ({ native, options }) => {
     };
   }
 
-  const events = [
-    constants.SCTP_ASSOC_CHANGE,
-    constants.SCTP_PEER_ADDR_CHANGE,
-    constants.SCTP_REMOTE_ERROR,
-    constants.SCTP_SHUTDOWN_EVENT,
-    constants.SCTP_PARTIAL_DELIVERY_EVENT,
-    constants.SCTP_ADAPTATION_INDICATION,
-    constants.SCTP_AUTHENTICATION_EVENT,
-    constants.SCTP_SENDER_DRY_EVENT,
-    constants.SCTP_STREAM_RESET_EVENT,
-    constants.SCTP_ASSOC_RESET_EVENT,
-    constants.SCTP_STREAM_CHANGE_EVENT,
-    constants.SCTP_SEND_FAILED_EVENT
-  ];
-
-  const { error: errorSubscribe } = subscribeSctpEvents({ native, sockfd: fd, events });
-  if (errorSubscribe) {
-    native.close_fd({ fd });
-    return { error: errorSubscribe };
-  }
-
-  const { error: errorOptions } = maybeApplySctpOptions({ native, sockfd: fd, options });
+  const { error: errorOptions, throws } = applySocketOptions({ native, fd, compiled });
   if (errorOptions) {
     native.close_fd({ fd });
+
+    if (throws) {
+      throw errorOptions;
+    }
+
     return { error: errorOptions };
   }
 
@@ -170,6 +307,36 @@ const createSocketWithOptions = ({ native, options }) => {
   };
 };
 
+// subscribes to the given notification types while the emitter has
+// "notification" listeners, so nobody pays for notifications nobody reads
+const subscribeNotificationsOnDemand = ({ native, emitter, fd, assocId = 0, types, isOpen }) => {
+  if (types.length === 0) {
+    return;
+  }
+
+  const subscribe = toDescriptor({ native, records: eventRecords({ native, types, on: true, assocId }) });
+  const unsubscribe = toDescriptor({ native, records: eventRecords({ native, types, on: false, assocId }) });
+
+  const apply = ({ descriptor }) => {
+    const { errno } = native.configure_socket({ fd, options: descriptor });
+    if (errno !== errnoCodes.NO_ERROR) {
+      throw errors.createErrorFromErrno({ operation: "setsockopt()", errno });
+    }
+  };
+
+  emitter.on("newListener", (event) => {
+    if (event === "notification" && emitter.listenerCount("notification") === 0 && isOpen()) {
+      apply({ descriptor: subscribe });
+    }
+  });
+
+  emitter.on("removeListener", (event) => {
+    if (event === "notification" && emitter.listenerCount("notification") === 0 && isOpen()) {
+      apply({ descriptor: unsubscribe });
+    }
+  });
+};
+
 const determineAddressFamily = ({ address }) => {
   if (nodeNetModule.isIPv4(address)) {
     return "IPv4";
@@ -217,8 +384,8 @@ const getCurrentRemotePrimaryAddress = ({ native, fd }) => {
   return sockaddrTranscoder.parse({ sockaddr: sockaddrBuffer });
 };
 
-const getRemoteAddresses = ({ native, fd }) => {
-  const { errno, sockaddrs } = native.sctp_getpaddrs({ fd });
+const getRemoteAddresses = ({ native, fd, assocId = 0 }) => {
+  const { errno, sockaddrs } = native.sctp_getpaddrs({ fd, assocId });
   if (errno === errnoCodes.ENOTCONN || errno === errnoCodes.EINVAL) {
     return undefined;
   } else if (errno !== errnoCodes.NO_ERROR) {
@@ -285,35 +452,246 @@ const initiallyBindLocalAddresses = ({ native, fd, localAddresses, localPort })
   return bindx({ native, fd, localAddresses, localPort, flags: constants.SCTP_BINDX_ADD_ADDR });
 };
 
-const retrievePeerAddressInfo = ({ native, fd, peerAddress, remotePort }) => {
-  const sockaddr = sockaddrTranscoder.format({
-    family: determineAddressFamily({ address: peerAddress }),
-    address: peerAddress,
-    port: remotePort
+// addresses (and path info) of an association in one native call
+const snapshotAssociation = ({ native, fd, assocId = 0, withLocal, withPeerInfo }) => {
+  const snapshot = native.snapshot_association({ fd, assocId, withLocal, withPeerInfo });
+  if (snapshot.errno !== errnoCodes.NO_ERROR) {
+    throw errors.createErrorFromErrno({ operation: snapshot.operation, errno: snapshot.errno });
+  }
+
+  return snapshot;
+};
+
+// libuv gives an error on poll, strangely EBADF,
+// the actual error needs to be fetched from the socket
+const errorFromPollErrno = ({ native, fd, pollErrno }) => {
+  const result = native.get_socket_error({ fd });
+  if (result.errno !== errnoCodes.NO_ERROR) {
+    return errors.createErrorFromErrno({
+      operation: "get_socket_error()",
+      errno: result.errno
+    });
+  }
+
+  if (result.socketError === errnoCodes.NO_ERROR) {
+    return errors.createErrorFromErrno({
+      operation: "poll()",
+      errno: pollErrno
+    });
+  }
+
+  const wellKnownErrors = [
+    errnoCodes.ECONNREFUSED,
+    errnoCodes.ECONNRESET,
+    errnoCodes.ETIMEDOUT,
+  ];
+
+  if (wellKnownErrors.includes(result.socketError)) {
+    // in case of well known errors, we don't show operation in error message
+    return errors.createErrorFromErrno({ errno: result.socketError });
+  }
+
+  return errors.createErrorFromErrno({
+    operation: "poll()",
+    errno: result.socketError
   });
+};
+
+// send options of a message, at most one PR-SCTP policy with its value
+const PR_POLICIES = [
+  { name: "ttl", policy: constants.SCTP_PR_SCTP_TTL },
+  { name: "maxRetransmissions", policy: constants.SCTP_PR_SCTP_RTX },
+  { name: "priority", policy: constants.SCTP_PR_SCTP_PRIO }
+];
+
+const SEND_OPTION_NAMES = ["unordered", ...PR_POLICIES.map(({ name }) => {
+  return name;
+})];
+
+const prPolicyOf = ({ name, policy }, options) => {
+  const value = options[name];
+  if (value === undefined) {
+    return 0;
+  }
+
+  if (!Number.isInteger(value) || value < 0 || value > 0xffffffff) {
+    throw Error(`${name} must be an integer from 0 to 4294967295`);
+  }
+
+  return policy;
+};
+
+// snd_flags of a message, with the PR-SCTP policy in the SCTP_PR_SCTP_MASK
+// bits like sinfo_flags, its value comes from prValueOf(), options are
+// e.g. the attributes of a duplex chunk, so nothing is allocated
+const sendFlagsOf = (options) => {
+  let policies = 0;
+  let flags = options.unordered === true ? constants.SCTP_UNORDERED : 0;
+
+  for (let i = 0; i < PR_POLICIES.length; i += 1) {
+    const policy = prPolicyOf(PR_POLICIES[i], options);
+
+    policies += policy === 0 ? 0 : 1;
+    flags |= policy;
+  }
+
+  if (policies > 1) {
+    throw Error("only one of ttl, maxRetransmissions and priority can be set");
+  }
+
+  return flags;
+};
+
+const prValueOf = (options) => {
+  return options.ttl || options.maxRetransmissions || options.priority || 0;
+};
+
+// the reverse, e.g. for messages moved to a peeled off association
+const sendOptionsOf = ({ flags, prValue }) => {
+  const options = { unordered: (flags & constants.SCTP_UNORDERED) !== 0 };
+  const entry = PR_POLICIES.find(({ policy }) => {
+    return policy === (flags & constants.SCTP_PR_SCTP_MASK);
+  });
+
+  if (entry !== undefined) {
+    options[entry.name] = prValue;
+  }
+
+  return options;
+};
+
+const copySendOptions = ({ from, to }) => {
+  SEND_OPTION_NAMES.forEach((name) => {
+    if (from[name] !== undefined) {
+      to[name] = from[name];
+    }
+  });
+
+  return to;
+};
+
+// messages abandoned under PR-SCTP policies, of one stream or, with sid
+// -1, of all
+const getAbandonedMessages = ({ native, fd, assocId = 0, sid = -1 }) => {
+  if (!Number.isInteger(sid) || sid < -1 || sid > 0xffff) {
+    throw Error("sid must be an integer from 0 to 65535");
+  }
+
+  const { errno, abandonedUnsent, abandonedSent } = native.getsockopt_pr_status({ fd, assocId, sid });
 
-  const { errno, info } = native.getsockopt_peer_addr_info({ fd, sockaddr });
   if (errno !== errnoCodes.NO_ERROR) {
-    // in order to avoid glitches, we don't throw an error here
-    return undefined;
+    throw errors.createErrorFromErrno({ operation: "getsockopt_pr_status()", errno });
   }
 
   return {
-    state: Number(info.spinfo_state),
-    cwnd: Number(info.spinfo_cwnd),
-    srtt: Number(info.spinfo_srtt),
-    rto: Number(info.spinfo_rto),
-    mtu: Number(info.spinfo_mtu)
+    unsent: abandonedUnsent,
+    sent: abandonedSent
   };
 };
 
+const getAssociationStatus = ({ native, fd }) => {
+  const { errno, info } = native.getsockopt_sctp_status({ fd });
+
+  if (errno !== errnoCodes.NO_ERROR) {
+    throw errors.createErrorFromErrno({
+      operation: "getsockopt_sctp_status()",
+      errno
+    });
+  }
+
+  const tag = info.sctpi_tag;
+  const state = info.sctpi_state;
+  const rwnd = info.sctpi_rwnd;
+  const unackdata = info.sctpi_unackdata;
+  const penddata = info.sctpi_penddata;
+  const numberOfIncomingStreams = info.sctpi_instrms;
+  const numberOfOutgoingStreams = info.sctpi_outstrms;
+  const fragmentationPoint = info.sctpi_fragmentation_point;
+  const incomingQueue = info.sctpi_inqueue;
+  const outgoingQueue = info.sctpi_outqueue;
+  const overallError = info.sctpi_overall_error;
+  const maxBurst = info.sctpi_max_burst;
+  const maxSeg = info.sctpi_maxseg;
+
+  const peer = {
+    tag: info.sctpi_peer_tag,
+    rwnd: info.sctpi_peer_rwnd,
+    cap: info.sctpi_peer_capable,
+    sack: info.sctpi_peer_sack
+  };
+
+  return {
+    tag,
+    state,
+    rwnd,
+    unackdata,
+    penddata,
+    numberOfIncomingStreams,
+    numberOfOutgoingStreams,
+    fragmentationPoint,
+    incomingQueue,
+    outgoingQueue,
+    overallError,
+    maxBurst,
+    maxSeg,
+
+    peer
+  };
+};
+
+const setNoDelay = ({ native, fd, noDelay }) => {
+  if (typeof noDelay !== "boolean") {
+    throw Error("noDelay must be a boolean");
+  }
+
+  const { errno } = native.setsockopt_nodelay({ fd, value: noDelay ? 1 : 0 });
+  if (errno !== errnoCodes.NO_ERROR) {
+    throw errors.createErrorFromErrno({
+      operation: "setsockopt_nodelay()",
+      errno
+    });
+  }
+};
+
+// ioRingSize only applies to the ring based backends, "thread" and "io_uring"
+const resolveIoBackend = ({ ioBackend = "poll", ioRingSize }) => {
+  const backend = ioBackendsByName.get(ioBackend);
+
+  if (backend === undefined) {
+    throw Error(`ioBackend must be one of ${[...ioBackendsByName.keys()].join(", ")}`);
+  }
+
+  // e.g. io_uring on kernels without it, or where it is disabled
+  if (backend.isAvailable !== undefined && !backend.isAvailable()) {
+    return ioPoll;
+  }
+
+  if (ioRingSize !== undefined && backend.withRingSize !== undefined) {
+    return backend.withRingSize({ ringSize: ioRingSize });
+  }
+
+  return backend;
+};
+
 module.exports = {
   createSocketWithOptions,
+  resolveNotifications,
+  subscribeNotificationsOnDemand,
+  resolveIoBackend,
+  resolvePartialDelivery,
+  sendFlagsOf,
+  prValueOf,
+  sendOptionsOf,
+  copySendOptions,
+  getAbandonedMessages,
+  errorFromPollErrno,
+  getAssociationStatus,
+  setNoDelay,
   determineAddressFamily,
   getCurrentLocalPrimaryAddress,
   getLocalAddresses,
   getCurrentRemotePrimaryAddress,
   getRemoteAddresses,
   initiallyBindLocalAddresses,
-  retrievePeerAddressInfo
+  snapshotAssociation
 };
@@ -0,0 +1,92 @@
+const native = require("./native.js");
+const { READABLE, WRITABLE } = require("./poller.js");
+const microtaskSchedulerFactory = require("./microtask-scheduler.js");
+const socketCommon = require("./socket-common.js");
+
+// the loop the duplex, the lean association and the one-to-many endpoint
+// share: io backend callbacks only note what the socket may be ready for,
+// the work is done in a microtask, where step() receives or sends a batch
+// and returns whether it did anything, once it didn't idle() is called to
+// update the poll events
+//
+// socketMaybeHasMore and socketMaybeTakesMore are cleared by the caller
+// once a receive or send would block
+const create = ({
+  fd,
+  ioBackend,
+  socketMaybeTakesMore = false,
+  isDone,
+  step,
+  idle,
+  onError
+}) => {
+
+  const driver = {
+    socketMaybeHasMore: false,
+    socketMaybeTakesMore
+  };
+
+  let pollErrno = undefined;
+  let pollCallbacksSinceLastMicrotask = 0;
+
+  const next = () => {
+    if (isDone()) {
+      return;
+    }
+
+    pollCallbacksSinceLastMicrotask = 0;
+
+    if (pollErrno !== undefined) {
+      onError(socketCommon.errorFromPollErrno({ native, fd, pollErrno }));
+      return;
+    }
+
+    if (step()) {
+      nextTask.schedule();
+      return;
+    }
+
+    idle();
+  };
+
+  const nextTask = microtaskSchedulerFactory.shared.createTask(next);
+
+  const handle = ioBackend.create({
+    fd,
+
+    callback: (status, events) => {
+
+      pollCallbacksSinceLastMicrotask += 1;
+
+      if (pollCallbacksSinceLastMicrotask > 1) {
+        // something went wrong, we need to make sure we won't get stuck
+        // in a poll loop
+        handle.update({
+          events: {
+            readable: false,
+            writable: false
+          }
+        });
+        return;
+      }
+
+      if (status !== 0) {
+        pollErrno = -status;
+      }
+
+      driver.socketMaybeHasMore = driver.socketMaybeHasMore || (events & READABLE) !== 0;
+      driver.socketMaybeTakesMore = driver.socketMaybeTakesMore || (events & WRITABLE) !== 0;
+
+      nextTask.schedule();
+    }
+  });
+
+  driver.handle = handle;
+  driver.schedule = nextTask.schedule;
+
+  return driver;
+};
+
+module.exports = {
+  create
+};
@@ -4,21 +4,32 @@
 
 const native = require("./native.js");
 const nodeStreamModule = require("node:stream");
-const assert = require("node:assert");
 
-const pollerFactory = require("./poller.js");
+const ioPoll = require("./io-poll.js");
 const constants = require("./constants.js");
 const errors = require("./errors.js");
-const microtaskSchedulerFactory = require("./microtask-scheduler.js");
+const queueFactory = require("./queue.js");
 const socketCommon = require("./socket-common.js");
+const socketDriver = require("./socket-driver.js");
 const notifications = require("./notifications.js");
+const statsModule = require("./stats.js");
+const messageAssembler = require("./message-assembler.js");
+const timerWheel = require("./timer-wheel.js");
 
 const errnoCodes = constants.errno;
 
-const MAX_REASONABLE_PACKET_SIZE = 128 * 1024;
+const MAX_MESSAGES_PER_SEND = 64;
+
+// bytes a stalled stream channel takes before the socket isn't read anymore
+const DEFAULT_STREAM_BUFFER_LIMIT = 1024 * 1024;
+
+// per message send info, only used synchronously,
+// so all sockets of this thread share it
+const sendInfo = new Uint32Array(MAX_MESSAGES_PER_SEND * native.SENDV_BATCH_INFO_STRIDE);
 
 const parseMessageFlags = ({ flags }) => {
-  let remainingFlags = flags;
+  // only seen by the message assembler
+  let remainingFlags = flags & ~constants.RECEIVE_FLAG_CONTINUED;
 
   const MSG_EOR_OR_ZERO = remainingFlags & constants.MSG_EOR;
   remainingFlags &= ~constants.MSG_EOR;
@@ -36,6 +47,16 @@ const parseMessageFlags = ({ flags }) => {
   };
 };
 
+// unordered and PR-SCTP attributes of a chunk, invalid ones fail the write
+const sendOptionsError = (chunk) => {
+  try {
+    socketCommon.sendFlagsOf(chunk);
+    return undefined;
+  } catch (error) {
+    return error;
+  }
+};
+
 const warnWithStackTrace = ({ message }) => {
   console.warn(message);
   console.trace();
@@ -59,348 +80,398 @@ const assertNoReentrancy = (fn) => {
   };
 };
 
+// messages are often views into larger buffers, e.g. the receive slab,
+// posting a view to another thread would clone all of its buffer
+const copyForTransfer = (data) => {
+  return Buffer.from(data);
+};
+
 const create = ({
   fd: providedFd,
   connected: initiallyConnected,
   initialRemoteAddress,
-  maxPacketSize = MAX_REASONABLE_PACKET_SIZE,
-  maxOperationsPerMacrotask = 500,
-  addressGatherInterval = 5000,
+  maxMessagesPerReceive = 64,
+  maxBytesPerReceive = 256 * 1024,
+  addressGatherInterval = undefined,
+  ioBackend = ioPoll,
+  onDemandNotifications = [],
+  partialDelivery = "assemble",
   duplexOptions
 }) => {
 
-  // max packet size depends on PMTU
-  const receiveBuffer = Buffer.alloc(maxPacketSize);
   let readRequested = false;
   let mayPushData = false;
   let remoteEnded = false;
   const fd = providedFd;
 
   let destroyed = false;
-  let pollErrno = undefined;
-
-  let socketMaybeHasMore = false;
-  let socketMaybeTakesMore = false;
+  let detached = false;
 
   let shutdownRequested = false;
 
-  let scheduledNextMicrotask = undefined;
-  let pollCallbacksSinceLastMicrotask = 0;
-  const microtaskScheduler = microtaskSchedulerFactory.create({ maxMicrotasksPerMacrotask: maxOperationsPerMacrotask });
-
   let connected = initiallyConnected;
 
-  let sendQueue = [];
+  const sendQueue = queueFactory.create();
 
-  const raiseErrorAndClose = ({ error }) => {
-    duplex.destroy(error);
+  // empty buffer -> parts, writeMessage() passes the former through the
+  // writable stream, write() and writev() queue the latter in its place
+  const carriedMessages = new WeakMap();
+
+  // byte length of carried messages not sent yet, the writable stream
+  // only knows the length of their empty buffers
+  let carriedBytes = 0;
+  let carriedBytesNeedDrain = false;
+
+  const messageOf = (chunk) => {
+    return carriedMessages.get(chunk) || chunk;
   };
 
-  const receiveSockaddrBuffer = Buffer.alloc(64);
+  // pieces of a message too large to be delivered at once
+  const assembler = messageAssembler.create({ partialDelivery });
 
-  const tryReceiveNext = () => {
-    if (connected && !mayPushData && !shutdownRequested) {
-      return { handeled: false };
-    }
+  // stream id -> { channel, ppid, bufferLimit, wantsData }, see duplex.stream()
+  const channels = new Map();
 
-    if (remoteEnded) {
-      return { handeled: false };
-    }
+  // final() of the duplex, deferred while writes of channels are queued
+  let pendingFinal = undefined;
 
-    if (!socketMaybeHasMore) {
-      return { handeled: false };
-    }
+  const raiseErrorAndClose = ({ error }) => {
+    duplex.destroy(error);
+  };
 
-    const buffer = receiveBuffer;
+  const handleReceivedNotification = ({ rawNotification }) => {
+    const type = notifications.decode({ notification: rawNotification });
 
-    const result = native.sctp_recvv({
-      fd,
-      messageBuffer: receiveBuffer,
-      sockaddr: receiveSockaddrBuffer
-    });
+    if (!connected) {
+      if (type === constants.SCTP_ASSOC_CHANGE) {
+        connected = true;
 
-    if (result.errno !== errnoCodes.NO_ERROR) {
-      if (result.errno === errnoCodes.EAGAIN) {
-        socketMaybeHasMore = false;
-        return { handeled: false };
-      }
+        updateDuplexProperties();
+        updateAddressProperties();
 
-      if (result.errno === errnoCodes.ECONNRESET) {
+        duplex.emit("connect");
+      } else {
         raiseErrorAndClose({
-          error: errors.createErrorFromErrno({ errno: result.errno })
+          error: Error("first notification must be SCTP_ASSOC_CHANGE")
         });
-        return { handeled: true };
+        return { proceed: false };
       }
-
-      raiseErrorAndClose({
-        error: errors.createErrorFromErrno({
-          operation: "sctp_recvmsg()",
-          errno: result.errno
-        })
-      });
-      return { handeled: true };
+    } else if (type === constants.SCTP_PEER_ADDR_CHANGE || type === constants.SCTP_ASSOC_CHANGE) {
+      // addresses only change along with these, e.g. on a restart
+      updateAddressProperties();
     }
 
+    notifications.emit({ emitter: duplex, notification: rawNotification });
+
+    return { proceed: true };
+  };
+
+  const handleReceivedMessage = ({ piece, flags, hasRcvinfo, sid, ppid }) => {
     const {
       MSG_EOR,
       MSG_NOTIFICATION,
       ...unknownFlags
-    } = parseMessageFlags({ flags: result.flags });
-
-    if (MSG_NOTIFICATION) {
-      const rawNotification = Buffer.from(Uint8Array.prototype.slice.call(buffer, 0, result.bytesReceived));
-      const parsedNotification = native.parse_sctp_notification({ notification: rawNotification });
-      const interpreted = notifications.interpret({ notification: parsedNotification });
+    } = parseMessageFlags({ flags });
 
-      if (!connected) {
-        if (parsedNotification.sn_type === constants.SCTP_ASSOC_CHANGE) {
-          connected = true;
-
-          updateDuplexProperties();
-          updateAddressProperties();
-
-          duplex.emit("connect");
-        } else {
-          raiseErrorAndClose({
-            error: Error("first notification must be SCTP_ASSOC_CHANGE")
-          });
-          return { handeled: true };
-        }
-      }
-
-      if (parsedNotification.sn_type === constants.SCTP_PEER_ADDR_CHANGE) {
-        // if we receive a peer address change, we update the remote addresses immediately
-        updateAddressProperties();
-      }
-
-      duplex.emit("notification", {
-        raw: rawNotification,
-        parsed: parsedNotification,
-        interpreted
-      });
+    const message = assembler.receive({ piece, flags });
+    if (message === undefined) {
+      return { proceed: true };
+    }
 
-      return { handeled: true };
+    if (MSG_NOTIFICATION) {
+      return handleReceivedNotification({ rawNotification: message });
     }
 
     if (!connected) {
       raiseErrorAndClose({
         error: Error("first message must be a notification")
       });
-      return { handeled: true };
+      return { proceed: false };
     }
 
-    if (result.bytesReceived === 0) {
+    if (message.length === 0) {
       remoteEnded = true;
       pushAndResetReadRequested({ data: null });
-      return { handeled: true };
-    }
-
-    if (!MSG_EOR) {
-      throw Error("missing MSG_EOR, receive buffer probably too small, not implemented");
+      channels.forEach(({ channel }) => {
+        channel.push(null);
+      });
+      return { proceed: false };
     }
 
     if (Object.keys(unknownFlags).length > 0) {
       throw Error(`unknown flags: ${Object.keys(unknownFlags).join(", ")}`);
     }
 
-    if (result.rcvinfo === undefined) {
+    if (!hasRcvinfo) {
       throw Error("missing rcvinfo, should not happen");
     }
 
-    // make sure to copy bytes
-    const chunk = Buffer.from(Uint8Array.prototype.slice.call(buffer, 0, result.bytesReceived));
+    message.sid = sid;
+    message.ppid = ppid;
 
-    chunk.sid = Number(result.rcvinfo.sid);
-    chunk.ppid = Number(result.rcvinfo.ppid);
+    if (!MSG_EOR) {
+      // more chunks of this message follow, the last one is not marked
+      message.partial = true;
+    }
+
+    const channelRecord = channels.get(sid);
+    if (channelRecord !== undefined) {
+      channelRecord.wantsData = channelRecord.channel.push(message);
+      return { proceed: true };
+    }
 
-    const takesMore = pushAndResetReadRequested({ data: chunk });
+    const takesMore = pushAndResetReadRequested({ data: message });
 
     mayPushData = takesMore;
 
-    return { handeled: true };
+    return { proceed: true };
   };
 
-  const trySendNext = () => {
-    if (sendQueue.length === 0) {
-      return { handeled: false };
+  const handleReceiveErrno = ({ errno, messagesReceived }) => {
+    if (errno === errnoCodes.NO_ERROR) {
+      // budget used up, socket may still have more
+      return { handeled: messagesReceived > 0 };
     }
 
-    if (remoteEnded) {
-      const next = sendQueue[0];
-      const { callback } = next;
-      sendQueue = sendQueue.slice(1);
-
-      callback(Error("remote ended"));
+    if (errno === errnoCodes.EAGAIN) {
+      driver.socketMaybeHasMore = false;
+      return { handeled: messagesReceived > 0 };
+    }
 
+    if (errno === errnoCodes.ECONNRESET) {
+      raiseErrorAndClose({
+        error: errors.createErrorFromErrno({ errno })
+      });
       return { handeled: true };
     }
 
-    if (!socketMaybeTakesMore) {
+    raiseErrorAndClose({
+      error: errors.createErrorFromErrno({
+        operation: "sctp_recvmsg()",
+        errno
+      })
+    });
+    return { handeled: true };
+  };
+
+  // with stream channels, the socket is read while any of them or the duplex
+  // asked for data, and none of them holds more than its buffer limit, so a
+  // stalled stream doesn't hold back the others until then
+  const channelDemand = () => {
+    let wanted = false;
+
+    if (channels.size > 0 && duplex.readableLength >= DEFAULT_STREAM_BUFFER_LIMIT) {
+      return { wanted, blocked: true };
+    }
+
+    for (const { channel, bufferLimit, wantsData } of channels.values()) {
+      if (channel.readableLength >= bufferLimit) {
+        return { wanted, blocked: true };
+      }
+
+      wanted = wanted || wantsData;
+    }
+
+    return { wanted, blocked: false };
+  };
+
+  const tryReceiveNext = () => {
+    const { wanted: channelsWantData, blocked } = channelDemand();
+
+    if (connected && (blocked || !mayPushData && !channelsWantData) && !shutdownRequested) {
       return { handeled: false };
     }
 
-    const next = sendQueue[0];
+    if (remoteEnded) {
+      return { handeled: false };
+    }
 
-    const { messageToSend, callback } = next;
+    if (!driver.socketMaybeHasMore) {
+      return { handeled: false };
+    }
 
-    const result = native.sctp_sendv({
-      fd,
-      ...messageToSend
+    const { errno, messages, info } = ioHandle.receiveBatch({
+      maxMessages: maxMessagesPerReceive,
+      maxBytes: maxBytesPerReceive
     });
 
-    if (result.errno !== errnoCodes.NO_ERROR) {
-      if (result.errno === errnoCodes.EAGAIN) {
-        socketMaybeTakesMore = false;
-        return { handeled: false };
+    // the whole batch is pushed in this turn, the readable side
+    // buffers whatever exceeds its high water mark
+    for (let i = 0; i < messages.length; i += 1) {
+      const offset = i * native.RECVV_BATCH_INFO_STRIDE;
+
+      // messages are views into a shared receive slab, wrapping
+      // them does not copy any bytes
+      const view = messages[i];
+      const piece = Buffer.from(view.buffer, view.byteOffset, view.byteLength);
+
+      const { proceed } = handleReceivedMessage({
+        piece,
+        flags: info[offset],
+        hasRcvinfo: info[offset + 1] !== 0,
+        sid: info[offset + 2],
+        ppid: info[offset + 3]
+      });
+
+      if (!proceed || destroyed) {
+        return { handeled: true };
       }
+    }
 
-      if (result.errno === errnoCodes.ECONNRESET) {
-        raiseErrorAndClose({
-          error: errors.createErrorFromErrno({ errno: result.errno })
-        });
+    return handleReceiveErrno({ errno, messagesReceived: messages.length });
+  };
 
-        return { handeled: true };
+  const gatherMessagesToSend = () => {
+    const messages = [];
+
+    for (let entryIndex = 0; entryIndex < sendQueue.length; entryIndex += 1) {
+      const entry = sendQueue.get(entryIndex);
+      for (let i = entry.sent; i < entry.chunks.length; i += 1) {
+        if (messages.length >= MAX_MESSAGES_PER_SEND) {
+          return messages;
+        }
+
+        const chunk = entry.chunks[i];
+        const offset = messages.length * native.SENDV_BATCH_INFO_STRIDE;
+
+        // writes of stream channels carry their sid and default ppid
+        sendInfo[offset] = entry.sid === undefined ? chunk.sid || 0 : entry.sid;
+        sendInfo[offset + 1] = chunk.ppid || entry.ppid || 0;
+        sendInfo[offset + 2] = socketCommon.sendFlagsOf(chunk);
+        sendInfo[offset + 3] = 0;
+        sendInfo[offset + 5] = socketCommon.prValueOf(chunk);
+
+        messages.push(chunk);
       }
+    }
 
-      if (result.errno === errnoCodes.EPIPE) {
-        raiseErrorAndClose({
-          error: errors.createErrorFromErrno({ errno: result.errno })
-        });
+    return messages;
+  };
 
-        return { handeled: true };
+  const completeSentMessages = ({ messagesSent }) => {
+    let remaining = messagesSent;
+    const callbacks = [];
+
+    while (remaining > 0) {
+      const entry = sendQueue.peek();
+      const taken = Math.min(remaining, entry.chunks.length - entry.sent);
+
+      entry.sent += taken;
+      remaining -= taken;
+
+      if (entry.sent === entry.chunks.length) {
+        sendQueue.shift();
+        callbacks.push(entry.callback);
       }
+    }
+
+    // call back after the queue is consistent, callbacks may write again
+    callbacks.forEach((callback) => {
+      callback();
+    });
+  };
 
+  const handleSendErrno = ({ errno, messagesSent }) => {
+    if (errno === errnoCodes.NO_ERROR) {
+      return { handeled: messagesSent > 0 };
+    }
+
+    if (errno === errnoCodes.EAGAIN) {
+      driver.socketMaybeTakesMore = false;
+      return { handeled: messagesSent > 0 };
+    }
+
+    if (errno === errnoCodes.ECONNRESET || errno === errnoCodes.EPIPE) {
       raiseErrorAndClose({
-        error: errors.createErrorFromErrno({
-          operation: "sctp_sendv()",
-          errno: result.errno
-        })
+        error: errors.createErrorFromErrno({ errno })
       });
+
       return { handeled: true };
     }
 
-    sendQueue = sendQueue.slice(1);
-    callback();
-
+    raiseErrorAndClose({
+      error: errors.createErrorFromErrno({
+        operation: "sctp_sendv()",
+        errno
+      })
+    });
     return { handeled: true };
   };
 
-  const next = assertNoReentrancy(() => {
-    if (destroyed) {
-      return;
+  const trySendNext = () => {
+    if (sendQueue.length === 0) {
+      if (pendingFinal !== undefined) {
+        const callback = pendingFinal;
+        pendingFinal = undefined;
+        shutdownAndCallBack(callback);
+        return { handeled: true };
+      }
+
+      return { handeled: false };
     }
 
-    pollCallbacksSinceLastMicrotask = 0;
-    scheduledNextMicrotask = undefined;
+    if (remoteEnded) {
+      const { callback } = sendQueue.shift();
 
-    if (pollErrno !== undefined) {
-      // libuv gives an error on poll, strangely EBADF
-      // we need to check for a socket error
+      callback(Error("remote ended"));
 
-      const result = native.get_socket_error({ fd });
-      if (result.errno !== errnoCodes.NO_ERROR) {
-        raiseErrorAndClose({
-          error: errors.createErrorFromErrno({
-            operation: "get_socket_error()",
-            errno: result.errno
-          })
-        });
-        return;
-      }
+      return { handeled: true };
+    }
 
-      if (result.socketError !== errnoCodes.NO_ERROR) {
+    if (!driver.socketMaybeTakesMore) {
+      return { handeled: false };
+    }
 
-        const wellKnownErrors = [
-          errnoCodes.ECONNREFUSED,
-          errnoCodes.ECONNRESET,
-          errnoCodes.ETIMEDOUT,
-        ];
+    // everything queued is handed to the kernel in one call,
+    // up to the per call message budget
+    const messages = gatherMessagesToSend();
 
-        if (wellKnownErrors.includes(result.socketError)) {
-          // in case of well known errors, we don't show operation in error message
-          raiseErrorAndClose({
-            error: errors.createErrorFromErrno({ errno: result.socketError })
-          });
-          return;
-        }
+    const { errno, messagesSent } = ioHandle.sendBatch({
+      messages,
+      info: sendInfo
+    });
 
-        raiseErrorAndClose({
-          error: errors.createErrorFromErrno({
-            operation: "poll()",
-            errno: result.socketError
-          })
-        });
-        return;
-      }
+    completeSentMessages({ messagesSent });
 
-      raiseErrorAndClose({
-        error: errors.createErrorFromErrno({
-          operation: "poll()",
-          errno: pollErrno
-        })
-      });
-      return;
+    if (destroyed) {
+      return { handeled: true };
     }
 
+    return handleSendErrno({ errno, messagesSent });
+  };
+
+  const step = assertNoReentrancy(() => {
     const { handeled: receiveHandled } = tryReceiveNext();
     if (receiveHandled) {
-      maybeScheduleNextMicrotask();
-      return;
+      return true;
     }
 
     const { handeled: sendHandled } = trySendNext();
-    if (sendHandled) {
-      maybeScheduleNextMicrotask();
-      return;
-    }
-
-    updatePollEvents();
+    return sendHandled;
   });
 
-  const maybeScheduleNextMicrotask = () => {
-    if (scheduledNextMicrotask === undefined || !scheduledNextMicrotask.pending()) {
-      scheduledNextMicrotask = microtaskScheduler.scheduleMicrotask(next);
-    }
-  };
-
-  const pollHandle = pollerFactory.create({
+  const driver = socketDriver.create({
     fd,
+    ioBackend,
 
-    callback: ({ status, events }) => {
-
-      pollCallbacksSinceLastMicrotask += 1;
-
-      if (pollCallbacksSinceLastMicrotask > 1) {
-        // something went wrong, we need to make sure we won't get stuck
-        // in a poll loop
-
-        pollHandle.update({
-          events: {
-            readable: false,
-            writable: false
-          }
-        });
-        return;
-      }
-
-      const errno = -status;
-
-      if (errno !== errnoCodes.NO_ERROR) {
-        pollErrno = errno;
-      }
+    isDone: () => {
+      return destroyed || detached;
+    },
 
-      if (events.readable) {
-        socketMaybeHasMore = true;
-      }
+    step,
 
-      if (events.writable) {
-        socketMaybeTakesMore = true;
-      }
+    idle: () => {
+      updatePollEvents();
+    },
 
-      maybeScheduleNextMicrotask();
+    onError: (error) => {
+      raiseErrorAndClose({ error });
     }
   });
 
+  const ioHandle = driver.handle;
+  const maybeScheduleNextMicrotask = driver.schedule;
+
   const updatePollEvents = () => {
     if (destroyed) {
       warnWithStackTrace({ message: "updatePollEvents called after destroy" });
@@ -410,7 +481,10 @@ const create = ({
     let readable = false;
     let writable = false;
 
-    if (!connected || (readRequested || shutdownRequested) && !remoteEnded) {
+    const { wanted: channelsWantData, blocked } = channelDemand();
+    const wantsData = (readRequested || channelsWantData) && !blocked;
+
+    if (!connected || (wantsData || shutdownRequested) && !remoteEnded) {
       readable = true;
     }
 
@@ -418,7 +492,7 @@ const create = ({
       writable = true;
     }
 
-    pollHandle.update({
+    ioHandle.update({
       events: {
         readable,
         writable
@@ -447,59 +521,78 @@ const create = ({
       maybeScheduleNextMicrotask();
     },
 
-    write: (chunk, encoding, callback) => {
-      const messageToSend = {
-        message: chunk,
-
-        sndinfo: {
-          sid: chunk.sid || 0,
-          ppid: chunk.ppid || 0,
-          flags: 0,
-          context: 0,
-        },
-
-        flags: 0,
-      };
+    write: (carrier, encoding, callback) => {
+      const chunk = messageOf(carrier);
+      const error = sendOptionsError(chunk);
+      if (error !== undefined) {
+        callback(error);
+        return;
+      }
 
-      // push due to performance reasons
-      // immutable would be nicer though
       sendQueue.push({
-        messageToSend,
+        chunks: [chunk],
+        sent: 0,
         callback
       });
 
       maybeScheduleNextMicrotask();
     },
 
-    final: (callback) => {
-
-      assert.equal(sendQueue.length, 0, "BUG: sendQueue not empty on final");
+    // corked or buffered writes arrive here together
+    // and are sent with as few syscalls as possible
+    writev: (carriers, callback) => {
+      const chunks = carriers.map(({ chunk }) => {
+        return messageOf(chunk);
+      });
 
-      // in case there is a race an we already received the shutdown from remote
-      if (!remoteEnded) {
-        // initiate graceful shutdown
-        const { errno } = native.shutdown({ fd, how: constants.SHUT_RDWR });
-        if (errno !== errnoCodes.NO_ERROR) {
-          const error = errors.createErrorFromErrno({
-            operation: "shutdown()",
-            errno
-          });
+      const error = chunks.map(sendOptionsError).find((chunkError) => {
+        return chunkError !== undefined;
+      });
 
-          callback(error);
-          return;
-        }
+      if (error !== undefined) {
+        callback(error);
+        return;
       }
 
-      shutdownRequested = true;
+      sendQueue.push({
+        chunks,
+        sent: 0,
+        callback
+      });
 
       maybeScheduleNextMicrotask();
+    },
 
-      callback();
+    final: (callback) => {
+
+      // writes may still be queued, e.g. of stream channels or of
+      // writev() calls, the shutdown waits for them
+      if (sendQueue.length > 0) {
+        pendingFinal = callback;
+        return;
+      }
+
+      shutdownAndCallBack(callback);
     },
 
     destroy: (err, callback) => {
       destroyed = true;
 
+      // copied, as destroyed channels remove themselves
+      [...channels.values()].forEach(({ channel }) => {
+        channel.destroy(err);
+      });
+
+      if (detached) {
+        addressRefresh?.cancel();
+
+        // the fd lives on in the thread that adopts it
+        ioHandle.release();
+
+        callback(err);
+        return;
+      }
+
       if (!shutdownRequested) {
         const { errno } = native.setsockopt_linger({ fd, onoff: 1, linger: 0 });
         if (errno !== errnoCodes.NO_ERROR) {
@@ -510,66 +603,146 @@ const create = ({
         }
       }
 
-      clearInterval(updateAddressIntervalHandle);
+      addressRefresh?.cancel();
 
-      pollHandle.close();
-      native.close_fd({ fd });
+      // closes the fd as well
+      ioHandle.close();
 
       callback(err);
     }
   });
 
-  const updateDuplexProperties = () => {
-    duplex.connecting = !connected;
-    duplex.readyState = connected ? "open" : "opening";
-    duplex.pending = !connected;
+  const shutdownAndCallBack = (callback) => {
+    // in case there is a race an we already received the shutdown from remote
+    if (!remoteEnded) {
+      // initiate graceful shutdown
+      const { errno } = ioHandle.shutdown();
+      if (errno !== errnoCodes.NO_ERROR) {
+        const error = errors.createErrorFromErrno({
+          operation: "shutdown()",
+          errno
+        });
+
+        callback(error);
+        return;
+      }
+    }
+
+    shutdownRequested = true;
+
+    maybeScheduleNextMicrotask();
+
+    callback();
   };
 
-  updateDuplexProperties();
+  const createChannel = ({ sid, ppid, highWaterMark, bufferLimit }) => {
+    const record = { channel: undefined, ppid, bufferLimit, wantsData: false };
 
-  const gatherLocalAddresses = () => {
-    const localPrimary = socketCommon.getCurrentLocalPrimaryAddress({ native, fd });
-    const localSockaddrs = socketCommon.getLocalAddresses({ native, fd });
+    const queueWrite = ({ chunks, callback }) => {
+      if (shutdownRequested || pendingFinal !== undefined) {
+        callback(Error("write after end"));
+        return;
+      }
 
-    const localAddresses = localSockaddrs.map((sockaddr) => {
-      return sockaddr.address;
-    });
+      const error = chunks.map(sendOptionsError).find((chunkError) => {
+        return chunkError !== undefined;
+      });
 
-    const localFamily = localPrimary.family;
-    const localPort = localPrimary.port;
-    const localAddress = localPrimary.address;
+      if (error !== undefined) {
+        callback(error);
+        return;
+      }
 
-    return {
-      localFamily,
-      localPort,
-      localAddress,
-      localAddresses,
+      sendQueue.push({ chunks, sent: 0, callback, sid, ppid });
+
+      maybeScheduleNextMicrotask();
     };
+
+    record.channel = new nodeStreamModule.Duplex({
+      allowHalfOpen: false,
+      readableHighWaterMark: highWaterMark || duplex.readableHighWaterMark,
+      writableHighWaterMark: highWaterMark || duplex.writableHighWaterMark,
+
+      read: () => {
+        record.wantsData = true;
+        maybeScheduleNextMicrotask();
+      },
+
+      write: (chunk, encoding, callback) => {
+        queueWrite({ chunks: [chunk], callback });
+      },
+
+      writev: (chunks, callback) => {
+        queueWrite({
+          chunks: chunks.map(({ chunk }) => {
+            return chunk;
+          }),
+          callback
+        });
+      },
+
+      // the association is shut down by the duplex, not per stream
+      final: (callback) => {
+        callback();
+      },
+
+      // later messages of this stream are emitted by the duplex again
+      destroy: (err, callback) => {
+        if (channels.get(sid) === record) {
+          channels.delete(sid);
+        }
+
+        callback(err);
+      }
+    });
+
+    record.channel.sid = sid;
+
+    if (remoteEnded) {
+      record.channel.push(null);
+    }
+
+    return record;
   };
 
-  const gatherRemoteAddresses = () => {
-    // family and port will never change
-    const remoteFamily = initialRemoteAddress.family;
-    const remotePort = initialRemoteAddress.port;
+  // messages of one stream id as a duplex of their own, with their own
+  // buffering and backpressure, see README
+  duplex.stream = (sid, { ppid = 0, highWaterMark, bufferLimit = DEFAULT_STREAM_BUFFER_LIMIT } = {}) => {
+    if (!Number.isInteger(sid) || sid < 0 || sid > 0xffff) {
+      throw Error("sid must be an integer from 0 to 65535");
+    }
 
-    const remotePrimary = socketCommon.getCurrentRemotePrimaryAddress({ native, fd });
-    const remoteSockaddrs = socketCommon.getRemoteAddresses({ native, fd });
+    if (destroyed) {
+      throw Error("stream called after destroy");
+    }
 
-    let remoteAddresses = undefined;
-    if (remoteSockaddrs !== undefined) {
-      remoteAddresses = remoteSockaddrs.map((sockaddr) => {
-        return sockaddr.address;
-      });
+    let record = channels.get(sid);
+    if (record === undefined) {
+      record = createChannel({ sid, ppid, highWaterMark, bufferLimit });
+      channels.set(sid, record);
     }
 
-    return {
-      remoteFamily,
-      remotePort,
-      remoteAddress: remotePrimary === undefined ? undefined : remotePrimary.address,
-      remoteAddresses
-    };
+    return record.channel;
+  };
+
+  const updateDuplexProperties = () => {
+    duplex.connecting = !connected;
+    duplex.readyState = connected ? "open" : "opening";
+    duplex.pending = !connected;
   };
 
+  updateDuplexProperties();
+
+  socketCommon.subscribeNotificationsOnDemand({
+    native,
+    emitter: duplex,
+    fd,
+    types: onDemandNotifications,
+    isOpen: () => {
+      return !destroyed && !detached;
+    }
+  });
+
   const determineRemoteAddressesToUse = ({ gatheredRemoteAddress, gatheredRemoteAddresses }) => {
     if (!connected) {
       // if we are not connected yet, the socket will not give us the remote addresses
@@ -618,14 +791,13 @@ const create = ({
       localPort,
       localAddress,
       localAddresses,
-    } = gatherLocalAddresses();
-
-    const {
-      remoteFamily,
-      remotePort,
       remoteAddress: gatheredRemoteAddress,
       remoteAddresses: gatheredRemoteAddresses,
-    } = gatherRemoteAddresses();
+    } = socketCommon.snapshotAssociation({ native, fd, withLocal: true, withPeerInfo: false });
+
+    // family and port will never change
+    const remoteFamily = initialRemoteAddress.family;
+    const remotePort = initialRemoteAddress.port;
 
     const {
       remoteAddress,
@@ -666,17 +838,6 @@ const create = ({
     duplex.remoteAddress = remoteAddress;
     duplex.remoteAddresses = remoteAddresses;
 
-    duplex.peerInfoByAddress = {};
-    remoteAddresses.forEach((peerAddress) => {
-      const peerInfo = socketCommon.retrievePeerAddressInfo({
-        native,
-        fd,
-        peerAddress,
-        remotePort: initialRemoteAddress.port
-      });
-      duplex.peerInfoByAddress[peerAddress] = peerInfo;
-    });
-
     if (localChanged || remoteChanged) {
       duplex.emit("address-change");
     }
@@ -684,11 +845,119 @@ const create = ({
     duplex.emit("peer-info-update");
   };
 
+  // path info changes all the time, so it is only fetched when asked for,
+  // once the socket is gone the last fetched info is kept
+  let peerInfoByAddress = {};
+
+  Object.defineProperty(duplex, "peerInfoByAddress", {
+    enumerable: true,
+    get: () => {
+      if (destroyed || detached) {
+        return peerInfoByAddress;
+      }
+
+      // in order to avoid glitches, failures don't throw here, the info
+      // is just unavailable
+      const { errno, remoteAddresses, peerInfo } = native.snapshot_association({
+        fd,
+        withLocal: false,
+        withPeerInfo: true
+      });
+
+      peerInfoByAddress = {};
+      if (errno !== 0 || remoteAddresses === undefined) {
+        duplex.remoteAddresses.forEach((peerAddress) => {
+          peerInfoByAddress[peerAddress] = undefined;
+        });
+      } else {
+        remoteAddresses.forEach((peerAddress, idx) => {
+          peerInfoByAddress[peerAddress] = peerInfo[idx];
+        });
+      }
+
+      return peerInfoByAddress;
+    }
+  });
+
   updateAddressProperties();
 
-  const updateAddressIntervalHandle = setInterval(() => {
-    updateAddressProperties();
-  }, addressGatherInterval);
+  // addresses are updated on notifications, a periodic refresh is only
+  // needed if peer address changes are not subscribed to
+  let addressRefresh = undefined;
+  if (addressGatherInterval !== undefined) {
+    addressRefresh = timerWheel.schedule({
+      interval: addressGatherInterval,
+      callback: updateAddressProperties
+    });
+  }
+
+  const writableLengthOfStream = Object.getOwnPropertyDescriptor(
+    nodeStreamModule.Duplex.prototype,
+    "writableLength"
+  ).get;
+
+  Object.defineProperty(duplex, "writableLength", {
+    get: () => {
+      return writableLengthOfStream.call(duplex) + carriedBytes;
+    }
+  });
+
+  // the writable stream only emits drain if its own length reached the
+  // high water mark, not if carried bytes did
+  const maybeEmitCarriedDrain = () => {
+    if (!carriedBytesNeedDrain || duplex.writableLength >= duplex.writableHighWaterMark) {
+      return;
+    }
+
+    carriedBytesNeedDrain = false;
+
+    if (!duplex.destroyed && !duplex.writableNeedDrain) {
+      duplex.emit("drain");
+    }
+  };
+
+  // sends several buffers as one SCTP message, the kernel gathers them,
+  // so e.g. a header and a payload don't need to be concatenated first
+  duplex.writeMessage = (parts, callback) => {
+    if (!Array.isArray(parts) || parts.length === 0) {
+      throw Error("parts must be provided as non-empty array of buffers");
+    }
+
+    if (parts.length > native.MAX_MESSAGE_PARTS) {
+      throw Error(`a message can consist of at most ${native.MAX_MESSAGE_PARTS} parts`);
+    }
+
+    parts.forEach((part) => {
+      if (!(part instanceof Uint8Array)) {
+        throw Error("parts must be provided as non-empty array of buffers");
+      }
+    });
+
+    // the writable stream only accepts buffers, so an empty one takes the
+    // place of the parts, this keeps the order with write()
+    const carrier = Buffer.alloc(0);
+    const length = parts.reduce((sum, part) => sum + part.byteLength, 0);
+
+    carriedMessages.set(carrier, parts);
+    carriedBytes += length;
+
+    const written = duplex.write(carrier, (error) => {
+      carriedBytes -= length;
+
+      if (callback !== undefined) {
+        callback(error);
+      }
+
+      maybeEmitCarriedDrain();
+    });
+
+    if (written && duplex.writableLength >= duplex.writableHighWaterMark) {
+      carriedBytesNeedDrain = true;
+      return false;
+    }
+
+    return written;
+  };
 
   duplex.address = () => {
     return {
@@ -698,58 +967,37 @@ const create = ({
     };
   };
 
+  // messages abandoned under PR-SCTP policies, of stream sid or of all
+  duplex.abandoned = (sid) => {
+    if (destroyed) {
+      throw Error("abandoned called after destroy");
+    }
+
+    return socketCommon.getAbandonedMessages({ native, fd, sid });
+  };
+
   duplex.status = () => {
     if (destroyed) {
       throw Error("status called after destroy");
     }
 
-    const { errno, info } = native.getsockopt_sctp_status({ fd });
+    return socketCommon.getAssociationStatus({ native, fd });
+  };
 
-    if (errno !== errnoCodes.NO_ERROR) {
-      throw errors.createErrorFromErrno({
-        operation: "getsockopt_sctp_status()",
-        errno
-      });
+  let readStats = undefined;
+
+  // fills buffers.stats and buffers.paths (see stats.js), returns the
+  // number of remote addresses
+  duplex.stats = (buffers) => {
+    if (destroyed) {
+      throw Error("stats called after destroy");
     }
 
-    const tag = Number(info.sctpi_tag);
-    const state = Number(info.sctpi_state);
-    const rwnd = Number(info.sctpi_rwnd);
-    const unackdata = Number(info.sctpi_unackdata);
-    const penddata = Number(info.sctpi_penddata);
-    const numberOfIncomingStreams = Number(info.sctpi_instrms);
-    const numberOfOutgoingStreams = Number(info.sctpi_outstrms);
-    const fragmentationPoint = Number(info.sctpi_fragmentation_point);
-    const incomingQueue = Number(info.sctpi_inqueue);
-    const outgoingQueue = Number(info.sctpi_outqueue);
-    const overallError = Number(info.sctpi_overall_error);
-    const maxBurst = Number(info.sctpi_max_burst);
-    const maxSeg = Number(info.sctpi_maxseg);
-
-    const peer = {
-      tag: Number(info.sctpi_peer_tag),
-      rwnd: Number(info.sctpi_peer_rwnd),
-      cap: Number(info.sctpi_peer_capable),
-      sack: Number(info.sctpi_peer_sack)
-    };
+    if (readStats === undefined) {
+      readStats = statsModule.createReader({ native, fd });
+    }
 
-    return {
-      tag,
-      state,
-      rwnd,
-      unackdata,
-      penddata,
-      numberOfIncomingStreams,
-      numberOfOutgoingStreams,
-      fragmentationPoint,
-      incomingQueue,
-      outgoingQueue,
-      overallError,
-      maxBurst,
-      maxSeg,
-
-      peer
-    };
+    return readStats(buffers);
   };
 
   duplex.setNoDelay = (noDelay = true) => {
@@ -757,17 +1005,103 @@ const create = ({
       throw Error("setNoDelay called after destroy");
     }
 
-    if (typeof noDelay !== "boolean") {
-      throw Error("noDelay must be a boolean");
+    socketCommon.setNoDelay({ native, fd, noDelay });
+  };
+
+  // messages given to write() but not sent yet, including writes the
+  // writable side still buffers, their callbacks are called as the
+  // messages are handed over
+  const takePendingWrites = () => {
+    const pendingWrites = [];
+
+    while (duplex.writableCorked > 0) {
+      duplex.uncork();
     }
 
-    const { errno } = native.setsockopt_nodelay({ fd, value: noDelay ? 1 : 0 });
-    if (errno !== errnoCodes.NO_ERROR) {
-      throw errors.createErrorFromErrno({
-        operation: "setsockopt_nodelay()",
-        errno
+    while (sendQueue.length > 0) {
+      const entry = sendQueue.shift();
+
+      entry.chunks.slice(entry.sent).forEach((chunk) => {
+        pendingWrites.push({
+          parts: (Array.isArray(chunk) ? chunk : [chunk]).map(copyForTransfer),
+          sid: chunk.sid || 0,
+          ppid: chunk.ppid || 0,
+          sendOptions: socketCommon.copySendOptions({ from: chunk, to: {} })
+        });
       });
+
+      // the writable side passes its buffered writes on synchronously,
+      // so they end up in the send queue as well
+      entry.callback();
+    }
+
+    return pendingWrites;
+  };
+
+  // messages pushed to the readable side but not read yet
+  const takePendingReads = () => {
+    const pendingReads = [];
+
+    for (const data of duplex.readableBuffer) {
+      // newer node versions keep consumed slots as null
+      if (data !== null) {
+        pendingReads.push({
+          data: copyForTransfer(data),
+          sid: data.sid || 0,
+          ppid: data.ppid || 0,
+          partial: data.partial === true
+        });
+      }
+    }
+
+    return pendingReads;
+  };
+
+  // stops all I/O on this thread without closing the association, the
+  // returned object can be posted to another thread and passed to adopt()
+  duplex.detach = () => {
+    if (destroyed) {
+      throw Error("detach called after destroy");
+    }
+
+    if (ioHandle.release === undefined) {
+      throw Error("detach is only supported with the poll io backend");
+    }
+
+    if (!connected || remoteEnded || shutdownRequested || duplex.writableEnded) {
+      throw Error("only established associations can be detached");
+    }
+
+    if (assembler.pending()) {
+      throw Error("associations can't be detached while a message is partially received");
+    }
+
+    if (channels.size > 0) {
+      throw Error("associations with stream channels can't be detached");
     }
+
+    detached = true;
+
+    const pendingWrites = takePendingWrites();
+    const pendingReads = takePendingReads();
+
+    const transfer = {
+      fd,
+      initialRemoteAddress: {
+        family: duplex.remoteFamily,
+        address: duplex.remoteAddress,
+        port: duplex.remotePort
+      },
+      onDemandNotifications,
+      addressGatherInterval,
+      partialDelivery,
+      pendingReads,
+      pendingWrites
+    };
+
+    duplex.destroy();
+
+    return transfer;
   };
 
   maybeScheduleNextMicrotask();
@@ -775,6 +1109,62 @@ const create = ({
   return duplex;
 };
 
+const toBuffer = (data) => {
+  return Buffer.from(data.buffer, data.byteOffset, data.byteLength);
+};
+
+// rebuilds an association handed over by detach(), messages that were
+// pending there are read and sent first
+const adopt = ({ transfer, ioBackend, duplexOptions }) => {
+  const {
+    fd,
+    initialRemoteAddress,
+    onDemandNotifications,
+    addressGatherInterval,
+    partialDelivery,
+    pendingReads,
+    pendingWrites
+  } = transfer;
+
+  const duplex = create({
+    fd,
+    connected: true,
+    initialRemoteAddress,
+    ioBackend,
+    onDemandNotifications,
+    addressGatherInterval,
+    partialDelivery,
+    duplexOptions
+  });
+
+  // unshift() puts every message in front of the ones after it,
+  // and nothing is received from the socket before the first read
+  for (let i = pendingReads.length - 1; i >= 0; i -= 1) {
+    const { data, sid, ppid, partial } = pendingReads[i];
+    const message = toBuffer(data);
+    message.sid = sid;
+    message.ppid = ppid;
+
+    if (partial) {
+      message.partial = true;
+    }
+
+    duplex.unshift(message);
+  }
+
+  pendingWrites.forEach(({ parts, sid, ppid, sendOptions }) => {
+    const message = parts.map(toBuffer);
+    message.sid = sid;
+    message.ppid = ppid;
+    socketCommon.copySendOptions({ from: sendOptions, to: message });
+
+    duplex.writeMessage(message);
+  });
+
+  return duplex;
+};
+
 module.exports = {
-  create
+  create,
+  adopt
 };
@@ -0,0 +1,106 @@
+const errors = require("./errors.js");
+
+// association stats are read into caller provided Float64Arrays instead of
+// objects, so they can be polled often without creating garbage
+//
+// stats holds the fields below, following SCTP_STATUS and
+// SCTP_GET_ASSOC_STATS, paths holds PATH_FIELDS per remote address,
+// following SCTP_GET_PEER_ADDR_INFO, in the order of remoteAddresses
+
+const FIELD_NAMES = [
+  "state",
+  "rwnd",
+  "unackdata",
+  "penddata",
+  "numberOfIncomingStreams",
+  "numberOfOutgoingStreams",
+  "fragmentationPoint",
+  "maxRto",
+  "sacksReceived",
+  "sacksSent",
+  "packetsSent",
+  "packetsReceived",
+  "retransmittedChunks",
+  "outOfSequenceTsns",
+  "duplicateChunksReceived",
+  "gapAcks",
+  "unorderedChunksSent",
+  "unorderedChunksReceived",
+  "orderedChunksSent",
+  "orderedChunksReceived",
+  "controlChunksSent",
+  "controlChunksReceived"
+];
+
+const PATH_FIELD_NAMES = [
+  "state",
+  "cwnd",
+  "srtt",
+  "rto",
+  "mtu"
+];
+
+const indexByName = ({ names }) => {
+  return Object.freeze(Object.fromEntries(names.map((name, idx) => {
+    return [name, idx];
+  })));
+};
+
+const FIELDS = indexByName({ names: FIELD_NAMES });
+const PATH_FIELDS = indexByName({ names: PATH_FIELD_NAMES });
+
+const create = ({ maxPaths = 4 } = {}) => {
+  if (!Number.isInteger(maxPaths) || maxPaths < 0) {
+    throw Error("maxPaths must be a non-negative integer");
+  }
+
+  return {
+    stats: new Float64Array(FIELD_NAMES.length),
+    paths: new Float64Array(maxPaths * PATH_FIELD_NAMES.length)
+  };
+};
+
+const validateBuffers = ({ stats, paths }) => {
+  if (!(stats instanceof Float64Array) || stats.length < FIELD_NAMES.length) {
+    throw Error(`stats must be provided as Float64Array of at least ${FIELD_NAMES.length} elements`);
+  }
+
+  if (!(paths instanceof Float64Array)) {
+    throw Error("paths must be provided as Float64Array");
+  }
+};
+
+// returns a function reading the stats of one association into the given
+// buffers, it returns the number of remote addresses, paths holds as many
+// of them as fit
+const createReader = ({ native, fd, assocId = 0 }) => {
+  if (native.ASSOC_STATS_FIELDS !== FIELD_NAMES.length || native.ASSOC_STATS_PATH_FIELDS !== PATH_FIELD_NAMES.length) {
+    throw Error("stats layout does not match the native addon");
+  }
+
+  const args = { fd, assocId, stats: undefined, paths: undefined };
+
+  // called with the caller's buffers object as it is, nothing is allocated
+  return (buffers) => {
+    validateBuffers(buffers);
+
+    args.stats = buffers.stats;
+    args.paths = buffers.paths;
+    const result = native.get_association_stats(args);
+    args.stats = undefined;
+    args.paths = undefined;
+
+    if (result < 0) {
+      throw errors.createErrorFromErrno({ operation: "get_association_stats()", errno: -result });
+    }
+
+    return result;
+  };
+};
+
+module.exports = {
+  FIELDS,
+  PATH_FIELDS,
+  create,
+  createReader
+};
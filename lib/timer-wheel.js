@@ -0,0 +1,73 @@
+const { callAndReportExceptions } = require("./poller.js");
+
+// periodic work of all sockets of this thread runs off one timer per
+// interval: every entry is put into a random slot of a wheel, the wheel
+// advances one slot per tick and runs the entries of that slot, so each
+// entry runs once per interval and many sockets don't pile up on one tick
+
+const SLOTS = 64;
+
+const wheelsByInterval = new Map();
+
+const createWheel = ({ interval }) => {
+  const slots = Array.from({ length: SLOTS }, () => {
+    return new Set();
+  });
+
+  let current = 0;
+  let size = 0;
+  let timer = undefined;
+
+  const tick = () => {
+    current = (current + 1) % SLOTS;
+
+    slots[current].forEach((callback) => {
+      callAndReportExceptions({ callback, args: undefined });
+    });
+  };
+
+  const add = ({ callback }) => {
+    const slot = slots[Math.floor(Math.random() * SLOTS)];
+    slot.add(callback);
+    size += 1;
+
+    if (timer === undefined) {
+      // the sockets keep the process alive, not their periodic work
+      timer = setInterval(tick, Math.max(1, Math.round(interval / SLOTS)));
+      timer.unref();
+    }
+
+    return {
+      cancel: () => {
+        if (!slot.delete(callback)) {
+          return;
+        }
+
+        size -= 1;
+
+        if (size === 0) {
+          clearInterval(timer);
+          timer = undefined;
+          wheelsByInterval.delete(interval);
+        }
+      }
+    };
+  };
+
+  return { add };
+};
+
+// calls callback about every interval ms until the returned handle is cancelled
+const schedule = ({ interval, callback }) => {
+  let wheel = wheelsByInterval.get(interval);
+  if (wheel === undefined) {
+    wheel = createWheel({ interval });
+    wheelsByInterval.set(interval, wheel);
+  }
+
+  return wheel.add({ callback });
+};
+
+module.exports = {
+  schedule
+};
@@ -390,6 +390,36 @@ static void napi_helper_add_bool_field_asserted(napi_env env, napi_value obj, co
   }
 }
 
+static void napi_helper_add_uint32_field_asserted(napi_env env, napi_value obj, const char* name, uint32_t value) {
+  napi_value js_value;
+  napi_status status;
+
+  status = napi_create_uint32(env, value, &js_value);
+  if (status != napi_ok) {
+    abort();
+  }
+
+  status = napi_set_named_property(env, obj, name, js_value);
+  if (status != napi_ok) {
+    abort();
+  }
+}
+
+static void napi_helper_add_string_field_asserted(napi_env env, napi_value obj, const char* name, const char* value) {
+  napi_value js_value;
+  napi_status status;
+
+  status = napi_create_string_utf8(env, value, NAPI_AUTO_LENGTH, &js_value);
+  if (status != napi_ok) {
+    abort();
+  }
+
+  status = napi_set_named_property(env, obj, name, js_value);
+  if (status != napi_ok) {
+    abort();
+  }
+}
+
 static void napi_helper_add_field_asserted(napi_env env, napi_value obj, const char* name, napi_value value) {
   napi_status status;
 
@@ -492,6 +522,30 @@ static napi_value napi_helper_create_array_asserted(napi_env env, const char* me
   return result;
 }
 
+static napi_value napi_helper_create_arraybuffer_asserted(napi_env env, size_t byte_length, void** data, const char* message) {
+  napi_status status;
+  napi_value result;
+
+  status = napi_create_arraybuffer(env, byte_length, data, &result);
+  if (status != napi_ok) {
+    abort_with_message(message);
+  }
+
+  return result;
+}
+
+static napi_value napi_helper_create_uint32_array_asserted(napi_env env, napi_value arraybuffer, size_t length, const char* message) {
+  napi_status status;
+  napi_value result;
+
+  status = napi_create_typedarray(env, napi_uint32_array, length, arraybuffer, 0, &result);
+  if (status != napi_ok) {
+    abort_with_message(message);
+  }
+
+  return result;
+}
+
 static napi_value napi_helper_create_buffer_copy_asserted(napi_env env, const void* ptr, size_t length, const char* message) {
   napi_status status;
   napi_value result;
@@ -9,19 +9,42 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <stdatomic.h>
 
 #include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
 #include <netinet/sctp.h>
 #include <arpa/inet.h>
+#include <linux/sockios.h>
 
 #include <unistd.h>
 
 
+// one-to-one (SOCK_STREAM) sockets carry one association each, a
+// one-to-many (SOCK_SEQPACKET) socket carries all associations of an
+// endpoint, messages are then addressed by association id
 napi_value create_socket(napi_env env, napi_callback_info info) {
   int socket_fd;
+  int one_to_many;
+  napi_value js_args_obj;
   napi_value js_ret_obj;
+  napi_status status;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  one_to_many = napi_helper_require_named_bool_asserted(env, js_args_obj, "oneToMany");
 
-  socket_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_SCTP);
+  socket_fd = socket(AF_INET, (one_to_many ? SOCK_SEQPACKET : SOCK_STREAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_SCTP);
 
   if (socket_fd < 0) {
     return napi_helper_create_errno_result_asserted(env, errno);
@@ -91,72 +114,23 @@ napi_value getsockopt_sctp_status(napi_env env, napi_callback_info info) {
   }
 
   js_info = napi_helper_create_object_asserted(env);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_tag", sctpi.sctpi_tag);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_state", sctpi.sctpi_state);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_rwnd", sctpi.sctpi_rwnd);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_unackdata", sctpi.sctpi_unackdata);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_penddata", sctpi.sctpi_penddata);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_instrms", sctpi.sctpi_instrms);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_outstrms", sctpi.sctpi_outstrms);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_fragmentation_point", sctpi.sctpi_fragmentation_point);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_inqueue", sctpi.sctpi_inqueue);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_outqueue", sctpi.sctpi_outqueue);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_overall_error", sctpi.sctpi_overall_error);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_max_burst", sctpi.sctpi_max_burst);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_maxseg", sctpi.sctpi_maxseg);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_peer_rwnd", sctpi.sctpi_peer_rwnd);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_peer_tag", sctpi.sctpi_peer_tag);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_peer_capable", sctpi.sctpi_peer_capable);
-  napi_helper_add_uint64_field_asserted(env, js_info, "sctpi_peer_sack", sctpi.sctpi_peer_sack);
-
-  js_result = napi_helper_create_object_asserted(env);
-  napi_helper_add_int32_field_asserted(env, js_result, "errno", 0);
-  napi_helper_set_named_property_asserted(env, js_result, "info", js_info);
-
-  return js_result;
-}
-
-napi_value getsockopt_peer_addr_info(napi_env env, napi_callback_info info) {
-  int rc;
-  int32_t fd;
-  napi_value js_args_obj;
-  napi_value js_result;
-  napi_value js_info;
-  napi_status status;
-  struct sockaddr* sockaddr_ptr;
-  size_t sockaddr_length;
-  struct sctp_paddrinfo spinfo = {0};
-  socklen_t spinfo_len = sizeof(spinfo);
-
-  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
-  if (status != napi_ok) {
-    return napi_helper_get_undefined(env);
-  }
-
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "getsockopt_peer_addr_info: fd must be provided as number");
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", (void**) &sockaddr_ptr, &sockaddr_length, "getsockopt_peer_addr_info: sockaddr must be provided as buffer");
-
-  if (sockaddr_length > sizeof(spinfo.spinfo_address)) {
-    abort_with_message("getsockopt_peer_addr_info: sockaddr buffer is too large");
-  }
-
-  memcpy(&spinfo.spinfo_address, sockaddr_ptr, sockaddr_length);
-
-  rc = getsockopt(fd, IPPROTO_SCTP, SCTP_GET_PEER_ADDR_INFO, &spinfo, &spinfo_len);
-  if (rc < 0) {
-    return napi_helper_create_errno_result_asserted(env, errno);
-  }
-
-  if (spinfo_len < sizeof(spinfo)) {
-    abort_with_message("getsockopt_peer_addr_info: unexpected length of sctp_paddrinfo");
-  }
-
-  js_info = napi_helper_create_object_asserted(env);
-  napi_helper_add_uint64_field_asserted(env, js_info, "spinfo_state", spinfo.spinfo_state);
-  napi_helper_add_uint64_field_asserted(env, js_info, "spinfo_cwnd", spinfo.spinfo_cwnd);
-  napi_helper_add_uint64_field_asserted(env, js_info, "spinfo_srtt", spinfo.spinfo_srtt);
-  napi_helper_add_uint64_field_asserted(env, js_info, "spinfo_rto", spinfo.spinfo_rto);
-  napi_helper_add_uint64_field_asserted(env, js_info, "spinfo_mtu", spinfo.spinfo_mtu);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_tag", sctpi.sctpi_tag);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_state", sctpi.sctpi_state);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_rwnd", sctpi.sctpi_rwnd);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_unackdata", sctpi.sctpi_unackdata);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_penddata", sctpi.sctpi_penddata);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_instrms", sctpi.sctpi_instrms);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_outstrms", sctpi.sctpi_outstrms);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_fragmentation_point", sctpi.sctpi_fragmentation_point);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_inqueue", sctpi.sctpi_inqueue);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_outqueue", sctpi.sctpi_outqueue);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_overall_error", sctpi.sctpi_overall_error);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_max_burst", sctpi.sctpi_max_burst);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_maxseg", sctpi.sctpi_maxseg);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_peer_rwnd", sctpi.sctpi_peer_rwnd);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_peer_tag", sctpi.sctpi_peer_tag);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_peer_capable", sctpi.sctpi_peer_capable);
+  napi_helper_add_uint32_field_asserted(env, js_info, "sctpi_peer_sack", sctpi.sctpi_peer_sack);
 
   js_result = napi_helper_create_object_asserted(env);
   napi_helper_add_int32_field_asserted(env, js_result, "errno", 0);
@@ -277,6 +251,34 @@ napi_value setsockopt_nodelay(napi_env env, napi_callback_info info) {
   return napi_helper_create_errno_result_asserted(env, errno_value);
 }
 
+// lets several sockets, e.g. one per worker thread or process, bind the
+// same addresses and port, the kernel spreads new associations across them
+napi_value setsockopt_reuseport(napi_env env, napi_callback_info info) {
+  int rc;
+  int32_t fd;
+  napi_value js_args_obj;
+  napi_status status;
+  int errno_value;
+  int value;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "setsockopt_reuseport: fd must be provided as number");
+  value = napi_helper_require_named_int32_asserted(env, js_args_obj, "value", "setsockopt_reuseport: value must be provided as number");
+
+  rc = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value));
+  if (rc < 0) {
+    errno_value = errno;
+  } else {
+    errno_value = 0;
+  }
+
+  return napi_helper_create_errno_result_asserted(env, errno_value);
+}
+
 napi_value setsockopt_sctp_event(napi_env env, napi_callback_info info) {
   int rc;
   int32_t fd;
@@ -304,6 +306,132 @@ napi_value setsockopt_sctp_event(napi_env env, napi_callback_info info) {
   return napi_helper_create_errno_result_asserted(env, errno_value);
 }
 
+// a socket configuration is a Uint32Array of records, CONFIGURE_SOCKET_STRIDE
+// values each, the first value selects the option, the others are its
+// arguments, so all options of a new socket cost one call into native code
+#define CONFIGURE_SOCKET_STRIDE 5
+
+#define CONFIGURE_SOCKET_EVENT 0
+#define CONFIGURE_SOCKET_SACK_INFO 1
+#define CONFIGURE_SOCKET_RECVRCVINFO 2
+#define CONFIGURE_SOCKET_NODELAY 3
+#define CONFIGURE_SOCKET_INITMSG 4
+#define CONFIGURE_SOCKET_FRAGMENT_INTERLEAVE 5
+#define CONFIGURE_SOCKET_PARTIAL_DELIVERY_POINT 6
+#define CONFIGURE_SOCKET_PR_SUPPORTED 7
+
+static int apply_socket_configuration_record(int fd, const uint32_t* record) {
+  int value;
+  uint32_t pd_point;
+  struct sctp_event event = {};
+  struct sctp_sack_info sack_info = {};
+  struct sctp_initmsg initmsg = {};
+  struct sctp_assoc_value assoc_value = {};
+
+  switch (record[0]) {
+    case CONFIGURE_SOCKET_EVENT:
+      event.se_type = record[1];
+      event.se_on = record[2];
+      event.se_assoc_id = record[3];
+      return setsockopt(fd, IPPROTO_SCTP, SCTP_EVENT, &event, sizeof(event));
+
+    case CONFIGURE_SOCKET_SACK_INFO:
+      sack_info.sack_assoc_id = record[1];
+      sack_info.sack_delay = record[2];
+      sack_info.sack_freq = record[3];
+      return setsockopt(fd, IPPROTO_SCTP, SCTP_DELAYED_ACK_TIME, &sack_info, sizeof(sack_info));
+
+    case CONFIGURE_SOCKET_RECVRCVINFO:
+      value = record[1];
+      return setsockopt(fd, IPPROTO_SCTP, SCTP_RECVRCVINFO, &value, sizeof(value));
+
+    case CONFIGURE_SOCKET_NODELAY:
+      value = record[1];
+      return setsockopt(fd, IPPROTO_SCTP, SCTP_NODELAY, &value, sizeof(value));
+
+    case CONFIGURE_SOCKET_INITMSG:
+      initmsg.sinit_num_ostreams = record[1];
+      initmsg.sinit_max_instreams = record[2];
+      initmsg.sinit_max_attempts = record[3];
+      initmsg.sinit_max_init_timeo = record[4];
+      return setsockopt(fd, IPPROTO_SCTP, SCTP_INITMSG, &initmsg, sizeof(initmsg));
+
+    case CONFIGURE_SOCKET_FRAGMENT_INTERLEAVE:
+      value = record[1];
+      return setsockopt(fd, IPPROTO_SCTP, SCTP_FRAGMENT_INTERLEAVE, &value, sizeof(value));
+
+    case CONFIGURE_SOCKET_PARTIAL_DELIVERY_POINT:
+      pd_point = record[1];
+      return setsockopt(fd, IPPROTO_SCTP, SCTP_PARTIAL_DELIVERY_POINT, &pd_point, sizeof(pd_point));
+
+    case CONFIGURE_SOCKET_PR_SUPPORTED:
+      assoc_value.assoc_id = 0;
+      assoc_value.assoc_value = record[1];
+      if (setsockopt(fd, IPPROTO_SCTP, SCTP_PR_SUPPORTED, &assoc_value, sizeof(assoc_value)) < 0 && errno != ENOPROTOOPT) {
+        return -1;
+      }
+
+      // kernels before 4.6 don't know the option, they offer PR-SCTP
+      // as configured by net.sctp.prsctp_enable
+      return 0;
+
+    default:
+      abort_with_message("configure_socket: unknown option");
+      return -1;
+  }
+}
+
+// applies the records in order and stops at the first one that fails,
+// failedIndex is the index of that record or -1
+static napi_value configure_socket(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  int32_t failed_index = -1;
+  int errno_value = 0;
+  size_t index;
+  napi_value js_args_obj;
+  napi_value js_options;
+  napi_value js_ret_obj;
+  napi_status status;
+  napi_typedarray_type options_type;
+  size_t options_length;
+  uint32_t* options_ptr;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "configure_socket: fd must be provided as number");
+
+  status = napi_get_named_property(env, js_args_obj, "options", &js_options);
+  if (status != napi_ok) {
+    abort_with_message("configure_socket: options must be provided as Uint32Array");
+  }
+
+  status = napi_get_typedarray_info(env, js_options, &options_type, &options_length, (void**) &options_ptr, NULL, NULL);
+  if (status != napi_ok || options_type != napi_uint32_array) {
+    abort_with_message("configure_socket: options must be provided as Uint32Array");
+  }
+
+  if (options_length % CONFIGURE_SOCKET_STRIDE != 0) {
+    abort_with_message("configure_socket: options length must be a multiple of the stride");
+  }
+
+  for (index = 0; index < options_length / CONFIGURE_SOCKET_STRIDE; index += 1) {
+    if (apply_socket_configuration_record(fd, options_ptr + index * CONFIGURE_SOCKET_STRIDE) < 0) {
+      errno_value = errno;
+      failed_index = index;
+      break;
+    }
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno_value);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "failedIndex", failed_index);
+
+  return js_ret_obj;
+}
+
 static struct sockaddr* alloc_and_fill_sockaddr_list(napi_env env, napi_value js_address_list) {
   int i;
   int address_count;
@@ -389,345 +517,795 @@ struct native_listen_handle {
   napi_ref js_callback_fn_ref;
 };
 
-struct native_poll_handle {
-  int close_pending;
-  int closed;
-  int finalizer_called;
-  int fd;
+// all sockets of an environment share one epoll set, libuv only polls the
+// epoll fd, so one loop iteration results in at most one call into javascript
+#define POLL_DISPATCH_READABLE 1
+#define POLL_DISPATCH_WRITABLE 2
+
+#define POLL_DISPATCH_EVENT_FD 0
+#define POLL_DISPATCH_EVENT_EVENTS 1
+#define POLL_DISPATCH_EVENT_STATUS 2
+#define POLL_DISPATCH_EVENT_STRIDE 3
+
+struct native_poll_dispatcher {
+  int epoll_fd;
+  int registered_fds;
   uv_poll_t uv_poll_handle;
   napi_env env;
-  napi_ref js_poll_callback_fn_ref;
+  napi_ref js_callback_fn_ref;
+  napi_ref js_events_ref;
+  int32_t* events_ptr;
+  int max_events;
+  struct epoll_event* ready_events;
+  napi_async_cleanup_hook_handle cleanup_hook_handle;
 };
 
-static void poll_cb_with_handle_scope(struct native_poll_handle* poll_handle, int uv_status, int events) {
+// the requested events are kept next to the fd in the epoll data,
+// so hangups can be reported like libuv does, without a lookup table
+static uint64_t poll_dispatch_pack_data(int fd, uint32_t events) {
+  return ((uint64_t) events << 32) | (uint32_t) fd;
+}
+
+static void poll_dispatch_fill_event(int32_t* event, const struct epoll_event* ready_event) {
+  uint32_t requested_events = ready_event->data.u64 >> 32;
+  int32_t events = 0;
+
+  event[POLL_DISPATCH_EVENT_FD] = (int32_t) (ready_event->data.u64 & 0xffffffff);
+  event[POLL_DISPATCH_EVENT_STATUS] = 0;
+
+  if (ready_event->events & EPOLLERR) {
+    // same as uv_poll, the socket error needs to be fetched separately
+    event[POLL_DISPATCH_EVENT_STATUS] = UV_EBADF;
+  }
+
+  if (ready_event->events & (EPOLLIN | EPOLLHUP)) {
+    events |= POLL_DISPATCH_READABLE;
+  }
+
+  if (ready_event->events & (EPOLLOUT | EPOLLHUP)) {
+    events |= POLL_DISPATCH_WRITABLE;
+  }
+
+  event[POLL_DISPATCH_EVENT_EVENTS] = events & requested_events;
+}
+
+static void poll_dispatch_cb_with_handle_scope(struct native_poll_dispatcher* dispatcher, int uv_status) {
   napi_status status;
   napi_value js_callback_fn;
   napi_value js_callback_ret;
-  napi_value js_arg;
-  napi_value js_events;
-  napi_env env = poll_handle->env;
+  napi_value js_args[2];
+  napi_env env = dispatcher->env;
+  int ready_count = 0;
+  int i;
 
-  status = napi_get_reference_value(env, poll_handle->js_poll_callback_fn_ref, &js_callback_fn);
-  if (status != napi_ok) {
-    abort_with_message("poll_cb_with_handle_scope: failed to get reference to callback function");
+  if (uv_status == 0) {
+    ready_count = epoll_wait(dispatcher->epoll_fd, dispatcher->ready_events, dispatcher->max_events, 0);
+    if (ready_count < 0) {
+      uv_status = -errno;
+      ready_count = 0;
+    }
+  }
+
+  if (ready_count == 0 && uv_status == 0) {
+    // spurious wakeup, nothing to report
+    return;
   }
 
-  js_events = napi_helper_create_object_asserted(env);
-  napi_helper_add_bool_field_asserted(env, js_events, "readable", (events & UV_READABLE) != 0);
-  napi_helper_add_bool_field_asserted(env, js_events, "writable", (events & UV_WRITABLE) != 0);
+  for (i = 0; i < ready_count; i += 1) {
+    poll_dispatch_fill_event(dispatcher->events_ptr + i * POLL_DISPATCH_EVENT_STRIDE, &dispatcher->ready_events[i]);
+  }
 
-  js_arg = napi_helper_create_object_asserted(env);
-  napi_helper_set_named_property_asserted(env, js_arg, "events", js_events);
-  napi_helper_add_int32_field_asserted(env, js_arg, "status", uv_status);
+  status = napi_get_reference_value(env, dispatcher->js_callback_fn_ref, &js_callback_fn);
+  if (status != napi_ok) {
+    abort_with_message("poll_dispatch_cb_with_handle_scope: failed to get reference to callback function");
+  }
 
-  status = napi_call_function(env, napi_helper_get_undefined(env), js_callback_fn, 1, &js_arg, &js_callback_ret);
+  status = napi_create_int32(env, ready_count, &js_args[0]);
+  if (status != napi_ok) {
+    abort_with_message("poll_dispatch_cb_with_handle_scope: failed to create ready count");
+  }
+
+  status = napi_create_int32(env, uv_status, &js_args[1]);
   if (status != napi_ok) {
-    abort_with_message("poll_cb_with_handle_scope: failed to call callback function");
+    abort_with_message("poll_dispatch_cb_with_handle_scope: failed to create status");
+  }
+
+  status = napi_call_function(env, napi_helper_get_undefined(env), js_callback_fn, 2, js_args, &js_callback_ret);
+  // javascript can no longer run while a worker is terminated
+  if (status != napi_ok && status != napi_pending_exception) {
+    abort_with_message("poll_dispatch_cb_with_handle_scope: failed to call callback function");
   }
 }
 
-static void poll_cb(uv_poll_t* handle, int uv_status, int events) {
+static void poll_dispatch_cb(uv_poll_t* handle, int uv_status, int events) {
   napi_handle_scope handle_scope;
-  struct native_poll_handle* poll_handle = (struct native_poll_handle*) handle->data;
+  struct native_poll_dispatcher* dispatcher = (struct native_poll_dispatcher*) handle->data;
 
   // we need to get a handle scope to interoperate with JavaScript
-  napi_helper_open_handle_scope_asserted(poll_handle->env, &handle_scope);
+  napi_helper_open_handle_scope_asserted(dispatcher->env, &handle_scope);
 
-  poll_cb_with_handle_scope(poll_handle, uv_status, events);
+  poll_dispatch_cb_with_handle_scope(dispatcher, uv_status);
 
-  napi_helper_close_handle_scope_asserted(poll_handle->env, handle_scope);
+  napi_helper_close_handle_scope_asserted(dispatcher->env, handle_scope);
 }
 
-static napi_value poll_start(napi_env env, napi_callback_info info) {
+static napi_status poll_dispatch_require_args(napi_env env, napi_callback_info info, struct native_poll_dispatcher** dispatcher, napi_value* js_args_obj) {
   napi_status status;
-  napi_value js_args_obj;
-  napi_value js_events_obj;
-  int arg_readable = 0;
-  int arg_writable = 0;
-  struct native_poll_handle* poll_handle;
-  enum uv_poll_event requested_events = 0;
-  size_t argc = 0;
-  int rc;
+  size_t argc = 1;
 
-  status = napi_get_cb_info(env, info, &argc, NULL, NULL, (void**) &poll_handle);
+  status = napi_get_cb_info(env, info, &argc, js_args_obj, NULL, (void**) dispatcher);
   if (status != napi_ok) {
     napi_throw_error(env, NULL, "failed to get callback info");
-    return napi_helper_get_undefined(env);
+    return status;
   }
 
-  if (poll_handle->closed || poll_handle->close_pending) {
-    napi_throw_error(env, NULL, "poll handle already closed");
-    return napi_helper_get_undefined(env);
+  if (argc != 1) {
+    napi_throw_error(env, NULL, "expected exactly one argument");
+    return napi_invalid_arg;
   }
 
-  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
-  if (status != napi_ok) {
-    return napi_helper_get_undefined(env);
+  if ((*dispatcher)->epoll_fd < 0) {
+    napi_throw_error(env, NULL, "poll dispatcher already closed");
+    return napi_invalid_arg;
   }
 
-  js_events_obj = napi_helper_require_named_object_asserted(env, js_args_obj, "events", "poll_start: events must be provided as object");
-  arg_readable = napi_helper_require_named_bool_asserted(env, js_events_obj, "readable");
-  arg_writable = napi_helper_require_named_bool_asserted(env, js_events_obj, "writable");
+  return napi_ok;
+}
+
+static uint32_t poll_dispatch_require_events(napi_env env, napi_value js_args_obj) {
+  napi_value js_events_obj;
+  uint32_t events = 0;
 
-  if (arg_readable) {
-    requested_events |= UV_READABLE;
-  }
+  js_events_obj = napi_helper_require_named_object_asserted(env, js_args_obj, "events", "poll_dispatch: events must be provided as object");
 
-  if (arg_writable) {
-    requested_events |= UV_WRITABLE;
+  if (napi_helper_require_named_bool_asserted(env, js_events_obj, "readable")) {
+    events |= POLL_DISPATCH_READABLE;
   }
 
-  rc = uv_poll_start(&poll_handle->uv_poll_handle, requested_events, poll_cb);
-  if (rc < 0) {
-    napi_throw_error(env, NULL, "uv_poll_start failed");
-    return napi_helper_get_undefined(env);
+  if (napi_helper_require_named_bool_asserted(env, js_events_obj, "writable")) {
+    events |= POLL_DISPATCH_WRITABLE;
   }
 
-  return napi_helper_get_undefined(env);
+  return events;
 }
 
-static napi_value poll_stop(napi_env env, napi_callback_info info) {
-  napi_status status;
-  struct native_poll_handle* poll_handle;
-  size_t argc = 0;
-  int rc;
+static int poll_dispatch_ctl(struct native_poll_dispatcher* dispatcher, int op, int fd, uint32_t events) {
+  struct epoll_event epoll_event;
 
-  status = napi_get_cb_info(env, info, &argc, NULL, NULL, (void**) &poll_handle);
-  if (status != napi_ok) {
-    napi_throw_error(env, NULL, "failed to get callback info");
-    return napi_helper_get_undefined(env);
-  }
+  memset(&epoll_event, 0, sizeof(epoll_event));
 
-  if (poll_handle->closed || poll_handle->close_pending) {
-    napi_throw_error(env, NULL, "poll handle already closed");
-    return napi_helper_get_undefined(env);
+  // level triggered, a socket stays ready until it was drained
+  if (events & POLL_DISPATCH_READABLE) {
+    epoll_event.events |= EPOLLIN;
   }
 
-  rc = uv_poll_stop(&poll_handle->uv_poll_handle);
-  if (rc < 0) {
-    napi_throw_error(env, NULL, "uv_poll_stop failed");
-    return napi_helper_get_undefined(env);
+  if (events & POLL_DISPATCH_WRITABLE) {
+    epoll_event.events |= EPOLLOUT;
   }
 
-  return napi_helper_get_undefined(env);
-}
+  epoll_event.data.u64 = poll_dispatch_pack_data(fd, events);
 
-static void poll_handle_maybe_free(struct native_poll_handle* poll_handle);
+  if (epoll_ctl(dispatcher->epoll_fd, op, fd, &epoll_event) < 0) {
+    return errno;
+  }
 
-static void poll_handle_uv_close_cb(uv_handle_t* handle) {
-  struct native_poll_handle* poll_handle = (struct native_poll_handle*) handle->data;
+  return 0;
+}
 
-  // add some assertions to make sure we are in a consistent state
+// the epoll fd is only polled while sockets are registered,
+// so an idle dispatcher does not keep the event loop alive
+static void poll_dispatch_update_uv_poll(struct native_poll_dispatcher* dispatcher) {
+  int rc;
 
-  if (!poll_handle->close_pending) {
-    abort_with_message("poll_handle_uv_close_cb: close not pending");
+  if (dispatcher->registered_fds > 0) {
+    rc = uv_poll_start(&dispatcher->uv_poll_handle, UV_READABLE, poll_dispatch_cb);
+  } else {
+    rc = uv_poll_stop(&dispatcher->uv_poll_handle);
   }
 
-  if (poll_handle->closed) {
-    abort_with_message("poll_handle_uv_close_cb: already closed");
+  if (rc < 0) {
+    abort_with_message("poll_dispatch_update_uv_poll: failed to update uv poll");
   }
-
-  poll_handle->close_pending = 0;
-  poll_handle->closed = 1;
-
-  poll_handle_maybe_free(poll_handle);
 }
 
-static napi_value poll_close(napi_env env, napi_callback_info info) {
+static napi_value poll_dispatch_add(napi_env env, napi_callback_info info) {
   napi_status status;
-  struct native_poll_handle* poll_handle;
-  size_t argc = 0;
-  int rc;
+  napi_value js_args_obj;
+  struct native_poll_dispatcher* dispatcher;
+  int32_t fd;
+  uint32_t events;
+  int errno_value;
 
-  status = napi_get_cb_info(env, info, &argc, NULL, NULL, (void**) &poll_handle);
+  status = poll_dispatch_require_args(env, info, &dispatcher, &js_args_obj);
   if (status != napi_ok) {
-    napi_throw_error(env, NULL, "failed to get callback info");
     return napi_helper_get_undefined(env);
   }
 
-  if (poll_handle->closed || poll_handle->close_pending) {
-    napi_throw_error(env, NULL, "poll handle already closed");
-    return napi_helper_get_undefined(env);
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "poll_dispatch_add: fd must be provided as number");
+  events = poll_dispatch_require_events(env, js_args_obj);
+
+  errno_value = poll_dispatch_ctl(dispatcher, EPOLL_CTL_ADD, fd, events);
+  if (errno_value == 0) {
+    dispatcher->registered_fds += 1;
+    poll_dispatch_update_uv_poll(dispatcher);
   }
 
-  rc = uv_poll_stop(&poll_handle->uv_poll_handle);
-  if (rc < 0) {
-    napi_throw_error(env, NULL, "uv_poll_stop failed");
+  return napi_helper_create_errno_result_asserted(env, errno_value);
+}
+
+static napi_value poll_dispatch_modify(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value js_args_obj;
+  struct native_poll_dispatcher* dispatcher;
+  int32_t fd;
+  uint32_t events;
+  int errno_value;
+
+  status = poll_dispatch_require_args(env, info, &dispatcher, &js_args_obj);
+  if (status != napi_ok) {
     return napi_helper_get_undefined(env);
   }
 
-  poll_handle->close_pending = 1;
-  napi_delete_reference(poll_handle->env, poll_handle->js_poll_callback_fn_ref);
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "poll_dispatch_modify: fd must be provided as number");
+  events = poll_dispatch_require_events(env, js_args_obj);
 
-  uv_close((uv_handle_t*) &poll_handle->uv_poll_handle, poll_handle_uv_close_cb);
+  errno_value = poll_dispatch_ctl(dispatcher, EPOLL_CTL_MOD, fd, events);
 
-  return napi_helper_get_undefined(env);
+  return napi_helper_create_errno_result_asserted(env, errno_value);
 }
 
-static void poll_handle_maybe_free(struct native_poll_handle* poll_handle) {
+static napi_value poll_dispatch_remove(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value js_args_obj;
+  struct native_poll_dispatcher* dispatcher;
+  int32_t fd;
+  int errno_value = 0;
+
+  status = poll_dispatch_require_args(env, info, &dispatcher, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
 
-  // fprintf(stderr, "poll_handle_maybe_free: poll_handle=%p, finalizer_called=%d, close_pending=%d, closed=%d\n", poll_handle, poll_handle->finalizer_called, poll_handle->close_pending, poll_handle->closed);
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "poll_dispatch_remove: fd must be provided as number");
 
-  if (!poll_handle->finalizer_called) {
-    // as long as the finalizer has not been called, we cannot free the poll handle
-    return;
+  if (epoll_ctl(dispatcher->epoll_fd, EPOLL_CTL_DEL, fd, NULL) < 0) {
+    errno_value = errno;
   }
 
-  if (poll_handle->close_pending) {
-    // edge case, where uv_close has been queued, but not yet executed
-    // meanwhile, garbage collection has kicked in
-    return;
+  // a closed fd left the set with its last reference (EBADF), but one
+  // which was never added (ENOENT) was never counted
+  if (errno_value == 0 || errno_value == EBADF) {
+    dispatcher->registered_fds -= 1;
+    poll_dispatch_update_uv_poll(dispatcher);
   }
 
-  if (!poll_handle->closed) {
-    fprintf(stderr, "poll_handle_maybe_free: poll handle not closed on garbage collection\n");
+  return napi_helper_create_errno_result_asserted(env, errno_value);
+}
 
-    poll_handle->close_pending = 1;
-    uv_close((uv_handle_t*) &poll_handle->uv_poll_handle, poll_handle_uv_close_cb);
+static void poll_dispatcher_uv_close_cb(uv_handle_t* handle) {
+  struct native_poll_dispatcher* dispatcher = (struct native_poll_dispatcher*) handle->data;
+  napi_status status;
 
-    // poll_handle_uv_close_cb will call poll_handle_maybe_free again
-    // so for now, just return
-    return;
+  status = napi_remove_async_cleanup_hook(dispatcher->cleanup_hook_handle);
+  if (status != napi_ok) {
+    abort_with_message("poll_dispatcher_uv_close_cb: failed to remove cleanup hook");
   }
 
-  // fprintf(stderr, "poll_handle_maybe_free: freeing poll handle\n");
-  free(poll_handle);
+  free(dispatcher->ready_events);
+  free(dispatcher);
 }
 
-static void poll_handle_finalizer(napi_env env, void* finalize_data, void* finalize_hint) {
-  struct native_poll_handle* poll_handle = (struct native_poll_handle*) finalize_data;
-  poll_handle->finalizer_called = 1;
-  poll_handle_maybe_free(poll_handle);
+// the dispatcher lives as long as the environment
+static void poll_dispatcher_cleanup_hook(napi_async_cleanup_hook_handle handle, void* arg) {
+  struct native_poll_dispatcher* dispatcher = (struct native_poll_dispatcher*) arg;
+
+  napi_delete_reference(dispatcher->env, dispatcher->js_callback_fn_ref);
+  napi_delete_reference(dispatcher->env, dispatcher->js_events_ref);
+
+  close(dispatcher->epoll_fd);
+  dispatcher->epoll_fd = -1;
+
+  uv_close((uv_handle_t*) &dispatcher->uv_poll_handle, poll_dispatcher_uv_close_cb);
 }
 
-static napi_value create_poller(napi_env env, napi_callback_info info) {
+static napi_value create_poll_dispatcher(napi_env env, napi_callback_info info) {
   int rc;
-  int32_t fd;
   napi_value js_args_obj;
-  napi_value js_poll_callback_fn;
-  napi_value js_poll_handle;
+  napi_value js_callback_fn;
+  napi_value js_events;
+  napi_value js_dispatcher;
   napi_status status;
+  napi_typedarray_type events_type;
+  size_t events_length;
   uv_loop_t* uv_loop;
-  struct native_poll_handle* poll_handle = NULL;
+  struct native_poll_dispatcher* dispatcher;
 
   status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
   if (status != napi_ok) {
     return napi_helper_get_undefined(env);
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "create_poller: fd must be provided as number");
-  js_poll_callback_fn = napi_helper_require_named_function_asserted(env, js_args_obj, "callback", "create_poller: callback must be provided as function");
+  js_callback_fn = napi_helper_require_named_function_asserted(env, js_args_obj, "callback", "create_poll_dispatcher: callback must be provided as function");
+
+  status = napi_get_named_property(env, js_args_obj, "events", &js_events);
+  if (status != napi_ok) {
+    abort_with_message("create_poll_dispatcher: events must be provided as Int32Array");
+  }
+
+  dispatcher = (struct native_poll_dispatcher*) calloc(1, sizeof(*dispatcher));
+  if (dispatcher == NULL) {
+    abort_with_message("failed to allocate memory for poll dispatcher");
+  }
+
+  // javascript reads the ready events directly from this array
+  status = napi_get_typedarray_info(env, js_events, &events_type, &events_length, (void**) &dispatcher->events_ptr, NULL, NULL);
+  if (status != napi_ok || events_type != napi_int32_array || events_length < POLL_DISPATCH_EVENT_STRIDE) {
+    abort_with_message("create_poll_dispatcher: events must be provided as Int32Array");
+  }
 
-  js_poll_handle = napi_helper_create_object_asserted(env);
+  dispatcher->max_events = events_length / POLL_DISPATCH_EVENT_STRIDE;
+  dispatcher->ready_events = (struct epoll_event*) calloc(dispatcher->max_events, sizeof(struct epoll_event));
+  if (dispatcher->ready_events == NULL) {
+    abort_with_message("failed to allocate memory for ready events");
+  }
 
   status = napi_get_uv_event_loop(env, &uv_loop);
   if (status != napi_ok) {
-    napi_throw_error(env, NULL, "failed to get uv event loop");
-    return napi_helper_get_undefined(env);
+    abort_with_message("failed to get uv event loop");
   }
 
-  poll_handle = (struct native_poll_handle*) calloc(1, sizeof(*poll_handle));
-  if (poll_handle == NULL) {
-    abort_with_message("failed to allocate memory for poll handle");
+  dispatcher->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (dispatcher->epoll_fd < 0) {
+    int errno_value = errno;
+    free(dispatcher->ready_events);
+    free(dispatcher);
+    return napi_helper_create_errno_result_asserted(env, errno_value);
   }
 
-  napi_helper_wrap_asserted(env, js_poll_handle, poll_handle, poll_handle_finalizer, NULL, NULL, "failed to wrap poll handle");
-
-  rc = uv_poll_init(uv_loop, &poll_handle->uv_poll_handle, fd);
+  rc = uv_poll_init(uv_loop, &dispatcher->uv_poll_handle, dispatcher->epoll_fd);
   if (rc < 0) {
     abort_with_message("uv_poll_init failed");
   }
 
-  poll_handle->fd = fd;
-  poll_handle->uv_poll_handle.data = poll_handle;
-  poll_handle->env = env;
-  poll_handle->js_poll_callback_fn_ref = napi_helper_create_reference_asserted(env, js_poll_callback_fn, 1, "failed to create reference to callback function");
+  dispatcher->uv_poll_handle.data = dispatcher;
+  dispatcher->env = env;
+  dispatcher->js_callback_fn_ref = napi_helper_create_reference_asserted(env, js_callback_fn, 1, "failed to create reference to callback function");
+  dispatcher->js_events_ref = napi_helper_create_reference_asserted(env, js_events, 1, "failed to create reference to events array");
+
+  status = napi_add_async_cleanup_hook(env, poll_dispatcher_cleanup_hook, dispatcher, &dispatcher->cleanup_hook_handle);
+  if (status != napi_ok) {
+    abort_with_message("failed to add cleanup hook for poll dispatcher");
+  }
 
-  napi_helper_add_function_field_asserted(env, js_poll_handle, "start", poll_start, poll_handle, "failed to add start function");
-  napi_helper_add_function_field_asserted(env, js_poll_handle, "stop", poll_stop, poll_handle, "failed to add stop function");
-  napi_helper_add_function_field_asserted(env, js_poll_handle, "close", poll_close, poll_handle, "failed to add close function");
+  js_dispatcher = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_dispatcher, "errno", 0);
+  napi_helper_add_function_field_asserted(env, js_dispatcher, "add", poll_dispatch_add, dispatcher, "failed to add add function");
+  napi_helper_add_function_field_asserted(env, js_dispatcher, "modify", poll_dispatch_modify, dispatcher, "failed to add modify function");
+  napi_helper_add_function_field_asserted(env, js_dispatcher, "remove", poll_dispatch_remove, dispatcher, "failed to add remove function");
 
-  return js_poll_handle;
+  return js_dispatcher;
 }
 
-napi_value do_sctp_recvv(napi_env env, napi_callback_info info) {
-  int rc;
-  int32_t fd;
-  napi_value js_args_obj;
-  napi_value js_ret_obj;
-  napi_value js_rcvinfo_obj;
-  napi_status status;
-  void* buffer_addr;
-  size_t buffer_length;
-  struct sockaddr* from_address_pointer;
-  size_t from_address_buffer_length;
-  socklen_t from_address_length_as_socklen;
-  int msg_flags = 0;
-  struct iovec iov[1];
-  const int iovcnt = sizeof(iov) / sizeof(iov[0]);
-  struct sctp_rcvinfo rcv;
-  socklen_t infolen = sizeof(rcv);
-  unsigned int info_type = 0;
+// received messages are placed back to back in a shared slab, so every
+// message is copied exactly once, from the kernel into its final buffer
+// javascript gets views into the slab, the slab is kept alive by those views
+#define RECEIVE_SLAB_SIZE (64 * 1024)
 
-  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
-  if (status != napi_ok) {
-    return napi_helper_get_undefined(env);
-  }
+// once less than this is left in the slab, a fresh slab is started
+#define RECEIVE_SLAB_MIN_FREE (4 * 1024)
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_recvv: fd must be provided as number");
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "messageBuffer", (void**) &buffer_addr, &buffer_length, "do_sctp_recvv: messageBuffer must be provided as buffer");
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", (void**) &from_address_pointer, &from_address_buffer_length, "do_sctp_recvv: sockaddr must be provided as buffer");
+// larger messages get a buffer of their own, so they neither pin a slab
+// nor leave most of one unused
+#define RECEIVE_SLAB_MAX_SHARED (RECEIVE_SLAB_SIZE / 4)
 
-  iov[0].iov_base = buffer_addr;
-  iov[0].iov_len = buffer_length;
+#define RECEIVE_SLAB_ALIGNMENT 8
 
-  from_address_length_as_socklen = from_address_buffer_length;
-  rc = sctp_recvv(fd, iov, iovcnt, from_address_pointer, &from_address_length_as_socklen, &rcv, &infolen, &info_type, &msg_flags);
-  if (rc < 0) {
-    return napi_helper_create_errno_result_asserted(env, errno);
-  }
+// set in the flags of a piece which is only a piece because the buffer it
+// was received into was too small, unlike pieces of partially delivered
+// messages, it is joined with the following ones even with partialDelivery
+// "chunks", never a kernel flag
+#define RECEIVE_FLAG_CONTINUED 0x40000000
 
-  js_ret_obj = napi_helper_create_object_asserted(env);
-  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
-  napi_helper_add_int32_field_asserted(env, js_ret_obj, "bytesReceived", rc);
-  napi_helper_add_int32_field_asserted(env, js_ret_obj, "flags", msg_flags);
+struct receive_slab {
+  napi_ref arraybuffer_ref;
+  size_t offset;
+};
 
-  switch (info_type) {
-    case SCTP_RECVV_RCVINFO: {
-      js_rcvinfo_obj = napi_helper_create_object_asserted(env);
-      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "sid", rcv.rcv_sid);
-      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "ssn", rcv.rcv_ssn);
-      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "flags", rcv.rcv_flags);
-      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "ppid", ntohl(rcv.rcv_ppid));
-      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "context", rcv.rcv_context);
+struct instance_data {
+  struct receive_slab receive_slab;
+  struct sockaddr_storage receive_from_address;
+};
 
-      napi_helper_set_named_property_asserted(env, js_ret_obj, "rcvinfo", js_rcvinfo_obj);
+struct received_message {
+  int length;
+  int msg_flags;
+  unsigned int info_type;
+  struct sctp_rcvinfo rcv;
+  const void* data;
+};
 
-      break;
-    }
-    default: {
-      // SCTP_RECVV_NOINFO
-      // and fallback
-      break;
-    }
+static struct instance_data* get_instance_data_asserted(napi_env env) {
+  napi_status status;
+  struct instance_data* instance;
+
+  status = napi_get_instance_data(env, (void**) &instance);
+  if (status != napi_ok || instance == NULL) {
+    abort_with_message("get_instance_data_asserted: failed to get instance data");
   }
 
-  return js_ret_obj;
+  return instance;
 }
 
-napi_value do_sctp_sendv(napi_env env, napi_callback_info info) {
-  int32_t fd;
-  napi_value js_args_obj;
+static void receive_slab_start_new(napi_env env, struct receive_slab* slab) {
+  napi_value js_arraybuffer;
+  void* data;
+
+  if (slab->arraybuffer_ref != NULL) {
+    napi_delete_reference(env, slab->arraybuffer_ref);
+  }
+
+  js_arraybuffer = napi_helper_create_arraybuffer_asserted(env, RECEIVE_SLAB_SIZE, &data, "receive_slab_start_new: failed to create slab");
+  slab->arraybuffer_ref = napi_helper_create_reference_asserted(env, js_arraybuffer, 1, "receive_slab_start_new: failed to create reference to slab");
+  slab->offset = 0;
+}
+
+// where the next message is received to, see receive_space_acquire()
+struct receive_space {
+  napi_value js_arraybuffer;
+  unsigned char* data;
+  size_t offset;
+  size_t length;
+  int in_slab;
+};
+
+// returns room for a message of length bytes, 0 if the length is unknown,
+// in the current slab, in a fresh one if the current one is exhausted or
+// has been detached (e.g. transferred to a worker), or in a buffer of its
+// own if the message is large
+static void receive_space_acquire(napi_env env, struct receive_slab* slab, size_t length, struct receive_space* space) {
+  napi_status status;
+  bool detached = true;
+  void* data;
+  size_t slab_length;
+  size_t needed = length > RECEIVE_SLAB_MIN_FREE ? length : RECEIVE_SLAB_MIN_FREE;
+
+  if (length > RECEIVE_SLAB_MAX_SHARED) {
+    space->js_arraybuffer = napi_helper_create_arraybuffer_asserted(env, length, &data, "receive_space_acquire: failed to create message buffer");
+    space->data = data;
+    space->offset = 0;
+    space->length = length;
+    space->in_slab = 0;
+    return;
+  }
+
+  if (slab->arraybuffer_ref != NULL) {
+    status = napi_get_reference_value(env, slab->arraybuffer_ref, &space->js_arraybuffer);
+    if (status != napi_ok) {
+      abort_with_message("receive_space_acquire: failed to get slab");
+    }
+
+    status = napi_is_detached_arraybuffer(env, space->js_arraybuffer, &detached);
+    if (status != napi_ok) {
+      abort_with_message("receive_space_acquire: failed to check slab");
+    }
+  }
+
+  if (detached || RECEIVE_SLAB_SIZE - slab->offset < needed) {
+    receive_slab_start_new(env, slab);
+
+    status = napi_get_reference_value(env, slab->arraybuffer_ref, &space->js_arraybuffer);
+    if (status != napi_ok) {
+      abort_with_message("receive_space_acquire: failed to get slab");
+    }
+  }
+
+  status = napi_get_arraybuffer_info(env, space->js_arraybuffer, &data, &slab_length);
+  if (status != napi_ok) {
+    abort_with_message("receive_space_acquire: failed to get slab info");
+  }
+
+  space->data = (unsigned char*) data + slab->offset;
+  space->offset = slab->offset;
+  space->length = slab_length - slab->offset;
+  space->in_slab = 1;
+}
+
+// returns a view of the length bytes received into space
+static napi_value receive_space_commit(napi_env env, struct receive_slab* slab, const struct receive_space* space, size_t length) {
+  napi_status status;
+  napi_value js_message;
+
+  status = napi_create_typedarray(env, napi_uint8_array, length, space->js_arraybuffer, space->offset, &js_message);
+  if (status != napi_ok) {
+    abort_with_message("receive_space_commit: failed to create message view");
+  }
+
+  if (space->in_slab) {
+    slab->offset += (length + RECEIVE_SLAB_ALIGNMENT - 1) & ~(RECEIVE_SLAB_ALIGNMENT - 1);
+    if (slab->offset > RECEIVE_SLAB_SIZE) {
+      slab->offset = RECEIVE_SLAB_SIZE;
+    }
+  }
+
+  return js_message;
+}
+
+// receives one message, or one piece of a partially delivered one, the
+// kernel tells its length up front (SIOCINQ), so it is received into a
+// buffer it fits into as a whole, and no byte is ever copied twice
+//
+// only if it arrived after the kernel was asked, it may not fit, then it
+// is received in pieces marked RECEIVE_FLAG_CONTINUED, the kernel keeps
+// the rest for the next call
+// on success, js_message is set to an exactly sized Uint8Array
+static int receive_message(napi_env env, int fd, struct received_message* message, napi_value* js_message) {
+  struct instance_data* instance = get_instance_data_asserted(env);
+  struct receive_slab* slab = &instance->receive_slab;
+  struct receive_space space;
+  struct iovec iov[1];
+  socklen_t from_length = sizeof(instance->receive_from_address);
+  socklen_t infolen = sizeof(message->rcv);
+  int pending = 0;
+
+  if (ioctl(fd, SIOCINQ, &pending) < 0 || pending < 0) {
+    pending = 0;
+  }
+
+  receive_space_acquire(env, slab, pending, &space);
+
+  iov[0].iov_base = space.data;
+  iov[0].iov_len = space.length;
+
+  // sctp_recvv() takes the recvmsg() flags in msg_flags, accepted
+  // sockets are blocking, but batches read until EAGAIN
+  message->msg_flags = MSG_DONTWAIT;
+  message->info_type = 0;
+
+  message->length = sctp_recvv(fd, iov, 1, (struct sockaddr*) &instance->receive_from_address, &from_length, &message->rcv, &infolen, &message->info_type, &message->msg_flags);
+  if (message->length < 0) {
+    return -1;
+  }
+
+  if ((message->msg_flags & MSG_EOR) == 0 && (size_t) message->length == space.length && message->length > pending) {
+    message->msg_flags |= RECEIVE_FLAG_CONTINUED;
+  }
+
+  *js_message = receive_space_commit(env, slab, &space, message->length);
+  message->data = space.data;
+
+  return 0;
+}
+
+napi_value do_sctp_recvv(napi_env env, napi_callback_info info) {
+  int rc;
+  int32_t fd;
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  napi_value js_rcvinfo_obj;
+  napi_value js_message;
+  napi_status status;
+  struct received_message message;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_recvv: fd must be provided as number");
+
+  rc = receive_message(env, fd, &message, &js_message);
+  if (rc < 0) {
+    return napi_helper_create_errno_result_asserted(env, errno);
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "bytesReceived", message.length);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "flags", message.msg_flags);
+  napi_helper_set_named_property_asserted(env, js_ret_obj, "message", js_message);
+
+  switch (message.info_type) {
+    case SCTP_RECVV_RCVINFO: {
+      js_rcvinfo_obj = napi_helper_create_object_asserted(env);
+      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "sid", message.rcv.rcv_sid);
+      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "ssn", message.rcv.rcv_ssn);
+      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "flags", message.rcv.rcv_flags);
+      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "ppid", ntohl(message.rcv.rcv_ppid));
+      napi_helper_add_uint64_field_asserted(env, js_rcvinfo_obj, "context", message.rcv.rcv_context);
+
+      napi_helper_set_named_property_asserted(env, js_ret_obj, "rcvinfo", js_rcvinfo_obj);
+
+      break;
+    }
+    default: {
+      // SCTP_RECVV_NOINFO
+      // and fallback
+      break;
+    }
+  }
+
+  return js_ret_obj;
+}
+
+// layout of one message entry in the info array returned by do_sctp_recvv_batch
+#define RECVV_BATCH_INFO_FLAGS 0
+#define RECVV_BATCH_INFO_HAS_RCVINFO 1
+#define RECVV_BATCH_INFO_SID 2
+#define RECVV_BATCH_INFO_PPID 3
+#define RECVV_BATCH_INFO_ASSOC_ID 4
+#define RECVV_BATCH_INFO_STRIDE 5
+
+// on one-to-many sockets, notifications only carry their association id
+// in the notification itself, at an offset depending on the type
+static sctp_assoc_t notification_assoc_id(const void* data, size_t length) {
+  const union sctp_notification* notification = (const union sctp_notification*) data;
+
+#define NOTIFICATION_ASSOC_ID(member, field) \
+  (length >= offsetof(union sctp_notification, member) + offsetof(typeof(notification->member), field) + sizeof(sctp_assoc_t) ? notification->member.field : 0)
+
+  if (length < sizeof(notification->sn_header)) {
+    return 0;
+  }
+
+  switch (notification->sn_header.sn_type) {
+    case SCTP_ASSOC_CHANGE:
+      return NOTIFICATION_ASSOC_ID(sn_assoc_change, sac_assoc_id);
+    case SCTP_PEER_ADDR_CHANGE:
+      return NOTIFICATION_ASSOC_ID(sn_paddr_change, spc_assoc_id);
+    case SCTP_REMOTE_ERROR:
+      return NOTIFICATION_ASSOC_ID(sn_remote_error, sre_assoc_id);
+    case SCTP_SEND_FAILED:
+      return NOTIFICATION_ASSOC_ID(sn_send_failed, ssf_assoc_id);
+    case SCTP_SHUTDOWN_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_shutdown_event, sse_assoc_id);
+    case SCTP_ADAPTATION_INDICATION:
+      return NOTIFICATION_ASSOC_ID(sn_adaptation_event, sai_assoc_id);
+    case SCTP_PARTIAL_DELIVERY_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_pdapi_event, pdapi_assoc_id);
+    case SCTP_AUTHENTICATION_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_authkey_event, auth_assoc_id);
+    case SCTP_SENDER_DRY_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_sender_dry_event, sender_dry_assoc_id);
+    case SCTP_STREAM_RESET_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_strreset_event, strreset_assoc_id);
+    case SCTP_ASSOC_RESET_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_assocreset_event, assocreset_assoc_id);
+    case SCTP_STREAM_CHANGE_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_strchange_event, strchange_assoc_id);
+    case SCTP_SEND_FAILED_EVENT:
+      return NOTIFICATION_ASSOC_ID(sn_send_failed_event, ssf_assoc_id);
+    default:
+      return 0;
+  }
+
+#undef NOTIFICATION_ASSOC_ID
+}
+
+napi_value do_sctp_recvv_batch(napi_env env, napi_callback_info info) {
+  int rc;
+  int32_t fd;
+  uint32_t max_messages;
+  uint32_t max_bytes;
+  uint32_t message_count = 0;
+  size_t bytes_received = 0;
+  int errno_value = 0;
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  napi_value js_messages;
+  napi_value js_info_arraybuffer;
+  napi_value js_info;
+  napi_status status;
+  struct received_message message;
+  uint32_t* info_ptr;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_recvv_batch: fd must be provided as number");
+  max_messages = napi_helper_require_named_uint32_asserted(env, js_args_obj, "maxMessages", "do_sctp_recvv_batch: maxMessages must be provided as number");
+  max_bytes = napi_helper_require_named_uint32_asserted(env, js_args_obj, "maxBytes", "do_sctp_recvv_batch: maxBytes must be provided as number");
+
+  if (max_messages == 0) {
+    abort_with_message("do_sctp_recvv_batch: maxMessages must be at least 1");
+  }
+
+  js_messages = napi_helper_create_array_asserted(env, "do_sctp_recvv_batch: failed to create messages array");
+  js_info_arraybuffer = napi_helper_create_arraybuffer_asserted(env, max_messages * RECVV_BATCH_INFO_STRIDE * sizeof(uint32_t), (void**) &info_ptr, "do_sctp_recvv_batch: failed to create info buffer");
+
+  // drain the socket until it would block or the budget is used up,
+  // so a busy association costs one call into native code per batch
+  while (message_count < max_messages && bytes_received < max_bytes) {
+    uint32_t* entry = info_ptr + message_count * RECVV_BATCH_INFO_STRIDE;
+    napi_value js_message;
+
+    rc = receive_message(env, fd, &message, &js_message);
+    if (rc < 0) {
+      errno_value = errno;
+      break;
+    }
+
+    napi_helper_set_element_asserted(env, js_messages, message_count, js_message, "do_sctp_recvv_batch: failed to set message element");
+
+    entry[RECVV_BATCH_INFO_FLAGS] = message.msg_flags;
+    entry[RECVV_BATCH_INFO_HAS_RCVINFO] = message.info_type == SCTP_RECVV_RCVINFO;
+    entry[RECVV_BATCH_INFO_SID] = message.info_type == SCTP_RECVV_RCVINFO ? message.rcv.rcv_sid : 0;
+    entry[RECVV_BATCH_INFO_PPID] = message.info_type == SCTP_RECVV_RCVINFO ? ntohl(message.rcv.rcv_ppid) : 0;
+    entry[RECVV_BATCH_INFO_ASSOC_ID] = message.info_type == SCTP_RECVV_RCVINFO ? message.rcv.rcv_assoc_id : 0;
+
+    if ((message.msg_flags & MSG_NOTIFICATION) != 0) {
+      entry[RECVV_BATCH_INFO_ASSOC_ID] = notification_assoc_id(message.data, message.length);
+    }
+
+    message_count += 1;
+    bytes_received += message.length;
+
+    if (message.length == 0) {
+      // end of stream, let the caller decide before reading any further,
+      // fragments of partially delivered messages are joined in javascript
+      break;
+    }
+  }
+
+  js_info = napi_helper_create_uint32_array_asserted(env, js_info_arraybuffer, message_count * RECVV_BATCH_INFO_STRIDE, "do_sctp_recvv_batch: failed to create info array");
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno_value);
+  napi_helper_set_named_property_asserted(env, js_ret_obj, "messages", js_messages);
+  napi_helper_set_named_property_asserted(env, js_ret_obj, "info", js_info);
+
+  return js_ret_obj;
+}
+
+// a message is either a single buffer or an array of buffers, the parts
+// of an array are sent as one SCTP message without concatenating them
+// returns the number of iovecs used, or -1 if they do not fit
+static int fill_message_iovec(napi_env env, napi_value js_message, struct iovec* iov, int max_iovcnt) {
+  napi_status status;
+  bool is_array;
+  int i;
+  int part_count;
+
+  status = napi_is_array(env, js_message, &is_array);
+  if (status != napi_ok) {
+    abort_with_message("fill_message_iovec: failed to check message type");
+  }
+
+  if (!is_array) {
+    if (max_iovcnt < 1) {
+      return -1;
+    }
+
+    napi_helper_require_buffer_asserted(env, js_message, &iov[0].iov_base, &iov[0].iov_len, "fill_message_iovec: message must be provided as buffer");
+    return 1;
+  }
+
+  part_count = napi_helper_require_array_length(env, js_message);
+  if (part_count > max_iovcnt) {
+    return -1;
+  }
+
+  for (i = 0; i < part_count; i += 1) {
+    napi_value js_part = napi_helper_get_element_asserted(env, js_message, i, "fill_message_iovec: failed to get message part");
+    napi_helper_require_buffer_asserted(env, js_part, &iov[i].iov_base, &iov[i].iov_len, "fill_message_iovec: message part must be provided as buffer");
+  }
+
+  return part_count;
+}
+
+napi_value do_sctp_sendv(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  napi_value js_args_obj;
+  napi_value js_message;
   napi_value js_sndinfo_obj;
   napi_value js_ret_obj;
   napi_status status;
-  void* buffer_addr;
-  size_t buffer_length;
   uint32_t flags;
   int bytes_sent;
   struct sctp_sendv_spa spa;
-  struct iovec iov[1];
-  const int iovcnt = sizeof(iov) / sizeof(iov[0]);
+  struct iovec iov[IOV_MAX];
+  int iovcnt;
 
   memset(&spa, 0, sizeof(spa));
 
@@ -737,10 +1315,16 @@ napi_value do_sctp_sendv(napi_env env, napi_callback_info info) {
   }
 
   fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_sendv: fd must be provided as number");
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "message", (void**) &buffer_addr, &buffer_length, "do_sctp_sendv: message must be provided as buffer");
 
-  iov[0].iov_base = buffer_addr;
-  iov[0].iov_len = buffer_length;
+  status = napi_helper_require_named_property(env, js_args_obj, "message", &js_message);
+  if (status != napi_ok) {
+    abort_with_message("do_sctp_sendv: message must be provided as buffer or array of buffers");
+  }
+
+  iovcnt = fill_message_iovec(env, js_message, iov, IOV_MAX);
+  if (iovcnt < 0) {
+    abort_with_message("do_sctp_sendv: message has too many parts");
+  }
 
   js_sndinfo_obj = napi_helper_require_named_object_asserted(env, js_args_obj, "sndinfo", "do_sctp_sendv: sndinfo must be provided as object");
   spa.sendv_sndinfo.snd_sid = napi_helper_require_named_uint32_asserted(env, js_sndinfo_obj, "sid", "do_sctp_sendv: sndinfo.sid must be provided as number");
@@ -765,270 +1349,3356 @@ napi_value do_sctp_sendv(napi_env env, napi_callback_info info) {
   return js_ret_obj;
 }
 
-static napi_value do_accept(napi_env env, napi_callback_info info) {
+// layout of one message entry in the info array passed to do_sctp_sendv_batch
+#define SENDV_BATCH_INFO_SID 0
+#define SENDV_BATCH_INFO_PPID 1
+#define SENDV_BATCH_INFO_FLAGS 2
+#define SENDV_BATCH_INFO_CONTEXT 3
+#define SENDV_BATCH_INFO_ASSOC_ID 4
+#define SENDV_BATCH_INFO_PR_VALUE 5
+#define SENDV_BATCH_INFO_STRIDE 6
+
+// number of messages handed to the kernel per sendmmsg() call
+#define SENDV_BATCH_CHUNK 64
+
+// iovecs shared by all messages of one sendmmsg() call
+#define SENDV_BATCH_IOV_POOL IOV_MAX
+
+union sndinfo_control {
+  char buf[CMSG_SPACE(sizeof(struct sctp_sndinfo)) + CMSG_SPACE(sizeof(struct sctp_prinfo))];
+  struct cmsghdr align;
+};
+
+// the PR-SCTP policy travels in the flags, like in sinfo_flags, and goes
+// out as SCTP_PRINFO along with the SCTP_SNDINFO, same as sctp_sendv() does
+// for SCTP_SENDV_SPA
+static void prepare_send_batch_entry(const uint32_t* info, struct iovec* iov, int iovcnt, union sndinfo_control* control, struct mmsghdr* mmsg) {
+  struct cmsghdr* cmsg;
+  struct sctp_sndinfo* sndinfo;
+  struct sctp_prinfo* prinfo;
+  uint32_t pr_policy = info[SENDV_BATCH_INFO_FLAGS] & SCTP_PR_SCTP_MASK;
+
+  memset(mmsg, 0, sizeof(*mmsg));
+  memset(control, 0, sizeof(*control));
+
+  mmsg->msg_hdr.msg_iov = iov;
+  mmsg->msg_hdr.msg_iovlen = iovcnt;
+  mmsg->msg_hdr.msg_control = control->buf;
+  mmsg->msg_hdr.msg_controllen = CMSG_SPACE(sizeof(struct sctp_sndinfo));
+
+  cmsg = CMSG_FIRSTHDR(&mmsg->msg_hdr);
+  cmsg->cmsg_level = IPPROTO_SCTP;
+  cmsg->cmsg_type = SCTP_SNDINFO;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct sctp_sndinfo));
+
+  sndinfo = (struct sctp_sndinfo*) CMSG_DATA(cmsg);
+  sndinfo->snd_sid = info[SENDV_BATCH_INFO_SID];
+  sndinfo->snd_ppid = htonl(info[SENDV_BATCH_INFO_PPID]);
+  sndinfo->snd_flags = info[SENDV_BATCH_INFO_FLAGS] & ~SCTP_PR_SCTP_MASK;
+  sndinfo->snd_context = info[SENDV_BATCH_INFO_CONTEXT];
+  sndinfo->snd_assoc_id = info[SENDV_BATCH_INFO_ASSOC_ID];
+
+  if (pr_policy == SCTP_PR_SCTP_NONE) {
+    return;
+  }
+
+  mmsg->msg_hdr.msg_controllen = sizeof(control->buf);
+
+  cmsg = CMSG_NXTHDR(&mmsg->msg_hdr, cmsg);
+  cmsg->cmsg_level = IPPROTO_SCTP;
+  cmsg->cmsg_type = SCTP_PRINFO;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct sctp_prinfo));
+
+  prinfo = (struct sctp_prinfo*) CMSG_DATA(cmsg);
+  prinfo->pr_policy = pr_policy;
+  prinfo->pr_value = info[SENDV_BATCH_INFO_PR_VALUE];
+}
+
+napi_value do_sctp_sendv_batch(napi_env env, napi_callback_info info) {
+  int rc;
   int32_t fd;
-  int32_t conn_fd;
+  uint32_t flags;
+  uint32_t message_count;
+  uint32_t messages_sent = 0;
+  int errno_value = 0;
   napi_value js_args_obj;
-  napi_status status;
+  napi_value js_messages;
+  napi_value js_info;
   napi_value js_ret_obj;
-  char address_buffer[128];
-  socklen_t address_length = sizeof(address_buffer);
-  struct sockaddr* sockaddr_ptr = NULL;
-  size_t sockaddr_length = 0;
+  napi_status status;
+  napi_typedarray_type info_type;
+  size_t info_length;
+  uint32_t* info_ptr;
+  struct iovec iov_pool[SENDV_BATCH_IOV_POOL];
+  union sndinfo_control controls[SENDV_BATCH_CHUNK];
+  struct mmsghdr mmsgs[SENDV_BATCH_CHUNK];
 
   status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
   if (status != napi_ok) {
     return napi_helper_get_undefined(env);
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_accept: fd must be provided as number");
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", (void**) &sockaddr_ptr, &sockaddr_length, "do_accept: sockaddr must be provided as buffer");
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_sendv_batch: fd must be provided as number");
+  js_messages = napi_helper_require_named_array_asserted(env, js_args_obj, "messages", "do_sctp_sendv_batch: messages must be provided as array");
+  flags = napi_helper_require_named_uint32_asserted(env, js_args_obj, "flags", "do_sctp_sendv_batch: flags must be provided as number");
 
-  address_length = sockaddr_length;
-  conn_fd = accept(fd, (struct sockaddr*) sockaddr_ptr, &address_length);
+  status = napi_get_named_property(env, js_args_obj, "info", &js_info);
+  if (status != napi_ok) {
+    abort_with_message("do_sctp_sendv_batch: info must be provided as Uint32Array");
+  }
 
-  if (conn_fd < 0) {
-    return napi_helper_create_errno_result_asserted(env, errno);
+  status = napi_get_typedarray_info(env, js_info, &info_type, &info_length, (void**) &info_ptr, NULL, NULL);
+  if (status != napi_ok || info_type != napi_uint32_array) {
+    abort_with_message("do_sctp_sendv_batch: info must be provided as Uint32Array");
+  }
+
+  message_count = napi_helper_require_array_length(env, js_messages);
+  if (info_length < (size_t) message_count * SENDV_BATCH_INFO_STRIDE) {
+    abort_with_message("do_sctp_sendv_batch: info too short for messages");
+  }
+
+  // every message carries its own SCTP_SNDINFO, the kernel treats each
+  // mmsghdr like a separate sendmsg(), so message boundaries are kept
+  while (messages_sent < message_count) {
+    uint32_t chunk_count = 0;
+    int iov_used = 0;
+
+    while (chunk_count < SENDV_BATCH_CHUNK && messages_sent + chunk_count < message_count) {
+      uint32_t index = messages_sent + chunk_count;
+      napi_value js_message = napi_helper_get_element_asserted(env, js_messages, index, "do_sctp_sendv_batch: failed to get message element");
+      int iovcnt = fill_message_iovec(env, js_message, iov_pool + iov_used, SENDV_BATCH_IOV_POOL - iov_used);
+
+      if (iovcnt < 0) {
+        if (chunk_count == 0) {
+          abort_with_message("do_sctp_sendv_batch: message has too many parts");
+        }
+
+        // send what we have, the message goes into the next round
+        break;
+      }
+
+      prepare_send_batch_entry(info_ptr + index * SENDV_BATCH_INFO_STRIDE, iov_pool + iov_used, iovcnt, &controls[chunk_count], &mmsgs[chunk_count]);
+
+      iov_used += iovcnt;
+      chunk_count += 1;
+    }
+
+    rc = sendmmsg(fd, mmsgs, chunk_count, flags | MSG_DONTWAIT);
+    if (rc < 0) {
+      errno_value = errno;
+      break;
+    }
+
+    // on a short count, the next round reports the error of the
+    // first message not sent, usually EAGAIN
+    messages_sent += rc;
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno_value);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "messagesSent", messages_sent);
+
+  return js_ret_obj;
+}
+
+// opt-in mode, where a native thread owns the sockets and does the send
+// and receive syscalls, so they run in parallel to javascript
+//
+// every association has a receive and a send ring, each with exactly
+// one producer and one consumer thread, so no locks are needed
+// ids of associations with pending work are passed through id rings,
+// the io thread is woken by an eventfd, javascript by an uv_async_t
+
+#define IO_THREAD_MAX_ASSOCIATIONS 65536
+#define IO_THREAD_MAX_READY 256
+
+// largest message received in one piece, same order as without io thread,
+// smaller rings receive in pieces of half their size
+#define IO_THREAD_MAX_MESSAGE_SIZE (128 * 1024)
+
+#define IO_RING_MIN_SIZE 4096
+
+// messages received per association before others get their turn
+#define IO_THREAD_RECEIVE_BUDGET 64
+
+#define IO_THREAD_WAKEUP_TOKEN UINT64_MAX
+
+// commands, javascript -> io thread
+#define IO_COMMAND_ATTACH 1
+#define IO_COMMAND_SEND 2
+#define IO_COMMAND_RECEIVE 4
+#define IO_COMMAND_SHUTDOWN 8
+#define IO_COMMAND_DETACH 16
+
+// notifications, io thread -> javascript
+#define IO_NOTIFY_READABLE 1
+#define IO_NOTIFY_WRITABLE 2
+#define IO_NOTIFY_DETACHED 4
+
+#define IO_THREAD_EVENT_ID 0
+#define IO_THREAD_EVENT_EVENTS 1
+#define IO_THREAD_EVENT_STRIDE 2
+
+#define IO_SHUTDOWN_NONE 0
+#define IO_SHUTDOWN_PENDING 1
+#define IO_SHUTDOWN_DONE 2
+
+#define IO_RECORD_MESSAGE 1
+#define IO_RECORD_PADDING 2
+// a message which is too large for the ring is kept in its own
+// allocation, the record only holds a pointer to it
+#define IO_RECORD_INDIRECT 3
+
+struct io_record {
+  uint32_t length;
+  uint32_t kind;
+  uint32_t flags;
+  uint32_t sid;
+  uint32_t ppid;
+  // has_rcvinfo for received messages, context for messages to send
+  uint32_t extra;
+  // PR-SCTP policy value of messages to send
+  uint32_t pr_value;
+};
+
+#define IO_RECORD_SIZE(length) ((sizeof(struct io_record) + (length) + 7) & ~((size_t) 7))
+
+// records never wrap around, the producer skips the rest of the ring
+// instead, and so does the consumer if not even a header fits there
+struct io_ring {
+  unsigned char* data;
+  size_t capacity;
+  _Atomic size_t head;
+  _Atomic size_t tail;
+};
+
+struct io_id_ring {
+  uint32_t* ids;
+  uint32_t capacity;
+  _Atomic uint32_t head;
+  _Atomic uint32_t tail;
+};
+
+struct io_association {
+  uint32_t id;
+  int fd;
+  struct io_ring receive_ring;
+  struct io_ring send_ring;
+  _Atomic uint32_t commands;
+  _Atomic uint32_t notifications;
+  _Atomic int receive_paused;
+  _Atomic int send_blocked;
+  _Atomic int error_errno;
+
+  // only used by the javascript thread
+  int detach_requested;
+
+  // only used by the io thread
+  uint32_t epoll_events;
+  int registered;
+  int want_receive;
+  int want_send;
+  int receive_done;
+  int shutdown_state;
+  int detach_pending;
+  int detached;
+  int failed;
+  struct io_association* next_detached;
+};
+
+struct io_thread {
+  uv_thread_t thread;
+  int epoll_fd;
+  int wakeup_fd;
+  _Atomic int wakeup_pending;
+  _Atomic int stop;
+  struct io_id_ring commands;
+  struct io_id_ring notifications;
+  struct io_association** associations;
+
+  // only used by the javascript thread
+  uint32_t* free_ids;
+  uint32_t free_id_count;
+  uint32_t attached;
+  uv_async_t async_handle;
+  napi_env env;
+  napi_ref js_callback_fn_ref;
+  napi_ref js_events_ref;
+  int32_t* events_ptr;
+  uint32_t max_events;
+  napi_async_cleanup_hook_handle cleanup_hook_handle;
+
+  // only used by the io thread
+  int notify_pending;
+  struct io_association* detached;
+};
+
+static size_t io_record_ring_size(const struct io_record* record) {
+  return IO_RECORD_SIZE(record->kind == IO_RECORD_INDIRECT ? sizeof(void*) : record->length);
+}
+
+static void* io_record_data(struct io_record* record) {
+  void* data;
+
+  if (record->kind != IO_RECORD_INDIRECT) {
+    return record + 1;
+  }
+
+  memcpy(&data, record + 1, sizeof(data));
+  return data;
+}
+
+// a record of up to this length always fits into the ring eventually,
+// see io_ring_reserve()
+static size_t io_ring_max_record_length(const struct io_ring* ring) {
+  size_t max_length = ring->capacity / 2 - sizeof(struct io_record);
+
+  return max_length < IO_THREAD_MAX_MESSAGE_SIZE ? max_length : IO_THREAD_MAX_MESSAGE_SIZE;
+}
+
+static int io_ring_init(struct io_ring* ring, size_t capacity) {
+  ring->data = (unsigned char*) malloc(capacity);
+  if (ring->data == NULL) {
+    return -1;
+  }
+
+  ring->capacity = capacity;
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+
+  return 0;
+}
+
+// returns space for a record with up to max_length bytes, NULL if full
+static struct io_record* io_ring_reserve(struct io_ring* ring, size_t max_length) {
+  size_t needed = IO_RECORD_SIZE(max_length);
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  size_t head = atomic_load(&ring->head);
+  size_t offset = tail & (ring->capacity - 1);
+  size_t contiguous = ring->capacity - offset;
+  size_t padding = contiguous < needed ? contiguous : 0;
+  struct io_record* record;
+
+  if (ring->capacity - (tail - head) < padding + needed) {
+    return NULL;
+  }
+
+  if (padding > 0) {
+    if (padding >= sizeof(struct io_record)) {
+      record = (struct io_record*) (ring->data + offset);
+      record->length = padding - sizeof(struct io_record);
+      record->kind = IO_RECORD_PADDING;
+    }
+
+    atomic_store(&ring->tail, tail + padding);
+    offset = 0;
+  }
+
+  return (struct io_record*) (ring->data + offset);
+}
+
+static void io_ring_commit(struct io_ring* ring, struct io_record* record, uint32_t kind) {
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+  record->kind = kind;
+  atomic_store(&ring->tail, tail + io_record_ring_size(record));
+}
+
+// returns the record at *position and moves *position past it, NULL if
+// there is none, consumed records are released with io_ring_consume()
+static struct io_record* io_ring_next(struct io_ring* ring, size_t* position) {
+  size_t tail = atomic_load(&ring->tail);
+
+  while (*position != tail) {
+    size_t offset = *position & (ring->capacity - 1);
+    size_t contiguous = ring->capacity - offset;
+    struct io_record* record;
+
+    if (contiguous < sizeof(struct io_record)) {
+      *position += contiguous;
+      continue;
+    }
+
+    record = (struct io_record*) (ring->data + offset);
+    *position += io_record_ring_size(record);
+
+    if (record->kind != IO_RECORD_PADDING) {
+      return record;
+    }
   }
 
-  js_ret_obj = napi_helper_create_object_asserted(env);
+  return NULL;
+}
+
+static void io_ring_consume(struct io_ring* ring, size_t position) {
+  atomic_store(&ring->head, position);
+}
+
+// like io_ring_consume(), and frees the messages of indirect records,
+// which own the message they refer to
+static void io_ring_consume_records(struct io_ring* ring, size_t position) {
+  size_t current = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  struct io_record* record;
+
+  while (current != position && (record = io_ring_next(ring, &current)) != NULL) {
+    if (record->kind == IO_RECORD_INDIRECT) {
+      free(io_record_data(record));
+    }
+  }
+
+  io_ring_consume(ring, position);
+}
+
+// frees the rings of an association, once no thread uses them anymore
+static void io_rings_free(struct io_ring* receive_ring, struct io_ring* send_ring) {
+  io_ring_consume_records(receive_ring, atomic_load(&receive_ring->tail));
+  io_ring_consume_records(send_ring, atomic_load(&send_ring->tail));
+
+  free(receive_ring->data);
+  free(send_ring->data);
+}
+
+static int io_ring_is_empty(struct io_ring* ring) {
+  return atomic_load(&ring->head) == atomic_load(&ring->tail);
+}
+
+// every id is at most once in an id ring, see io_thread_command()
+// and io_thread_notify(), so the ring can never overflow
+static void io_id_ring_push(struct io_id_ring* ring, uint32_t id) {
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+  ring->ids[tail & (ring->capacity - 1)] = id;
+  atomic_store(&ring->tail, tail + 1);
+}
+
+static int io_id_ring_pop(struct io_id_ring* ring, uint32_t* id) {
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+  if (head == atomic_load(&ring->tail)) {
+    return 0;
+  }
+
+  *id = ring->ids[head & (ring->capacity - 1)];
+  atomic_store(&ring->head, head + 1);
+
+  return 1;
+}
+
+// runs on the io thread
+
+static void io_thread_notify(struct io_thread* thread, struct io_association* association, uint32_t notifications) {
+  if (atomic_fetch_or(&association->notifications, notifications) == 0) {
+    io_id_ring_push(&thread->notifications, association->id);
+  }
+
+  thread->notify_pending = 1;
+}
+
+static void io_association_fail(struct io_thread* thread, struct io_association* association, int errno_value);
+
+static void io_association_update_epoll(struct io_thread* thread, struct io_association* association) {
+  struct epoll_event epoll_event;
+  uint32_t events = 0;
+  int rc;
+
+  if (association->want_receive) {
+    events |= EPOLLIN;
+  }
+
+  if (association->want_send) {
+    events |= EPOLLOUT;
+  }
+
+  if (association->registered && events == association->epoll_events) {
+    return;
+  }
+
+  // without any interest the fd leaves the set, errors and hangups
+  // would be reported anyway and keep the thread spinning
+  if (events == 0) {
+    if (association->registered) {
+      epoll_ctl(thread->epoll_fd, EPOLL_CTL_DEL, association->fd, NULL);
+      association->registered = 0;
+    }
+
+    association->epoll_events = 0;
+    return;
+  }
+
+  memset(&epoll_event, 0, sizeof(epoll_event));
+  epoll_event.events = events;
+  epoll_event.data.u64 = association->id;
+
+  rc = epoll_ctl(thread->epoll_fd, association->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, association->fd, &epoll_event);
+  if (rc < 0) {
+    // e.g. an invalid fd was attached
+    association->registered = 0;
+    io_association_fail(thread, association, errno);
+    return;
+  }
+
+  association->registered = 1;
+  association->epoll_events = events;
+}
+
+static void io_association_fail(struct io_thread* thread, struct io_association* association, int errno_value) {
+  association->failed = 1;
+  association->receive_done = 1;
+  association->want_receive = 0;
+  association->want_send = 0;
+  io_association_update_epoll(thread, association);
+
+  // reported to javascript by the next receive or send
+  atomic_store(&association->error_errno, errno_value);
+  io_thread_notify(thread, association, IO_NOTIFY_READABLE | IO_NOTIFY_WRITABLE);
+}
+
+static void io_association_finish_detach(struct io_thread* thread, struct io_association* association) {
+  association->want_receive = 0;
+  association->want_send = 0;
+  io_association_update_epoll(thread, association);
+
+  close(association->fd);
+  association->detached = 1;
+
+  // javascript may free the association as soon as it is notified,
+  // so notifications are deferred until the current round is done
+  association->next_detached = thread->detached;
+  thread->detached = association;
+}
+
+static void io_association_maybe_shutdown(struct io_thread* thread, struct io_association* association) {
+  if (association->shutdown_state != IO_SHUTDOWN_PENDING || association->failed || !io_ring_is_empty(&association->send_ring)) {
+    return;
+  }
+
+  // only once all queued messages have been handed to the kernel
+  association->shutdown_state = IO_SHUTDOWN_DONE;
+  if (shutdown(association->fd, SHUT_RDWR) < 0) {
+    io_association_fail(thread, association, errno);
+  }
+}
+
+static void io_association_receive(struct io_thread* thread, struct io_association* association) {
+  struct io_ring* ring = &association->receive_ring;
+  struct sockaddr_storage from_address;
+  struct sctp_rcvinfo rcv;
+  struct iovec iov;
+  size_t max_length = io_ring_max_record_length(ring);
+  int received = 0;
+  int budget;
+
+  for (budget = IO_THREAD_RECEIVE_BUDGET; budget > 0 && !association->receive_done; budget -= 1) {
+    socklen_t from_length = sizeof(from_address);
+    socklen_t infolen = sizeof(rcv);
+    unsigned int info_type = 0;
+    int msg_flags = MSG_DONTWAIT;
+    int pending = 0;
+    void* indirect = NULL;
+    int length;
+    struct io_record* record = io_ring_reserve(ring, max_length);
+
+    if (record == NULL) {
+      // stop reading until javascript caught up, check again after
+      // announcing it, javascript might have made room meanwhile
+      atomic_store(&association->receive_paused, 1);
+
+      record = io_ring_reserve(ring, max_length);
+      if (record == NULL) {
+        association->want_receive = 0;
+        io_association_update_epoll(thread, association);
+        break;
+      }
+
+      atomic_store(&association->receive_paused, 0);
+    }
+
+    // a message larger than a record is received into its own
+    // allocation, so it is never cut into pieces, see receive_message()
+    if (ioctl(association->fd, SIOCINQ, &pending) < 0 || pending < 0) {
+      pending = 0;
+    }
+
+    if ((size_t) pending > max_length) {
+      indirect = malloc(pending);
+    }
+
+    iov.iov_base = indirect != NULL ? indirect : (void*) (record + 1);
+    iov.iov_len = indirect != NULL ? (size_t) pending : max_length;
+
+    length = sctp_recvv(association->fd, &iov, 1, (struct sockaddr*) &from_address, &from_length, &rcv, &infolen, &info_type, &msg_flags);
+    if (length < 0) {
+      free(indirect);
+      if (errno != EAGAIN && errno != EINTR) {
+        io_association_fail(thread, association, errno);
+      }
+      break;
+    }
+
+    if ((msg_flags & MSG_EOR) == 0 && (size_t) length == iov.iov_len && length > pending) {
+      msg_flags |= RECEIVE_FLAG_CONTINUED;
+    }
+
+    record->length = length;
+    record->flags = msg_flags;
+    record->extra = info_type == SCTP_RECVV_RCVINFO;
+    record->sid = info_type == SCTP_RECVV_RCVINFO ? rcv.rcv_sid : 0;
+    record->ppid = info_type == SCTP_RECVV_RCVINFO ? ntohl(rcv.rcv_ppid) : 0;
+
+    if (indirect != NULL) {
+      memcpy(record + 1, &indirect, sizeof(indirect));
+      io_ring_commit(ring, record, IO_RECORD_INDIRECT);
+    } else {
+      io_ring_commit(ring, record, IO_RECORD_MESSAGE);
+    }
+
+    received = 1;
+
+    if (length == 0) {
+      // end of stream
+      association->receive_done = 1;
+      association->want_receive = 0;
+      io_association_update_epoll(thread, association);
+    }
+  }
+
+  if (received) {
+    io_thread_notify(thread, association, IO_NOTIFY_READABLE);
+  }
+}
+
+static void io_association_send(struct io_thread* thread, struct io_association* association) {
+  struct io_ring* ring = &association->send_ring;
+  size_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  size_t positions[SENDV_BATCH_CHUNK];
+  struct iovec iovs[SENDV_BATCH_CHUNK];
+  union sndinfo_control controls[SENDV_BATCH_CHUNK];
+  struct mmsghdr mmsgs[SENDV_BATCH_CHUNK];
+  int sent = 0;
+
+  while (!association->failed) {
+    size_t next_position = position;
+    struct io_record* record;
+    int count = 0;
+    int rc;
+
+    while (count < SENDV_BATCH_CHUNK && (record = io_ring_next(ring, &next_position)) != NULL) {
+      uint32_t info[SENDV_BATCH_INFO_STRIDE];
+
+      info[SENDV_BATCH_INFO_SID] = record->sid;
+      info[SENDV_BATCH_INFO_PPID] = record->ppid;
+      info[SENDV_BATCH_INFO_FLAGS] = record->flags;
+      info[SENDV_BATCH_INFO_CONTEXT] = record->extra;
+      info[SENDV_BATCH_INFO_ASSOC_ID] = 0;
+      info[SENDV_BATCH_INFO_PR_VALUE] = record->pr_value;
+
+      iovs[count].iov_base = io_record_data(record);
+      iovs[count].iov_len = record->length;
+      prepare_send_batch_entry(info, &iovs[count], 1, &controls[count], &mmsgs[count]);
+
+      positions[count] = next_position;
+      count += 1;
+    }
+
+    if (count == 0) {
+      break;
+    }
+
+    rc = sendmmsg(association->fd, mmsgs, count, MSG_DONTWAIT);
+    if (rc < 0) {
+      if (errno == EAGAIN) {
+        association->want_send = 1;
+        io_association_update_epoll(thread, association);
+      } else if (errno != EINTR) {
+        io_association_fail(thread, association, errno);
+      }
+      break;
+    }
+
+    position = positions[rc - 1];
+    io_ring_consume_records(ring, position);
+    sent = 1;
+  }
+
+  if (io_ring_is_empty(ring) && association->want_send) {
+    association->want_send = 0;
+    io_association_update_epoll(thread, association);
+  }
+
+  if (sent && atomic_exchange(&association->send_blocked, 0)) {
+    io_thread_notify(thread, association, IO_NOTIFY_WRITABLE);
+  }
+
+  io_association_maybe_shutdown(thread, association);
+
+  if (association->detach_pending && (association->failed || io_ring_is_empty(ring))) {
+    association->detach_pending = 0;
+    io_association_finish_detach(thread, association);
+  }
+}
+
+static void io_association_handle_commands(struct io_thread* thread, struct io_association* association, uint32_t commands) {
+  if (commands & IO_COMMAND_ATTACH) {
+    association->want_receive = 1;
+    io_association_update_epoll(thread, association);
+  }
+
+  if ((commands & IO_COMMAND_RECEIVE) && !association->receive_done) {
+    association->want_receive = 1;
+    io_association_update_epoll(thread, association);
+    io_association_receive(thread, association);
+  }
+
+  if (commands & IO_COMMAND_SHUTDOWN) {
+    association->shutdown_state = IO_SHUTDOWN_PENDING;
+  }
+
+  if (commands & IO_COMMAND_DETACH) {
+    if (association->shutdown_state == IO_SHUTDOWN_NONE) {
+      // aborted, whatever is still queued is dropped
+      io_association_finish_detach(thread, association);
+      return;
+    }
+
+    // a gracefully shut down association first sends what is queued
+    association->detach_pending = 1;
+  }
+
+  if (commands & (IO_COMMAND_SEND | IO_COMMAND_SHUTDOWN | IO_COMMAND_DETACH)) {
+    io_association_send(thread, association);
+  }
+}
+
+static void io_thread_process_commands(struct io_thread* thread) {
+  uint64_t value;
+  uint32_t id;
+
+  if (read(thread->wakeup_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+    abort_with_message("io_thread_process_commands: failed to read wakeup fd");
+  }
+
+  // from here on, javascript wakes us again for new commands
+  atomic_store(&thread->wakeup_pending, 0);
+
+  while (io_id_ring_pop(&thread->commands, &id)) {
+    struct io_association* association = thread->associations[id];
+    uint32_t commands = atomic_exchange(&association->commands, 0);
+
+    io_association_handle_commands(thread, association, commands);
+  }
+}
+
+static void io_thread_handle_ready(struct io_thread* thread, struct io_association* association, uint32_t events) {
+  if (association->detached) {
+    // detached earlier in this round
+    return;
+  }
+
+  if ((events & (EPOLLIN | EPOLLERR | EPOLLHUP)) && association->want_receive) {
+    io_association_receive(thread, association);
+  }
+
+  if ((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && association->want_send) {
+    io_association_send(thread, association);
+  }
+}
+
+static void io_thread_main(void* arg) {
+  struct io_thread* thread = (struct io_thread*) arg;
+  struct epoll_event ready_events[IO_THREAD_MAX_READY];
+
+  while (!atomic_load(&thread->stop)) {
+    int ready_count = epoll_wait(thread->epoll_fd, ready_events, IO_THREAD_MAX_READY, -1);
+    int i;
+
+    if (ready_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      abort_with_message("io_thread_main: epoll_wait failed");
+    }
+
+    for (i = 0; i < ready_count; i += 1) {
+      if (ready_events[i].data.u64 == IO_THREAD_WAKEUP_TOKEN) {
+        io_thread_process_commands(thread);
+      } else {
+        io_thread_handle_ready(thread, thread->associations[ready_events[i].data.u64], ready_events[i].events);
+      }
+    }
+
+    while (thread->detached != NULL) {
+      struct io_association* association = thread->detached;
+
+      thread->detached = association->next_detached;
+      io_thread_notify(thread, association, IO_NOTIFY_DETACHED);
+    }
+
+    if (thread->notify_pending) {
+      thread->notify_pending = 0;
+      uv_async_send(&thread->async_handle);
+    }
+  }
+}
+
+// runs on the javascript thread
+
+static void io_thread_command(struct io_thread* thread, struct io_association* association, uint32_t commands) {
+  uint64_t value = 1;
+
+  if (atomic_fetch_or(&association->commands, commands) != 0) {
+    // still queued, the io thread will pick up the new commands
+    return;
+  }
+
+  io_id_ring_push(&thread->commands, association->id);
+
+  if (atomic_exchange(&thread->wakeup_pending, 1) == 0) {
+    if (write(thread->wakeup_fd, &value, sizeof(value)) < 0) {
+      abort_with_message("io_thread_command: failed to write wakeup fd");
+    }
+  }
+}
+
+static void io_association_free(struct io_thread* thread, struct io_association* association) {
+  thread->associations[association->id] = NULL;
+  thread->free_ids[thread->free_id_count] = association->id;
+  thread->free_id_count += 1;
+
+  io_rings_free(&association->receive_ring, &association->send_ring);
+  free(association);
+
+  thread->attached -= 1;
+  if (thread->attached == 0) {
+    // an idle io thread does not keep the event loop alive
+    uv_unref((uv_handle_t*) &thread->async_handle);
+  }
+}
+
+static void io_thread_call_js(struct io_thread* thread, uint32_t event_count) {
+  napi_status status;
+  napi_value js_callback_fn;
+  napi_value js_callback_ret;
+  napi_value js_arg;
+  napi_env env = thread->env;
+
+  status = napi_get_reference_value(env, thread->js_callback_fn_ref, &js_callback_fn);
+  if (status != napi_ok) {
+    abort_with_message("io_thread_call_js: failed to get reference to callback function");
+  }
+
+  status = napi_create_uint32(env, event_count, &js_arg);
+  if (status != napi_ok) {
+    abort_with_message("io_thread_call_js: failed to create event count");
+  }
+
+  status = napi_call_function(env, napi_helper_get_undefined(env), js_callback_fn, 1, &js_arg, &js_callback_ret);
+  // javascript can no longer run while a worker is terminated
+  if (status != napi_ok && status != napi_pending_exception) {
+    abort_with_message("io_thread_call_js: failed to call callback function");
+  }
+}
+
+static void io_thread_async_cb_with_handle_scope(struct io_thread* thread) {
+  uint32_t event_count = 0;
+  uint32_t id;
+
+  while (io_id_ring_pop(&thread->notifications, &id)) {
+    struct io_association* association = thread->associations[id];
+    uint32_t notifications = atomic_exchange(&association->notifications, 0);
+    int32_t* event;
+
+    if (notifications & IO_NOTIFY_DETACHED) {
+      io_association_free(thread, association);
+      continue;
+    }
+
+    if (event_count == thread->max_events) {
+      io_thread_call_js(thread, event_count);
+      event_count = 0;
+    }
+
+    event = thread->events_ptr + event_count * IO_THREAD_EVENT_STRIDE;
+    event[IO_THREAD_EVENT_ID] = id;
+    event[IO_THREAD_EVENT_EVENTS] = notifications;
+    event_count += 1;
+  }
+
+  if (event_count > 0) {
+    io_thread_call_js(thread, event_count);
+  }
+}
+
+static void io_thread_async_cb(uv_async_t* handle) {
+  napi_handle_scope handle_scope;
+  struct io_thread* thread = (struct io_thread*) handle->data;
+
+  // we need to get a handle scope to interoperate with JavaScript
+  napi_helper_open_handle_scope_asserted(thread->env, &handle_scope);
+
+  io_thread_async_cb_with_handle_scope(thread);
+
+  napi_helper_close_handle_scope_asserted(thread->env, handle_scope);
+}
+
+static struct io_association* io_thread_require_association(napi_env env, napi_callback_info info, struct io_thread** thread, napi_value* js_args_obj) {
+  napi_status status;
+  size_t argc = 1;
+  uint32_t id;
+  struct io_association* association;
+
+  status = napi_get_cb_info(env, info, &argc, js_args_obj, NULL, (void**) thread);
+  if (status != napi_ok || argc != 1) {
+    abort_with_message("io_thread_require_association: expected exactly one argument");
+  }
+
+  id = napi_helper_require_named_uint32_asserted(env, *js_args_obj, "id", "io_thread_require_association: id must be provided as number");
+  if (id >= IO_THREAD_MAX_ASSOCIATIONS) {
+    abort_with_message("io_thread_require_association: invalid id");
+  }
+
+  association = (*thread)->associations[id];
+  if (association == NULL || association->detach_requested) {
+    abort_with_message("io_thread_require_association: association not attached");
+  }
+
+  return association;
+}
+
+static napi_value io_thread_attach(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  size_t argc = 1;
+  struct io_thread* thread;
+  struct io_association* association;
+  int32_t fd;
+  uint32_t ring_size;
+
+  status = napi_get_cb_info(env, info, &argc, &js_args_obj, NULL, (void**) &thread);
+  if (status != napi_ok || argc != 1) {
+    abort_with_message("io_thread_attach: expected exactly one argument");
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "io_thread_attach: fd must be provided as number");
+  ring_size = napi_helper_require_named_uint32_asserted(env, js_args_obj, "ringSize", "io_thread_attach: ringSize must be provided as number");
+
+  if ((ring_size & (ring_size - 1)) != 0 || ring_size < IO_RING_MIN_SIZE) {
+    abort_with_message("io_thread_attach: ringSize must be a power of two, at least 4096");
+  }
+
+  if (thread->free_id_count == 0) {
+    return napi_helper_create_errno_result_asserted(env, EMFILE);
+  }
+
+  association = (struct io_association*) calloc(1, sizeof(*association));
+  if (association == NULL) {
+    abort_with_message("failed to allocate memory for io association");
+  }
+
+  if (io_ring_init(&association->receive_ring, ring_size) < 0 || io_ring_init(&association->send_ring, ring_size) < 0) {
+    free(association->receive_ring.data);
+    free(association);
+    return napi_helper_create_errno_result_asserted(env, ENOMEM);
+  }
+
+  thread->free_id_count -= 1;
+  association->id = thread->free_ids[thread->free_id_count];
+  association->fd = fd;
+
+  thread->associations[association->id] = association;
+
+  thread->attached += 1;
+  if (thread->attached == 1) {
+    uv_ref((uv_handle_t*) &thread->async_handle);
+  }
+
+  // from here on, the io thread owns the fd
+  io_thread_command(thread, association, IO_COMMAND_ATTACH);
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "id", association->id);
+
+  return js_ret_obj;
+}
+
+static napi_value io_thread_shutdown(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  struct io_thread* thread;
+  struct io_association* association = io_thread_require_association(env, info, &thread, &js_args_obj);
+
+  io_thread_command(thread, association, IO_COMMAND_SHUTDOWN);
+
+  return napi_helper_create_errno_result_asserted(env, atomic_load(&association->error_errno));
+}
+
+static napi_value io_thread_detach(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  struct io_thread* thread;
+  struct io_association* association = io_thread_require_association(env, info, &thread, &js_args_obj);
+
+  // the io thread closes the fd, the association is freed once it
+  // reports back, see io_thread_async_cb_with_handle_scope()
+  association->detach_requested = 1;
+  io_thread_command(thread, association, IO_COMMAND_DETACH);
+
+  return napi_helper_get_undefined(env);
+}
+
+// copies a message into the receive slab, where messages received on the
+// javascript thread end up as well
+static napi_value receive_slab_copy(napi_env env, const void* data, size_t length) {
+  struct instance_data* instance = get_instance_data_asserted(env);
+  struct receive_slab* slab = &instance->receive_slab;
+  struct receive_space space;
+
+  receive_space_acquire(env, slab, length, &space);
+  memcpy(space.data, data, length);
+
+  return receive_space_commit(env, slab, &space, length);
+}
+
+// same result as do_sctp_recvv_batch, but reads from a receive ring, the
+// error is reported once all records received before it are consumed
+static napi_value io_ring_receive_batch(napi_env env, napi_value js_args_obj, struct io_ring* ring, int error_errno, uint32_t* message_count) {
+  napi_value js_ret_obj;
+  napi_value js_messages;
+  napi_value js_info_arraybuffer;
+  napi_value js_info;
+  size_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  size_t consumed = position;
+  uint32_t max_messages;
+  uint32_t max_bytes;
+  size_t bytes_received = 0;
+  int errno_value = 0;
+  uint32_t* info_ptr;
+
+  max_messages = napi_helper_require_named_uint32_asserted(env, js_args_obj, "maxMessages", "io_ring_receive_batch: maxMessages must be provided as number");
+  max_bytes = napi_helper_require_named_uint32_asserted(env, js_args_obj, "maxBytes", "io_ring_receive_batch: maxBytes must be provided as number");
+
+  if (max_messages == 0) {
+    abort_with_message("io_ring_receive_batch: maxMessages must be at least 1");
+  }
+
+  js_messages = napi_helper_create_array_asserted(env, "io_ring_receive_batch: failed to create messages array");
+  js_info_arraybuffer = napi_helper_create_arraybuffer_asserted(env, max_messages * RECVV_BATCH_INFO_STRIDE * sizeof(uint32_t), (void**) &info_ptr, "io_ring_receive_batch: failed to create info buffer");
+
+  *message_count = 0;
+
+  while (*message_count < max_messages && bytes_received < max_bytes) {
+    uint32_t* entry = info_ptr + *message_count * RECVV_BATCH_INFO_STRIDE;
+    struct io_record* record = io_ring_next(ring, &position);
+    napi_value js_message;
+
+    if (record == NULL) {
+      errno_value = error_errno != 0 ? error_errno : EAGAIN;
+      break;
+    }
+
+    js_message = receive_slab_copy(env, io_record_data(record), record->length);
+    napi_helper_set_element_asserted(env, js_messages, *message_count, js_message, "io_ring_receive_batch: failed to set message element");
+
+    entry[RECVV_BATCH_INFO_FLAGS] = record->flags;
+    entry[RECVV_BATCH_INFO_HAS_RCVINFO] = record->extra;
+    entry[RECVV_BATCH_INFO_SID] = record->sid;
+    entry[RECVV_BATCH_INFO_PPID] = record->ppid;
+    entry[RECVV_BATCH_INFO_ASSOC_ID] = 0;
+
+    consumed = position;
+    *message_count += 1;
+    bytes_received += record->length;
+
+    if (record->length == 0) {
+      break;
+    }
+  }
+
+  if (*message_count > 0) {
+    io_ring_consume_records(ring, consumed);
+  }
+
+  js_info = napi_helper_create_uint32_array_asserted(env, js_info_arraybuffer, *message_count * RECVV_BATCH_INFO_STRIDE, "io_ring_receive_batch: failed to create info array");
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno_value);
+  napi_helper_set_named_property_asserted(env, js_ret_obj, "messages", js_messages);
+  napi_helper_set_named_property_asserted(env, js_ret_obj, "info", js_info);
+
+  return js_ret_obj;
+}
+
+static napi_value io_thread_receive_batch(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  struct io_thread* thread;
+  struct io_association* association = io_thread_require_association(env, info, &thread, &js_args_obj);
+  uint32_t message_count;
+
+  // loaded first, all records received before the error are visible then
+  int error_errno = atomic_load(&association->error_errno);
+
+  js_ret_obj = io_ring_receive_batch(env, js_args_obj, &association->receive_ring, error_errno, &message_count);
+
+  if (message_count > 0 && atomic_exchange(&association->receive_paused, 0)) {
+    io_thread_command(thread, association, IO_COMMAND_RECEIVE);
+  }
+
+  return js_ret_obj;
+}
+
+static struct io_record* io_ring_reserve_send(struct io_ring* ring, _Atomic int* send_blocked, size_t length) {
+  struct io_record* record = io_ring_reserve(ring, length);
+
+  if (record != NULL) {
+    return record;
+  }
+
+  // ask for a notification, then check again, as the consumer
+  // might have made room before it saw our request
+  atomic_store(send_blocked, 1);
+
+  return io_ring_reserve(ring, length);
+}
+
+// same arguments as do_sctp_sendv_batch, copies messages into a send ring
+// and returns how many fit, *errno_value tells why the others did not
+static uint32_t io_ring_send_batch(napi_env env, napi_value js_args_obj, struct io_ring* ring, _Atomic int* send_blocked, int* errno_value) {
+  napi_status status;
+  napi_value js_messages;
+  napi_value js_info;
+  napi_typedarray_type info_type;
+  size_t info_length;
+  uint32_t* info_ptr;
+  struct iovec iov[IOV_MAX];
+  uint32_t message_count;
+  uint32_t messages_sent = 0;
+
+  js_messages = napi_helper_require_named_array_asserted(env, js_args_obj, "messages", "io_ring_send_batch: messages must be provided as array");
+
+  status = napi_get_named_property(env, js_args_obj, "info", &js_info);
+  if (status != napi_ok) {
+    abort_with_message("io_ring_send_batch: info must be provided as Uint32Array");
+  }
+
+  status = napi_get_typedarray_info(env, js_info, &info_type, &info_length, (void**) &info_ptr, NULL, NULL);
+  if (status != napi_ok || info_type != napi_uint32_array) {
+    abort_with_message("io_ring_send_batch: info must be provided as Uint32Array");
+  }
+
+  message_count = napi_helper_require_array_length(env, js_messages);
+  if (info_length < (size_t) message_count * SENDV_BATCH_INFO_STRIDE) {
+    abort_with_message("io_ring_send_batch: info too short for messages");
+  }
+
+  while (*errno_value == 0 && messages_sent < message_count) {
+    const uint32_t* entry = info_ptr + messages_sent * SENDV_BATCH_INFO_STRIDE;
+    napi_value js_message = napi_helper_get_element_asserted(env, js_messages, messages_sent, "io_ring_send_batch: failed to get message element");
+    int iovcnt = fill_message_iovec(env, js_message, iov, IOV_MAX);
+    unsigned char* data;
+    size_t length = 0;
+    struct io_record* record;
+    uint32_t kind;
+    int i;
+
+    if (iovcnt < 0) {
+      abort_with_message("io_ring_send_batch: message has too many parts");
+    }
+
+    for (i = 0; i < iovcnt; i += 1) {
+      length += iov[i].iov_len;
+    }
+
+    kind = length > io_ring_max_record_length(ring) ? IO_RECORD_INDIRECT : IO_RECORD_MESSAGE;
+
+    record = io_ring_reserve_send(ring, send_blocked, kind == IO_RECORD_INDIRECT ? sizeof(void*) : length);
+    if (record == NULL) {
+      *errno_value = EAGAIN;
+      break;
+    }
+
+    if (kind == IO_RECORD_INDIRECT) {
+      // rare case of large messages, still copied only once
+      data = (unsigned char*) malloc(length > 0 ? length : 1);
+      if (data == NULL) {
+        *errno_value = ENOMEM;
+        break;
+      }
+
+      memcpy(record + 1, &data, sizeof(data));
+    } else {
+      data = (unsigned char*) (record + 1);
+    }
+
+    for (i = 0; i < iovcnt; i += 1) {
+      memcpy(data, iov[i].iov_base, iov[i].iov_len);
+      data += iov[i].iov_len;
+    }
+
+    record->length = length;
+    record->sid = entry[SENDV_BATCH_INFO_SID];
+    record->ppid = entry[SENDV_BATCH_INFO_PPID];
+    record->flags = entry[SENDV_BATCH_INFO_FLAGS];
+    record->extra = entry[SENDV_BATCH_INFO_CONTEXT];
+    record->pr_value = entry[SENDV_BATCH_INFO_PR_VALUE];
+    io_ring_commit(ring, record, kind);
+
+    messages_sent += 1;
+  }
+
+  return messages_sent;
+}
+
+// messages count as sent once they are in the send ring
+static napi_value io_thread_send_batch(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  struct io_thread* thread;
+  struct io_association* association = io_thread_require_association(env, info, &thread, &js_args_obj);
+  int errno_value = atomic_load(&association->error_errno);
+  uint32_t messages_sent;
+
+  messages_sent = io_ring_send_batch(env, js_args_obj, &association->send_ring, &association->send_blocked, &errno_value);
+
+  if (messages_sent > 0) {
+    io_thread_command(thread, association, IO_COMMAND_SEND);
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno_value);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "messagesSent", messages_sent);
+
+  return js_ret_obj;
+}
+
+// returns 0 or the errno value, fds which were created are left to
+// io_thread_teardown_fds()
+static int io_thread_setup_fds(struct io_thread* thread) {
+  struct epoll_event wakeup_event;
+
+  thread->wakeup_fd = -1;
+
+  thread->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (thread->epoll_fd < 0) {
+    return errno;
+  }
+
+  thread->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (thread->wakeup_fd < 0) {
+    return errno;
+  }
+
+  memset(&wakeup_event, 0, sizeof(wakeup_event));
+  wakeup_event.events = EPOLLIN;
+  wakeup_event.data.u64 = IO_THREAD_WAKEUP_TOKEN;
+  if (epoll_ctl(thread->epoll_fd, EPOLL_CTL_ADD, thread->wakeup_fd, &wakeup_event) < 0) {
+    return errno;
+  }
+
+  return 0;
+}
+
+static void io_thread_teardown_fds(struct io_thread* thread) {
+  if (thread->wakeup_fd >= 0) {
+    close(thread->wakeup_fd);
+  }
+
+  if (thread->epoll_fd >= 0) {
+    close(thread->epoll_fd);
+  }
+}
+
+static void io_thread_uv_close_cb(uv_handle_t* handle) {
+  struct io_thread* thread = (struct io_thread*) handle->data;
+  napi_status status;
+
+  status = napi_remove_async_cleanup_hook(thread->cleanup_hook_handle);
+  if (status != napi_ok) {
+    abort_with_message("io_thread_uv_close_cb: failed to remove cleanup hook");
+  }
+
+  free(thread->associations);
+  free(thread->free_ids);
+  free(thread->commands.ids);
+  free(thread->notifications.ids);
+  free(thread);
+}
+
+// the io thread lives as long as the environment
+static void io_thread_cleanup_hook(napi_async_cleanup_hook_handle handle, void* arg) {
+  struct io_thread* thread = (struct io_thread*) arg;
+  uint64_t value = 1;
+  uint32_t id;
+
+  atomic_store(&thread->stop, 1);
+  if (write(thread->wakeup_fd, &value, sizeof(value)) < 0) {
+    abort_with_message("io_thread_cleanup_hook: failed to write wakeup fd");
+  }
+
+  uv_thread_join(&thread->thread);
+
+  for (id = 0; id < IO_THREAD_MAX_ASSOCIATIONS; id += 1) {
+    struct io_association* association = thread->associations[id];
+
+    if (association != NULL) {
+      // the fd is already closed, if the association was detached
+      if (!association->detached) {
+        close(association->fd);
+      }
+
+      io_rings_free(&association->receive_ring, &association->send_ring);
+      free(association);
+    }
+  }
+
+  io_thread_teardown_fds(thread);
+
+  napi_delete_reference(thread->env, thread->js_callback_fn_ref);
+  napi_delete_reference(thread->env, thread->js_events_ref);
+
+  uv_close((uv_handle_t*) &thread->async_handle, io_thread_uv_close_cb);
+}
+
+static napi_value create_io_thread(napi_env env, napi_callback_info info) {
+  int rc;
+  int errno_value;
+  uint32_t id;
+  napi_value js_args_obj;
+  napi_value js_callback_fn;
+  napi_value js_events;
+  napi_value js_io_thread;
+  napi_status status;
+  napi_typedarray_type events_type;
+  size_t events_length;
+  uv_loop_t* uv_loop;
+  struct io_thread* thread;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  js_callback_fn = napi_helper_require_named_function_asserted(env, js_args_obj, "callback", "create_io_thread: callback must be provided as function");
+
+  status = napi_get_named_property(env, js_args_obj, "events", &js_events);
+  if (status != napi_ok) {
+    abort_with_message("create_io_thread: events must be provided as Int32Array");
+  }
+
+  thread = (struct io_thread*) calloc(1, sizeof(*thread));
+  if (thread == NULL) {
+    abort_with_message("failed to allocate memory for io thread");
+  }
+
+  status = napi_get_typedarray_info(env, js_events, &events_type, &events_length, (void**) &thread->events_ptr, NULL, NULL);
+  if (status != napi_ok || events_type != napi_int32_array || events_length < IO_THREAD_EVENT_STRIDE) {
+    abort_with_message("create_io_thread: events must be provided as Int32Array");
+  }
+
+  thread->max_events = events_length / IO_THREAD_EVENT_STRIDE;
+
+  // e.g. EMFILE, reported like a missing io_uring
+  errno_value = io_thread_setup_fds(thread);
+  if (errno_value != 0) {
+    io_thread_teardown_fds(thread);
+    free(thread);
+    return napi_helper_create_errno_result_asserted(env, errno_value);
+  }
+
+  thread->associations = (struct io_association**) calloc(IO_THREAD_MAX_ASSOCIATIONS, sizeof(struct io_association*));
+  thread->free_ids = (uint32_t*) malloc(IO_THREAD_MAX_ASSOCIATIONS * sizeof(uint32_t));
+  thread->commands.ids = (uint32_t*) malloc(IO_THREAD_MAX_ASSOCIATIONS * sizeof(uint32_t));
+  thread->notifications.ids = (uint32_t*) malloc(IO_THREAD_MAX_ASSOCIATIONS * sizeof(uint32_t));
+  if (thread->associations == NULL || thread->free_ids == NULL || thread->commands.ids == NULL || thread->notifications.ids == NULL) {
+    abort_with_message("failed to allocate memory for io thread");
+  }
+
+  thread->commands.capacity = IO_THREAD_MAX_ASSOCIATIONS;
+  thread->notifications.capacity = IO_THREAD_MAX_ASSOCIATIONS;
+
+  // hand out low ids first
+  for (id = 0; id < IO_THREAD_MAX_ASSOCIATIONS; id += 1) {
+    thread->free_ids[id] = IO_THREAD_MAX_ASSOCIATIONS - 1 - id;
+  }
+  thread->free_id_count = IO_THREAD_MAX_ASSOCIATIONS;
+
+  status = napi_get_uv_event_loop(env, &uv_loop);
+  if (status != napi_ok) {
+    abort_with_message("failed to get uv event loop");
+  }
+
+  rc = uv_async_init(uv_loop, &thread->async_handle, io_thread_async_cb);
+  if (rc < 0) {
+    abort_with_message("uv_async_init failed");
+  }
+
+  thread->async_handle.data = thread;
+  uv_unref((uv_handle_t*) &thread->async_handle);
+
+  thread->env = env;
+  thread->js_callback_fn_ref = napi_helper_create_reference_asserted(env, js_callback_fn, 1, "failed to create reference to callback function");
+  thread->js_events_ref = napi_helper_create_reference_asserted(env, js_events, 1, "failed to create reference to events array");
+
+  rc = uv_thread_create(&thread->thread, io_thread_main, thread);
+  if (rc < 0) {
+    abort_with_message("uv_thread_create failed");
+  }
+
+  status = napi_add_async_cleanup_hook(env, io_thread_cleanup_hook, thread, &thread->cleanup_hook_handle);
+  if (status != napi_ok) {
+    abort_with_message("failed to add cleanup hook for io thread");
+  }
+
+  js_io_thread = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_io_thread, "errno", 0);
+  napi_helper_add_function_field_asserted(env, js_io_thread, "attach", io_thread_attach, thread, "failed to add attach function");
+  napi_helper_add_function_field_asserted(env, js_io_thread, "receive_batch", io_thread_receive_batch, thread, "failed to add receive_batch function");
+  napi_helper_add_function_field_asserted(env, js_io_thread, "send_batch", io_thread_send_batch, thread, "failed to add send_batch function");
+  napi_helper_add_function_field_asserted(env, js_io_thread, "shutdown", io_thread_shutdown, thread, "failed to add shutdown function");
+  napi_helper_add_function_field_asserted(env, js_io_thread, "detach", io_thread_detach, thread, "failed to add detach function");
+
+  return js_io_thread;
+}
+
+// io_uring backend, completion based and entirely on the javascript thread
+// associations are attached like to the io thread, but instead of a thread
+// doing the syscalls, the kernel completes receives and sends into the rings
+// every association keeps one receive in flight and at most one chain of
+// linked sends, so messages stay in order in both directions
+
+#define URING_SQ_ENTRIES 1024
+
+// completions are never dropped (IORING_FEAT_NODROP), a large completion
+// queue only avoids the slower overflow path
+#define URING_CQ_ENTRIES 8192
+
+// completions reaped and requests submitted, before javascript is called
+#define URING_REAP_ROUNDS 64
+
+// attempts to have overflowed completions flushed within one reap
+#define URING_OVERFLOW_FLUSHES 4
+
+#define URING_MAX_ASSOCIATIONS IO_THREAD_MAX_ASSOCIATIONS
+#define URING_SEND_CHAIN SENDV_BATCH_CHUNK
+
+#define URING_OP_RECEIVE 1
+#define URING_OP_SEND 2
+#define URING_OP_CANCEL 3
+
+#define URING_USER_DATA(id, op, index) (((uint64_t) (id) << 32) | ((uint64_t) (op) << 16) | (uint64_t) (index))
+
+struct uring_association {
+  uint32_t id;
+  int fd;
+  struct io_ring receive_ring;
+  struct io_ring send_ring;
+  _Atomic int send_blocked;
+  int error_errno;
+  int failed;
+  int receive_in_flight;
+  int receive_paused;
+  int receive_done;
+  int shutdown_state;
+  int detach_requested;
+  int cancelled;
+  int cancel_pending;
+  int notify_queued;
+  int sqe_wait_queued;
+  uint32_t notifications;
+
+  struct io_record* receive_record;
+  struct iovec receive_iov;
+  struct msghdr receive_msg;
+  unsigned char receive_control[CMSG_SPACE(sizeof(struct sctp_rcvinfo))];
+
+  uint32_t sends_in_flight;
+  uint32_t sends_completed;
+  uint32_t sends_succeeded;
+  int send_errno;
+  size_t send_positions[URING_SEND_CHAIN];
+  struct iovec send_iovs[URING_SEND_CHAIN];
+  union sndinfo_control send_controls[URING_SEND_CHAIN];
+  struct mmsghdr send_mmsgs[URING_SEND_CHAIN];
+};
+
+struct native_uring {
+  int ring_fd;
+  int event_fd;
+
+  void* ring_ptr;
+  size_t ring_size;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_flags;
+  unsigned* sq_array;
+  unsigned sq_entries;
+  unsigned sq_local_tail;
+  unsigned sq_submitted;
+
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_cqe* cqes;
+
+  struct uring_association** associations;
+  uint32_t* free_ids;
+  uint32_t free_id_count;
+  uint32_t attached;
+  uint32_t* notify_ids;
+  uint32_t notify_count;
+  // associations which found the submission queue full
+  uint32_t* sqe_wait_ids;
+  uint32_t sqe_wait_count;
+  // io_uring_enter() failed for good, all associations have failed
+  int error_errno;
+
+  uv_poll_t uv_poll_handle;
+  napi_env env;
+  napi_ref js_callback_fn_ref;
+  napi_ref js_events_ref;
+  int32_t* events_ptr;
+  uint32_t max_events;
+  napi_async_cleanup_hook_handle cleanup_hook_handle;
+};
+
+static int uring_probe_ops(int ring_fd) {
+  static const int required_ops[] = { IORING_OP_RECVMSG, IORING_OP_SENDMSG, IORING_OP_ASYNC_CANCEL };
+  size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+  struct io_uring_probe* probe = (struct io_uring_probe*) calloc(1, probe_size);
+  int errno_value = 0;
+  size_t i;
+
+  if (probe == NULL) {
+    abort_with_message("failed to allocate memory for io_uring probe");
+  }
+
+  if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+    errno_value = errno;
+  }
+
+  for (i = 0; errno_value == 0 && i < sizeof(required_ops) / sizeof(required_ops[0]); i += 1) {
+    int op = required_ops[i];
+
+    if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+      errno_value = ENOSYS;
+    }
+  }
+
+  free(probe);
+
+  return errno_value;
+}
+
+// returns an errno if io_uring is unavailable, e.g. ENOSYS on old kernels
+// or EPERM where it is disabled, the caller then falls back to polling
+static int uring_setup(struct native_uring* uring) {
+  struct io_uring_params params;
+  int errno_value;
+
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = URING_CQ_ENTRIES;
+
+  uring->ring_fd = syscall(__NR_io_uring_setup, URING_SQ_ENTRIES, &params);
+  if (uring->ring_fd < 0) {
+    return errno;
+  }
+
+  if ((params.features & (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP)) != (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP)) {
+    return ENOSYS;
+  }
+
+  errno_value = uring_probe_ops(uring->ring_fd);
+  if (errno_value != 0) {
+    return errno_value;
+  }
+
+  uring->ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  if (params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe) > uring->ring_size) {
+    uring->ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  }
+
+  uring->ring_ptr = mmap(NULL, uring->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQ_RING);
+  if (uring->ring_ptr == MAP_FAILED) {
+    uring->ring_ptr = NULL;
+    return errno;
+  }
+
+  uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  uring->sqes = (struct io_uring_sqe*) mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQES);
+  if (uring->sqes == MAP_FAILED) {
+    uring->sqes = NULL;
+    return errno;
+  }
+
+  uring->sq_head = (unsigned*) ((char*) uring->ring_ptr + params.sq_off.head);
+  uring->sq_tail = (unsigned*) ((char*) uring->ring_ptr + params.sq_off.tail);
+  uring->sq_mask = (unsigned*) ((char*) uring->ring_ptr + params.sq_off.ring_mask);
+  uring->sq_flags = (unsigned*) ((char*) uring->ring_ptr + params.sq_off.flags);
+  uring->sq_array = (unsigned*) ((char*) uring->ring_ptr + params.sq_off.array);
+  uring->sq_entries = params.sq_entries;
+  uring->sq_local_tail = *uring->sq_tail;
+  uring->sq_submitted = uring->sq_local_tail;
+
+  uring->cq_head = (unsigned*) ((char*) uring->ring_ptr + params.cq_off.head);
+  uring->cq_tail = (unsigned*) ((char*) uring->ring_ptr + params.cq_off.tail);
+  uring->cq_mask = (unsigned*) ((char*) uring->ring_ptr + params.cq_off.ring_mask);
+  uring->cqes = (struct io_uring_cqe*) ((char*) uring->ring_ptr + params.cq_off.cqes);
+
+  // completions are signalled through an eventfd, which libuv polls
+  uring->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (uring->event_fd < 0) {
+    return errno;
+  }
+
+  if (syscall(__NR_io_uring_register, uring->ring_fd, IORING_REGISTER_EVENTFD, &uring->event_fd, 1) < 0) {
+    return errno;
+  }
+
+  return 0;
+}
+
+static void uring_teardown(struct native_uring* uring) {
+  if (uring->sqes != NULL) {
+    munmap(uring->sqes, uring->sqes_size);
+  }
+
+  if (uring->ring_ptr != NULL) {
+    munmap(uring->ring_ptr, uring->ring_size);
+  }
+
+  if (uring->event_fd >= 0) {
+    close(uring->event_fd);
+  }
+
+  if (uring->ring_fd >= 0) {
+    close(uring->ring_fd);
+  }
+}
+
+static void uring_association_fail(struct native_uring* uring, struct uring_association* association, int errno_value);
+
+static void uring_fail_all(struct native_uring* uring, int errno_value) {
+  uint32_t id;
+
+  uring->error_errno = errno_value;
+
+  for (id = 0; id < URING_MAX_ASSOCIATIONS; id += 1) {
+    if (uring->associations[id] != NULL) {
+      uring_association_fail(uring, uring->associations[id], errno_value);
+    }
+  }
+}
+
+static void uring_submit(struct native_uring* uring) {
+  __atomic_store_n(uring->sq_tail, uring->sq_local_tail, __ATOMIC_RELEASE);
+
+  while (uring->error_errno == 0 && uring->sq_submitted != uring->sq_local_tail) {
+    int rc = syscall(__NR_io_uring_enter, uring->ring_fd, uring->sq_local_tail - uring->sq_submitted, 0, 0, NULL, 0);
+
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+
+    if (rc == 0 || (rc < 0 && (errno == EAGAIN || errno == EBUSY))) {
+      // submitted again after the next completions were reaped
+      return;
+    }
+
+    if (rc < 0) {
+      uring_fail_all(uring, errno);
+      return;
+    }
+
+    uring->sq_submitted += rc;
+  }
+}
+
+static unsigned uring_sq_space(struct native_uring* uring) {
+  return uring->sq_entries - (uring->sq_local_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE));
+}
+
+// makes sure count entries can be queued without submitting in between,
+// which would end a chain of linked sends early
+static unsigned uring_reserve_sqes(struct native_uring* uring, unsigned count) {
+  unsigned space = uring_sq_space(uring);
+
+  if (space < count) {
+    uring_submit(uring);
+    space = uring_sq_space(uring);
+  }
+
+  return space < count ? space : count;
+}
+
+// the caller tries again after the next reap, see uring_wait_for_sqes()
+static void uring_wait_for_sqes(struct native_uring* uring, struct uring_association* association) {
+  if (!association->sqe_wait_queued) {
+    association->sqe_wait_queued = 1;
+    uring->sqe_wait_ids[uring->sqe_wait_count] = association->id;
+    uring->sqe_wait_count += 1;
+  }
+}
+
+// returns NULL, like EAGAIN, if the submission queue is still full
+// after submitting what is queued
+static struct io_uring_sqe* uring_next_sqe(struct native_uring* uring, uint8_t opcode, int fd, uint64_t user_data) {
+  unsigned index;
+  struct io_uring_sqe* sqe;
+
+  if (uring_reserve_sqes(uring, 1) == 0) {
+    return NULL;
+  }
+
+  index = uring->sq_local_tail & *uring->sq_mask;
+  sqe = &uring->sqes[index];
+
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->user_data = user_data;
+
+  uring->sq_array[index] = index;
+  uring->sq_local_tail += 1;
+
+  return sqe;
+}
+
+static void uring_notify(struct native_uring* uring, struct uring_association* association, uint32_t notifications) {
+  association->notifications |= notifications;
+
+  if (!association->notify_queued) {
+    association->notify_queued = 1;
+    uring->notify_ids[uring->notify_count] = association->id;
+    uring->notify_count += 1;
+  }
+}
+
+static void uring_association_fail(struct native_uring* uring, struct uring_association* association, int errno_value) {
+  if (association->failed) {
+    return;
+  }
+
+  association->failed = 1;
+  association->receive_done = 1;
+
+  // reported to javascript by the next receive or send
+  association->error_errno = errno_value;
+  uring_notify(uring, association, IO_NOTIFY_READABLE | IO_NOTIFY_WRITABLE);
+}
+
+static void uring_association_arm_receive(struct native_uring* uring, struct uring_association* association) {
+  struct io_uring_sqe* sqe;
+
+  if (association->receive_in_flight || association->receive_done || association->detach_requested) {
+    return;
+  }
+
+  association->receive_record = io_ring_reserve(&association->receive_ring, io_ring_max_record_length(&association->receive_ring));
+  if (association->receive_record == NULL) {
+    // armed again once javascript made room
+    association->receive_paused = 1;
+    return;
+  }
+
+  association->receive_iov.iov_base = association->receive_record + 1;
+  association->receive_iov.iov_len = io_ring_max_record_length(&association->receive_ring);
+
+  memset(&association->receive_msg, 0, sizeof(association->receive_msg));
+  association->receive_msg.msg_iov = &association->receive_iov;
+  association->receive_msg.msg_iovlen = 1;
+  association->receive_msg.msg_control = association->receive_control;
+  association->receive_msg.msg_controllen = sizeof(association->receive_control);
+
+  sqe = uring_next_sqe(uring, IORING_OP_RECVMSG, association->fd, URING_USER_DATA(association->id, URING_OP_RECEIVE, 0));
+  if (sqe == NULL) {
+    uring_wait_for_sqes(uring, association);
+    return;
+  }
+
+  sqe->addr = (uintptr_t) &association->receive_msg;
+  sqe->len = 1;
+
+  association->receive_in_flight = 1;
+}
+
+static void uring_association_submit_sends(struct native_uring* uring, struct uring_association* association) {
+  struct io_ring* ring = &association->send_ring;
+  size_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  struct io_record* record;
+  uint32_t count = 0;
+  uint32_t i;
+
+  if (association->sends_in_flight > 0 || association->failed || association->cancelled) {
+    return;
+  }
+
+  while (count < URING_SEND_CHAIN && (record = io_ring_next(ring, &position)) != NULL) {
+    uint32_t info[SENDV_BATCH_INFO_STRIDE];
+
+    info[SENDV_BATCH_INFO_SID] = record->sid;
+    info[SENDV_BATCH_INFO_PPID] = record->ppid;
+    info[SENDV_BATCH_INFO_FLAGS] = record->flags;
+    info[SENDV_BATCH_INFO_CONTEXT] = record->extra;
+    info[SENDV_BATCH_INFO_ASSOC_ID] = 0;
+    info[SENDV_BATCH_INFO_PR_VALUE] = record->pr_value;
+
+    association->send_iovs[count].iov_base = io_record_data(record);
+    association->send_iovs[count].iov_len = record->length;
+    prepare_send_batch_entry(info, &association->send_iovs[count], 1, &association->send_controls[count], &association->send_mmsgs[count]);
+
+    association->send_positions[count] = position;
+    count += 1;
+  }
+
+  if (count == 0) {
+    return;
+  }
+
+  count = uring_reserve_sqes(uring, count);
+  if (count == 0) {
+    uring_wait_for_sqes(uring, association);
+    return;
+  }
+
+  // linked, so every send starts once the one before completed
+  for (i = 0; i < count; i += 1) {
+    struct io_uring_sqe* sqe = uring_next_sqe(uring, IORING_OP_SENDMSG, association->fd, URING_USER_DATA(association->id, URING_OP_SEND, i));
+
+    sqe->addr = (uintptr_t) &association->send_mmsgs[i].msg_hdr;
+    sqe->len = 1;
+
+    if (i + 1 < count) {
+      sqe->flags = IOSQE_IO_LINK;
+    }
+  }
+
+  association->sends_in_flight = count;
+  association->sends_completed = 0;
+  association->sends_succeeded = 0;
+  association->send_errno = 0;
+}
+
+static void uring_association_maybe_shutdown(struct native_uring* uring, struct uring_association* association) {
+  if (association->shutdown_state != IO_SHUTDOWN_PENDING || association->failed) {
+    return;
+  }
+
+  if (association->sends_in_flight > 0 || !io_ring_is_empty(&association->send_ring)) {
+    return;
+  }
+
+  // only once all queued messages have been handed to the kernel
+  association->shutdown_state = IO_SHUTDOWN_DONE;
+  if (shutdown(association->fd, SHUT_RDWR) < 0) {
+    uring_association_fail(uring, association, errno);
+  }
+}
+
+static void uring_association_free(struct native_uring* uring, struct uring_association* association) {
+  uring->associations[association->id] = NULL;
+  uring->free_ids[uring->free_id_count] = association->id;
+  uring->free_id_count += 1;
+
+  io_rings_free(&association->receive_ring, &association->send_ring);
+  free(association);
+
+  uring->attached -= 1;
+  if (uring->attached == 0) {
+    // an idle io_uring does not keep the event loop alive
+    uv_poll_stop(&uring->uv_poll_handle);
+  }
+}
+
+static int uring_association_cancel_request(struct native_uring* uring, struct uring_association* association, uint64_t user_data) {
+  struct io_uring_sqe* sqe;
+
+  sqe = uring_next_sqe(uring, IORING_OP_ASYNC_CANCEL, -1, URING_USER_DATA(association->id, URING_OP_CANCEL, 0));
+  if (sqe == NULL) {
+    return -1;
+  }
+
+  sqe->addr = user_data;
+  return 0;
+}
+
+// cancels whatever is in flight, all of it again if the submission queue
+// was full, cancelling a request which already completed does no harm
+static void uring_association_cancel(struct native_uring* uring, struct uring_association* association) {
+  int rc = 0;
+  uint32_t i;
+
+  association->cancelled = 1;
+  association->cancel_pending = 0;
+
+  if (association->receive_in_flight) {
+    rc = uring_association_cancel_request(uring, association, URING_USER_DATA(association->id, URING_OP_RECEIVE, 0));
+  }
+
+  for (i = association->sends_completed; rc == 0 && i < association->sends_in_flight; i += 1) {
+    rc = uring_association_cancel_request(uring, association, URING_USER_DATA(association->id, URING_OP_SEND, i));
+  }
+
+  if (rc < 0) {
+    association->cancel_pending = 1;
+    uring_wait_for_sqes(uring, association);
+  }
+}
+
+// a detached association is freed, and its fd closed, once the kernel
+// no longer refers to its buffers
+static void uring_association_maybe_release(struct native_uring* uring, struct uring_association* association) {
+  if (!association->detach_requested) {
+    return;
+  }
+
+  if (!association->cancelled) {
+    // a gracefully shut down association first sends what is queued
+    if (association->shutdown_state != IO_SHUTDOWN_NONE && !association->failed && (association->sends_in_flight > 0 || !io_ring_is_empty(&association->send_ring))) {
+      return;
+    }
+
+    uring_association_cancel(uring, association);
+  }
+
+  if (association->receive_in_flight || association->sends_in_flight > 0) {
+    return;
+  }
+
+  close(association->fd);
+  uring_association_free(uring, association);
+}
+
+static void uring_association_received(struct native_uring* uring, struct uring_association* association, int32_t result) {
+  struct io_record* record = association->receive_record;
+  struct cmsghdr* cmsg;
+
+  association->receive_in_flight = 0;
+
+  if (association->detach_requested) {
+    uring_association_maybe_release(uring, association);
+    return;
+  }
+
+  if (result < 0) {
+    if (result == -EINTR || result == -EAGAIN) {
+      uring_association_arm_receive(uring, association);
+    } else {
+      uring_association_fail(uring, association, -result);
+    }
+    return;
+  }
+
+  record->length = result;
+  record->flags = association->receive_msg.msg_flags;
+  record->extra = 0;
+
+  // the kernel can't be asked for the length of the message before the
+  // receive is queued, so a message larger than a record is cut, its
+  // pieces are joined again by the message assembler, see receive_message()
+  if ((record->flags & MSG_EOR) == 0 && (size_t) result == association->receive_iov.iov_len) {
+    record->flags |= RECEIVE_FLAG_CONTINUED;
+  }
+  record->sid = 0;
+  record->ppid = 0;
+
+  for (cmsg = CMSG_FIRSTHDR(&association->receive_msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&association->receive_msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_SCTP && cmsg->cmsg_type == SCTP_RCVINFO) {
+      struct sctp_rcvinfo rcv;
+
+      memcpy(&rcv, CMSG_DATA(cmsg), sizeof(rcv));
+      record->extra = 1;
+      record->sid = rcv.rcv_sid;
+      record->ppid = ntohl(rcv.rcv_ppid);
+    }
+  }
+
+  io_ring_commit(&association->receive_ring, record, IO_RECORD_MESSAGE);
+  uring_notify(uring, association, IO_NOTIFY_READABLE);
+
+  if (result == 0) {
+    // end of stream
+    association->receive_done = 1;
+    return;
+  }
+
+  uring_association_arm_receive(uring, association);
+}
+
+static void uring_association_sent(struct native_uring* uring, struct uring_association* association, int32_t result) {
+  // completions of linked sends arrive in order, after a failed send
+  // the rest of the chain completes with ECANCELED
+  association->sends_completed += 1;
+
+  if (result < 0 && association->send_errno == 0) {
+    association->send_errno = -result;
+  } else if (result >= 0 && association->send_errno == 0) {
+    association->sends_succeeded += 1;
+  }
+
+  if (association->sends_completed < association->sends_in_flight) {
+    return;
+  }
+
+  association->sends_in_flight = 0;
+
+  if (association->sends_succeeded > 0) {
+    io_ring_consume_records(&association->send_ring, association->send_positions[association->sends_succeeded - 1]);
+
+    if (atomic_exchange(&association->send_blocked, 0)) {
+      uring_notify(uring, association, IO_NOTIFY_WRITABLE);
+    }
+  }
+
+  if (association->cancelled) {
+    uring_association_maybe_release(uring, association);
+    return;
+  }
+
+  if (association->send_errno != 0 && association->send_errno != EINTR && association->send_errno != EAGAIN) {
+    uring_association_fail(uring, association, association->send_errno);
+  } else {
+    uring_association_submit_sends(uring, association);
+  }
+
+  uring_association_maybe_shutdown(uring, association);
+  uring_association_maybe_release(uring, association);
+}
+
+static void uring_handle_completion(struct native_uring* uring, uint64_t user_data, int32_t result) {
+  uint32_t id = user_data >> 32;
+  uint32_t op = (user_data >> 16) & 0xffff;
+  struct uring_association* association;
+
+  if (op == URING_OP_CANCEL) {
+    // the cancelled request completes on its own
+    return;
+  }
+
+  association = uring->associations[id];
+  if (association == NULL) {
+    abort_with_message("uring_handle_completion: completion for unknown association");
+  }
+
+  if (op == URING_OP_RECEIVE) {
+    uring_association_received(uring, association, result);
+  } else {
+    uring_association_sent(uring, association, result);
+  }
+}
+
+static uint32_t uring_reap(struct native_uring* uring) {
+  unsigned head = *uring->cq_head;
+  uint32_t reaped = 0;
+  uint32_t overflow_flushes = 0;
+
+  for (;;) {
+    unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+    struct io_uring_cqe* cqe;
+    uint64_t user_data;
+    int32_t result;
+
+    if (head == tail) {
+      if ((__atomic_load_n(uring->sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) == 0 || overflow_flushes == URING_OVERFLOW_FLUSHES || uring->error_errno != 0) {
+        break;
+      }
+
+      // completions the queue had no room for are flushed by the kernel,
+      // what is left over is flushed by a later reap
+      overflow_flushes += 1;
+      if (syscall(__NR_io_uring_enter, uring->ring_fd, 0, 0, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        uring_fail_all(uring, errno);
+        break;
+      }
+
+      continue;
+    }
+
+    cqe = &uring->cqes[head & *uring->cq_mask];
+    user_data = cqe->user_data;
+    result = cqe->res;
+
+    head += 1;
+    __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+
+    uring_handle_completion(uring, user_data, result);
+    reaped += 1;
+  }
+
+  return reaped;
+}
+
+// associations which found the submission queue full try again, once
+// reaped completions made room
+static void uring_retry_sqe_waiters(struct native_uring* uring) {
+  uint32_t count = uring->sqe_wait_count;
+  uint32_t i;
+
+  // an association queued again overwrites an entry already handled,
+  // the ones still to handle are queued and can't be queued again
+  uring->sqe_wait_count = 0;
+
+  for (i = 0; i < count; i += 1) {
+    struct uring_association* association = uring->associations[uring->sqe_wait_ids[i]];
+
+    // freed meanwhile, or the id was queued again by a new association
+    if (association == NULL || !association->sqe_wait_queued) {
+      continue;
+    }
+
+    association->sqe_wait_queued = 0;
+
+    if (association->cancel_pending) {
+      uring_association_cancel(uring, association);
+      continue;
+    }
+
+    uring_association_arm_receive(uring, association);
+    uring_association_submit_sends(uring, association);
+  }
+}
+
+static void uring_call_js(struct native_uring* uring, uint32_t event_count) {
+  napi_status status;
+  napi_value js_callback_fn;
+  napi_value js_callback_ret;
+  napi_value js_arg;
+  napi_env env = uring->env;
+
+  status = napi_get_reference_value(env, uring->js_callback_fn_ref, &js_callback_fn);
+  if (status != napi_ok) {
+    abort_with_message("uring_call_js: failed to get reference to callback function");
+  }
+
+  status = napi_create_uint32(env, event_count, &js_arg);
+  if (status != napi_ok) {
+    abort_with_message("uring_call_js: failed to create event count");
+  }
+
+  status = napi_call_function(env, napi_helper_get_undefined(env), js_callback_fn, 1, &js_arg, &js_callback_ret);
+  // javascript can no longer run while a worker is terminated
+  if (status != napi_ok && status != napi_pending_exception) {
+    abort_with_message("uring_call_js: failed to call callback function");
+  }
+}
+
+static void uring_poll_cb_with_handle_scope(struct native_uring* uring) {
+  uint32_t event_count = 0;
+  uint32_t rounds = URING_REAP_ROUNDS;
+  uint32_t reaped;
+  uint64_t value;
+  uint32_t i;
+
+  if (read(uring->event_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+    abort_with_message("uring_poll_cb_with_handle_scope: failed to read eventfd");
+  }
+
+  // receives armed again and follow up sends go out in one syscall, they
+  // often complete right away, e.g. for already queued messages, and are
+  // then reaped in this callback already
+  do {
+    reaped = uring_reap(uring);
+    uring_retry_sqe_waiters(uring);
+    uring_submit(uring);
+    rounds -= 1;
+  } while (reaped > 0 && rounds > 0);
+
+  for (i = 0; i < uring->notify_count; i += 1) {
+    struct uring_association* association = uring->associations[uring->notify_ids[i]];
+    int32_t* event;
+
+    // freed meanwhile, or the id was queued again by a new association
+    if (association == NULL || !association->notify_queued) {
+      continue;
+    }
+
+    if (event_count == uring->max_events) {
+      uring_call_js(uring, event_count);
+      event_count = 0;
+    }
+
+    event = uring->events_ptr + event_count * IO_THREAD_EVENT_STRIDE;
+    event[IO_THREAD_EVENT_ID] = association->id;
+    event[IO_THREAD_EVENT_EVENTS] = association->notifications;
+    event_count += 1;
+
+    association->notify_queued = 0;
+    association->notifications = 0;
+  }
+
+  uring->notify_count = 0;
+
+  if (event_count > 0) {
+    uring_call_js(uring, event_count);
+  }
+}
+
+static void uring_poll_cb(uv_poll_t* handle, int uv_status, int events) {
+  napi_handle_scope handle_scope;
+  struct native_uring* uring = (struct native_uring*) handle->data;
+
+  // we need to get a handle scope to interoperate with JavaScript
+  napi_helper_open_handle_scope_asserted(uring->env, &handle_scope);
+
+  uring_poll_cb_with_handle_scope(uring);
+
+  napi_helper_close_handle_scope_asserted(uring->env, handle_scope);
+}
+
+static struct uring_association* uring_require_association(napi_env env, napi_callback_info info, struct native_uring** uring, napi_value* js_args_obj) {
+  napi_status status;
+  size_t argc = 1;
+  uint32_t id;
+  struct uring_association* association;
+
+  status = napi_get_cb_info(env, info, &argc, js_args_obj, NULL, (void**) uring);
+  if (status != napi_ok || argc != 1) {
+    abort_with_message("uring_require_association: expected exactly one argument");
+  }
+
+  id = napi_helper_require_named_uint32_asserted(env, *js_args_obj, "id", "uring_require_association: id must be provided as number");
+  if (id >= URING_MAX_ASSOCIATIONS) {
+    abort_with_message("uring_require_association: invalid id");
+  }
+
+  association = (*uring)->associations[id];
+  if (association == NULL || association->detach_requested) {
+    abort_with_message("uring_require_association: association not attached");
+  }
+
+  return association;
+}
+
+static napi_value uring_attach(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  size_t argc = 1;
+  struct native_uring* uring;
+  struct uring_association* association;
+  int32_t fd;
+  uint32_t ring_size;
+  int rc;
+
+  status = napi_get_cb_info(env, info, &argc, &js_args_obj, NULL, (void**) &uring);
+  if (status != napi_ok || argc != 1) {
+    abort_with_message("uring_attach: expected exactly one argument");
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "uring_attach: fd must be provided as number");
+  ring_size = napi_helper_require_named_uint32_asserted(env, js_args_obj, "ringSize", "uring_attach: ringSize must be provided as number");
+
+  if ((ring_size & (ring_size - 1)) != 0 || ring_size < IO_RING_MIN_SIZE) {
+    abort_with_message("uring_attach: ringSize must be a power of two, at least 4096");
+  }
+
+  if (uring->error_errno != 0) {
+    return napi_helper_create_errno_result_asserted(env, uring->error_errno);
+  }
+
+  if (uring->free_id_count == 0) {
+    return napi_helper_create_errno_result_asserted(env, EMFILE);
+  }
+
+  association = (struct uring_association*) calloc(1, sizeof(*association));
+  if (association == NULL) {
+    abort_with_message("failed to allocate memory for io_uring association");
+  }
+
+  if (io_ring_init(&association->receive_ring, ring_size) < 0 || io_ring_init(&association->send_ring, ring_size) < 0) {
+    free(association->receive_ring.data);
+    free(association);
+    return napi_helper_create_errno_result_asserted(env, ENOMEM);
+  }
+
+  uring->free_id_count -= 1;
+  association->id = uring->free_ids[uring->free_id_count];
+  association->fd = fd;
+
+  uring->associations[association->id] = association;
+
+  uring->attached += 1;
+  if (uring->attached == 1) {
+    rc = uv_poll_start(&uring->uv_poll_handle, UV_READABLE, uring_poll_cb);
+    if (rc < 0) {
+      abort_with_message("uring_attach: uv_poll_start failed");
+    }
+  }
+
+  // from here on, the association owns the fd
+  uring_association_arm_receive(uring, association);
+  uring_submit(uring);
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "id", association->id);
+
+  return js_ret_obj;
+}
+
+static napi_value uring_receive_batch(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  struct native_uring* uring;
+  struct uring_association* association = uring_require_association(env, info, &uring, &js_args_obj);
+  uint32_t message_count;
+
+  js_ret_obj = io_ring_receive_batch(env, js_args_obj, &association->receive_ring, association->error_errno, &message_count);
+
+  if (message_count > 0 && association->receive_paused) {
+    association->receive_paused = 0;
+    uring_association_arm_receive(uring, association);
+    uring_submit(uring);
+  }
+
+  return js_ret_obj;
+}
+
+// messages count as sent once they are in the send ring
+static napi_value uring_send_batch(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  struct native_uring* uring;
+  struct uring_association* association = uring_require_association(env, info, &uring, &js_args_obj);
+  int errno_value = association->error_errno;
+  uint32_t messages_sent;
+
+  messages_sent = io_ring_send_batch(env, js_args_obj, &association->send_ring, &association->send_blocked, &errno_value);
+
+  if (messages_sent > 0) {
+    uring_association_submit_sends(uring, association);
+    uring_submit(uring);
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno_value);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "messagesSent", messages_sent);
+
+  return js_ret_obj;
+}
+
+static napi_value uring_shutdown(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  struct native_uring* uring;
+  struct uring_association* association = uring_require_association(env, info, &uring, &js_args_obj);
+
+  if (association->shutdown_state == IO_SHUTDOWN_NONE) {
+    association->shutdown_state = IO_SHUTDOWN_PENDING;
+  }
+
+  uring_association_maybe_shutdown(uring, association);
+
+  return napi_helper_create_errno_result_asserted(env, association->error_errno);
+}
+
+static napi_value uring_detach(napi_env env, napi_callback_info info) {
+  napi_value js_args_obj;
+  struct native_uring* uring;
+  struct uring_association* association = uring_require_association(env, info, &uring, &js_args_obj);
+
+  // without a graceful shutdown, whatever is still queued is dropped
+  association->detach_requested = 1;
+  if (association->shutdown_state == IO_SHUTDOWN_NONE) {
+    uring_association_cancel(uring, association);
+  }
+
+  uring_association_maybe_release(uring, association);
+  uring_submit(uring);
+
+  return napi_helper_get_undefined(env);
+}
+
+static void uring_uv_close_cb(uv_handle_t* handle) {
+  struct native_uring* uring = (struct native_uring*) handle->data;
+  napi_status status;
+
+  status = napi_remove_async_cleanup_hook(uring->cleanup_hook_handle);
+  if (status != napi_ok) {
+    abort_with_message("uring_uv_close_cb: failed to remove cleanup hook");
+  }
+
+  free(uring->associations);
+  free(uring->free_ids);
+  free(uring->notify_ids);
+  free(uring->sqe_wait_ids);
+  free(uring);
+}
+
+// the io_uring lives as long as the environment, requests still in flight
+// are cancelled and waited for, before their buffers are freed
+static void uring_cleanup_hook(napi_async_cleanup_hook_handle handle, void* arg) {
+  struct native_uring* uring = (struct native_uring*) arg;
+  uint32_t id;
+
+  for (id = 0; id < URING_MAX_ASSOCIATIONS; id += 1) {
+    struct uring_association* association = uring->associations[id];
+
+    if (association != NULL) {
+      association->detach_requested = 1;
+      if (!association->cancelled) {
+        uring_association_cancel(uring, association);
+      }
+
+      uring_association_maybe_release(uring, association);
+    }
+  }
+
+  uring_submit(uring);
+
+  // associations of a failed io_uring are leaked, the kernel might
+  // still refer to their buffers
+  while (uring->attached > 0 && uring->error_errno == 0) {
+    if (syscall(__NR_io_uring_enter, uring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) {
+      uring_fail_all(uring, errno);
+      break;
+    }
+
+    uring_reap(uring);
+    uring_retry_sqe_waiters(uring);
+    uring_submit(uring);
+  }
+
+  napi_delete_reference(uring->env, uring->js_callback_fn_ref);
+  napi_delete_reference(uring->env, uring->js_events_ref);
+
+  uring_teardown(uring);
+
+  uv_close((uv_handle_t*) &uring->uv_poll_handle, uring_uv_close_cb);
+}
+
+static napi_value create_io_uring(napi_env env, napi_callback_info info) {
+  int rc;
+  int errno_value;
+  uint32_t id;
+  napi_value js_args_obj;
+  napi_value js_callback_fn;
+  napi_value js_events;
+  napi_value js_uring;
+  napi_status status;
+  napi_typedarray_type events_type;
+  size_t events_length;
+  uv_loop_t* uv_loop;
+  struct native_uring* uring;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  js_callback_fn = napi_helper_require_named_function_asserted(env, js_args_obj, "callback", "create_io_uring: callback must be provided as function");
+
+  status = napi_get_named_property(env, js_args_obj, "events", &js_events);
+  if (status != napi_ok) {
+    abort_with_message("create_io_uring: events must be provided as Int32Array");
+  }
+
+  uring = (struct native_uring*) calloc(1, sizeof(*uring));
+  if (uring == NULL) {
+    abort_with_message("failed to allocate memory for io_uring");
+  }
+
+  status = napi_get_typedarray_info(env, js_events, &events_type, &events_length, (void**) &uring->events_ptr, NULL, NULL);
+  if (status != napi_ok || events_type != napi_int32_array || events_length < IO_THREAD_EVENT_STRIDE) {
+    abort_with_message("create_io_uring: events must be provided as Int32Array");
+  }
+
+  uring->max_events = events_length / IO_THREAD_EVENT_STRIDE;
+  uring->ring_fd = -1;
+  uring->event_fd = -1;
+
+  errno_value = uring_setup(uring);
+  if (errno_value != 0) {
+    uring_teardown(uring);
+    free(uring);
+    return napi_helper_create_errno_result_asserted(env, errno_value);
+  }
+
+  uring->associations = (struct uring_association**) calloc(URING_MAX_ASSOCIATIONS, sizeof(struct uring_association*));
+  uring->free_ids = (uint32_t*) malloc(URING_MAX_ASSOCIATIONS * sizeof(uint32_t));
+  uring->notify_ids = (uint32_t*) malloc(URING_MAX_ASSOCIATIONS * sizeof(uint32_t));
+  uring->sqe_wait_ids = (uint32_t*) malloc(URING_MAX_ASSOCIATIONS * sizeof(uint32_t));
+  if (uring->associations == NULL || uring->free_ids == NULL || uring->notify_ids == NULL || uring->sqe_wait_ids == NULL) {
+    abort_with_message("failed to allocate memory for io_uring");
+  }
+
+  // hand out low ids first
+  for (id = 0; id < URING_MAX_ASSOCIATIONS; id += 1) {
+    uring->free_ids[id] = URING_MAX_ASSOCIATIONS - 1 - id;
+  }
+  uring->free_id_count = URING_MAX_ASSOCIATIONS;
+
+  status = napi_get_uv_event_loop(env, &uv_loop);
+  if (status != napi_ok) {
+    abort_with_message("failed to get uv event loop");
+  }
+
+  rc = uv_poll_init(uv_loop, &uring->uv_poll_handle, uring->event_fd);
+  if (rc < 0) {
+    abort_with_message("uv_poll_init failed");
+  }
+
+  uring->uv_poll_handle.data = uring;
+  uring->env = env;
+  uring->js_callback_fn_ref = napi_helper_create_reference_asserted(env, js_callback_fn, 1, "failed to create reference to callback function");
+  uring->js_events_ref = napi_helper_create_reference_asserted(env, js_events, 1, "failed to create reference to events array");
+
+  status = napi_add_async_cleanup_hook(env, uring_cleanup_hook, uring, &uring->cleanup_hook_handle);
+  if (status != napi_ok) {
+    abort_with_message("failed to add cleanup hook for io_uring");
+  }
+
+  js_uring = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_uring, "errno", 0);
+  napi_helper_add_function_field_asserted(env, js_uring, "attach", uring_attach, uring, "failed to add attach function");
+  napi_helper_add_function_field_asserted(env, js_uring, "receive_batch", uring_receive_batch, uring, "failed to add receive_batch function");
+  napi_helper_add_function_field_asserted(env, js_uring, "send_batch", uring_send_batch, uring, "failed to add send_batch function");
+  napi_helper_add_function_field_asserted(env, js_uring, "shutdown", uring_shutdown, uring, "failed to add shutdown function");
+  napi_helper_add_function_field_asserted(env, js_uring, "detach", uring_detach, uring, "failed to add detach function");
+
+  return js_uring;
+}
+
+static napi_value do_accept(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  int32_t conn_fd;
+  napi_value js_args_obj;
+  napi_status status;
+  napi_value js_ret_obj;
+  char address_buffer[128];
+  socklen_t address_length = sizeof(address_buffer);
+  struct sockaddr* sockaddr_ptr = NULL;
+  size_t sockaddr_length = 0;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_accept: fd must be provided as number");
+  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", (void**) &sockaddr_ptr, &sockaddr_length, "do_accept: sockaddr must be provided as buffer");
+
+  address_length = sockaddr_length;
+  conn_fd = accept4(fd, (struct sockaddr*) sockaddr_ptr, &address_length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+  if (conn_fd < 0) {
+    return napi_helper_create_errno_result_asserted(env, errno);
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "fd", conn_fd);
+
+  return js_ret_obj;
+}
+
+// accepts until the backlog is empty or all fds slots are used, so an
+// accept storm costs one call into native code per batch, new sockets are
+// non-blocking and close-on-exec right away
+// fds is an Int32Array, the peer address of fds[i] is written to sockaddrs
+// at offset i * sockaddrLength
+static napi_value do_accept_batch(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  uint32_t sockaddr_stride;
+  uint32_t max_connections;
+  uint32_t connection_count = 0;
+  int errno_value = 0;
+  napi_value js_args_obj;
+  napi_value js_fds;
+  napi_value js_ret_obj;
+  napi_status status;
+  napi_typedarray_type fds_type;
+  size_t fds_length;
+  int32_t* fds_ptr;
+  char* sockaddrs_ptr;
+  size_t sockaddrs_length;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_accept_batch: fd must be provided as number");
+  sockaddr_stride = napi_helper_require_named_uint32_asserted(env, js_args_obj, "sockaddrLength", "do_accept_batch: sockaddrLength must be provided as number");
+  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddrs", (void**) &sockaddrs_ptr, &sockaddrs_length, "do_accept_batch: sockaddrs must be provided as buffer");
+
+  status = napi_get_named_property(env, js_args_obj, "fds", &js_fds);
+  if (status != napi_ok) {
+    abort_with_message("do_accept_batch: fds must be provided as Int32Array");
+  }
+
+  status = napi_get_typedarray_info(env, js_fds, &fds_type, &fds_length, (void**) &fds_ptr, NULL, NULL);
+  if (status != napi_ok || fds_type != napi_int32_array) {
+    abort_with_message("do_accept_batch: fds must be provided as Int32Array");
+  }
+
+  if (sockaddr_stride == 0 || sockaddrs_length < fds_length * sockaddr_stride) {
+    abort_with_message("do_accept_batch: sockaddrs too short for fds");
+  }
+
+  max_connections = fds_length;
+
+  while (connection_count < max_connections) {
+    socklen_t address_length = sockaddr_stride;
+    struct sockaddr* address = (struct sockaddr*) (sockaddrs_ptr + (size_t) connection_count * sockaddr_stride);
+    int conn_fd;
+
+    memset(address, 0, sockaddr_stride);
+
+    conn_fd = accept4(fd, address, &address_length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (conn_fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      // ECONNABORTED only concerns a connection which is gone already
+      if (errno == ECONNABORTED) {
+        continue;
+      }
+
+      errno_value = errno;
+      break;
+    }
+
+    fds_ptr[connection_count] = conn_fd;
+    connection_count += 1;
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno_value);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "connectionCount", connection_count);
+
+  return js_ret_obj;
+}
+
+// branches an association of a one-to-many socket off into its own
+// one-to-one socket, from then on it is no longer seen on the original one
+static napi_value do_sctp_peeloff(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  int32_t assoc_id;
+  int peeled_fd;
+  napi_value js_args_obj;
+  napi_status status;
+  napi_value js_ret_obj;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_peeloff: fd must be provided as number");
+  assoc_id = napi_helper_require_named_int32_asserted(env, js_args_obj, "assocId", "do_sctp_peeloff: assocId must be provided as number");
+
+  peeled_fd = sctp_peeloff(fd, assoc_id);
+  if (peeled_fd < 0) {
+    return napi_helper_create_errno_result_asserted(env, errno);
+  }
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
+  napi_helper_add_int32_field_asserted(env, js_ret_obj, "fd", peeled_fd);
+
+  return js_ret_obj;
+}
+
+static napi_value do_listen(napi_env env, napi_callback_info info) {
+  int rc;
+  int32_t fd;
+  int32_t backlog;
+  napi_value js_args_obj;
+  napi_status status;
+  int errno_value;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_listen: fd must be provided as number");
+  backlog = napi_helper_require_named_int32_asserted(env, js_args_obj, "backlog", "do_listen: backlog must be provided as number");
+
+  rc = listen(fd, backlog);
+
+  if (rc != 0) {
+    errno_value = errno;
+  } else {
+    errno_value = 0;
+  }
+
+  return napi_helper_create_errno_result_asserted(env, errno_value);
+}
+
+static napi_value do_sctp_connectx(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  int rc;
+
+  void* addrs_ptr = NULL;
+
+  napi_value js_args_obj;
+  napi_value js_address_list;
+
+  int address_count;
+  int errno_value;
+
+  napi_helper_require_args_asserted(env, info, 1, &js_args_obj, "do_sctp_connectx requires exactly one argument");
+  js_address_list = napi_helper_require_named_array_asserted(env, js_args_obj, "sockaddrs", "do_sctp_connectx: sockaddrs must be provided as array");
+
+  address_count = napi_helper_require_array_length(env, js_address_list);
+
+  addrs_ptr = alloc_and_fill_sockaddr_list(env, js_address_list);
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_connectx: fd must be provided as number");
+
+  rc = sctp_connectx(fd, addrs_ptr, address_count, NULL);
+
+  if (rc != 0) {
+    errno_value = errno;
+  } else {
+    errno_value = 0;
+  }
+
+  free(addrs_ptr);
+
+  return napi_helper_create_errno_result_asserted(env, errno_value);
+}
+
+napi_value get_socket_error(napi_env env, napi_callback_info info) {
+  int rc;
+  int err;
+  int32_t fd;
+  napi_value js_args_obj;
+  napi_value js_ret_obj;
+  napi_status status;
+  socklen_t err_length = sizeof(err);
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "get_socket_error: fd must be provided as number");
+
+  rc = getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_length);
+
+  js_ret_obj = napi_helper_create_object_asserted(env);
+
+  if (rc != 0) {
+    napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno);
+  } else {
+    napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
+    napi_helper_add_int32_field_asserted(env, js_ret_obj, "socketError", err);
+  }
+
+  return js_ret_obj;
+}
+
+napi_value do_getsockname(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  napi_value js_args_obj;
+  napi_status status;
+  struct sockaddr* sockaddr_ptr;
+  size_t sockaddr_length;
+  socklen_t sockaddr_length_as_socklen;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_getsockname: fd must be provided as number");
+  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", &sockaddr_ptr, &sockaddr_length, "do_getsockname: failed to get sockaddr buffer");
+
+  sockaddr_length_as_socklen = sockaddr_length;
+
+  errno = 0;
+  getsockname(fd, sockaddr_ptr, &sockaddr_length_as_socklen);
+
+  return napi_helper_create_errno_result_asserted(env, errno);
+}
+
+static napi_value create_buffer_array_from_dynamic_sockaddr_array(napi_env env, struct sockaddr* addrs, int num_addrs) {
+  int i;
+  napi_value js_buffer_array;
+  struct sockaddr* current_addr = addrs;
+
+  js_buffer_array = napi_helper_create_array_asserted(env, "create_buffer_array_from_dynamic_sockaddr_array: failed to create buffer array");
+
+  for(i = 0; i < num_addrs; i += 1) {
+    napi_value js_buffer;
+    size_t addr_length;
+
+    switch(current_addr->sa_family) {
+      case AF_INET: {
+        addr_length = sizeof(struct sockaddr_in);
+        break;
+      }
+      default: {
+        abort_with_message("create_buffer_array_from_dynamic_sockaddr_array: unsupported address family");
+        break;
+      }
+    }
+
+    js_buffer = napi_helper_create_buffer_copy_asserted(env, current_addr, addr_length, "create_buffer_array_from_dynamic_sockaddr_array: failed to create buffer");
+    napi_helper_set_element_asserted(env, js_buffer_array, i, js_buffer, "create_buffer_array_from_dynamic_sockaddr_array: failed to set buffer element");
+
+    current_addr = (struct sockaddr*) ((void*) current_addr + addr_length);
+  }
+
+  return js_buffer_array;
+}
+
+static napi_value do_sctp_getladdrs(napi_env env, napi_callback_info info) {
+  int num_addrs;
+  int32_t fd;
+  napi_value js_args_obj;
+  napi_status status;
+  struct sockaddr* addrs;
+  napi_value js_result;
+  napi_value js_addrs_array;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_getladdrs: fd must be provided as number");
+
+  num_addrs = sctp_getladdrs(fd, 0, &addrs);
+  if (num_addrs < 0) {
+    return napi_helper_create_errno_result_asserted(env, errno);
+  }
+
+  js_result = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_result, "errno", 0);
+
+  js_addrs_array = create_buffer_array_from_dynamic_sockaddr_array(env, addrs, num_addrs);
+  napi_helper_set_named_property_asserted(env, js_result, "sockaddrs", js_addrs_array);
+
+  sctp_freeladdrs(addrs);
+
+  return js_result;
+}
+
+napi_value do_getpeername(napi_env env, napi_callback_info info) {
+  int32_t fd;
+  napi_value js_args_obj;
+  napi_status status;
+  struct sockaddr* sockaddr_ptr;
+  size_t sockaddr_length;
+  socklen_t sockaddr_length_as_socklen;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_getpeername: fd must be provided as number");
+  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", &sockaddr_ptr, &sockaddr_length, "do_getpeername: failed to get sockaddr buffer");
+
+  sockaddr_length_as_socklen = sockaddr_length;
+
+  errno = 0;
+  getpeername(fd, sockaddr_ptr, &sockaddr_length_as_socklen);
+
+  return napi_helper_create_errno_result_asserted(env, errno);
+}
+
+static napi_value do_sctp_getpaddrs(napi_env env, napi_callback_info info) {
+  int num_addrs;
+  int32_t fd;
+  int32_t assoc_id;
+  napi_value js_args_obj;
+  napi_status status;
+  struct sockaddr* addrs;
+  napi_value js_result;
+  napi_value js_addrs_array;
+
+  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  if (status != napi_ok) {
+    return napi_helper_get_undefined(env);
+  }
+
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_getpaddrs: fd must be provided as number");
+  assoc_id = napi_helper_require_named_int32_asserted(env, js_args_obj, "assocId", "do_sctp_getpaddrs: assocId must be provided as number");
+
+  num_addrs = sctp_getpaddrs(fd, assoc_id, &addrs);
+  if (num_addrs < 0) {
+    return napi_helper_create_errno_result_asserted(env, errno);
+  }
+
+  js_result = napi_helper_create_object_asserted(env);
+  napi_helper_add_int32_field_asserted(env, js_result, "errno", 0);
+
+  js_addrs_array = create_buffer_array_from_dynamic_sockaddr_array(env, addrs, num_addrs);
+  napi_helper_set_named_property_asserted(env, js_result, "sockaddrs", js_addrs_array);
+
+  sctp_freepaddrs(addrs);
+
+  return js_result;
+}
+
+// length of one entry of the packed address lists of sctp_getladdrs() and
+// sctp_getpaddrs(), 0 for families which are not supported
+static size_t sockaddr_length_of_family(const struct sockaddr* addr) {
+  switch(addr->sa_family) {
+    case AF_INET: {
+      return sizeof(struct sockaddr_in);
+    }
+    case AF_INET6: {
+      return sizeof(struct sockaddr_in6);
+    }
+    default: {
+      return 0;
+    }
+  }
+}
+
+static napi_value create_string_from_sockaddr(napi_env env, const struct sockaddr* addr) {
+  napi_value js_string;
+  napi_status status;
+  char text[INET6_ADDRSTRLEN];
+  const char* formatted;
+
+  if (addr->sa_family == AF_INET) {
+    formatted = inet_ntop(AF_INET, &((const struct sockaddr_in*) addr)->sin_addr, text, sizeof(text));
+  } else if (addr->sa_family == AF_INET6) {
+    formatted = inet_ntop(AF_INET6, &((const struct sockaddr_in6*) addr)->sin6_addr, text, sizeof(text));
+  } else {
+    abort_with_message("create_string_from_sockaddr: unsupported address family");
+  }
+
+  if (formatted == NULL) {
+    abort_with_message("create_string_from_sockaddr: inet_ntop failed");
+  }
+
+  status = napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &js_string);
+  if (status != napi_ok) {
+    abort_with_message("create_string_from_sockaddr: failed to create string");
+  }
+
+  return js_string;
+}
+
+static napi_value create_string_array_from_dynamic_sockaddr_array(napi_env env, struct sockaddr* addrs, int num_addrs) {
+  int i;
+  napi_value js_string_array;
+  struct sockaddr* current_addr = addrs;
+
+  js_string_array = napi_helper_create_array_asserted(env, "create_string_array_from_dynamic_sockaddr_array: failed to create array");
+
+  for(i = 0; i < num_addrs; i += 1) {
+    size_t addr_length = sockaddr_length_of_family(current_addr);
+    if (addr_length == 0) {
+      abort_with_message("create_string_array_from_dynamic_sockaddr_array: unsupported address family");
+    }
+
+    napi_helper_set_element_asserted(env, js_string_array, i, create_string_from_sockaddr(env, current_addr), "create_string_array_from_dynamic_sockaddr_array: failed to set element");
+
+    current_addr = (struct sockaddr*) ((void*) current_addr + addr_length);
+  }
+
+  return js_string_array;
+}
+
+// path info of every remote address, undefined for an address whose info
+// can't be retrieved, e.g. because it was just removed
+static napi_value create_peer_info_array_from_dynamic_sockaddr_array(napi_env env, int32_t fd, int32_t assoc_id, struct sockaddr* addrs, int num_addrs) {
+  int i;
+  int rc;
+  napi_value js_info_array;
+  struct sockaddr* current_addr = addrs;
+
+  js_info_array = napi_helper_create_array_asserted(env, "create_peer_info_array_from_dynamic_sockaddr_array: failed to create array");
+
+  for(i = 0; i < num_addrs; i += 1) {
+    napi_value js_info;
+    struct sctp_paddrinfo spinfo = {0};
+    socklen_t spinfo_len = sizeof(spinfo);
+    size_t addr_length = sockaddr_length_of_family(current_addr);
+
+    if (addr_length == 0) {
+      abort_with_message("create_peer_info_array_from_dynamic_sockaddr_array: unsupported address family");
+    }
+
+    spinfo.spinfo_assoc_id = assoc_id;
+    memcpy(&spinfo.spinfo_address, current_addr, addr_length);
+
+    rc = getsockopt(fd, IPPROTO_SCTP, SCTP_GET_PEER_ADDR_INFO, &spinfo, &spinfo_len);
+    if (rc < 0 || spinfo_len < sizeof(spinfo)) {
+      js_info = napi_helper_get_undefined(env);
+    } else {
+      js_info = napi_helper_create_object_asserted(env);
+      napi_helper_add_int32_field_asserted(env, js_info, "state", spinfo.spinfo_state);
+      napi_helper_add_uint32_field_asserted(env, js_info, "cwnd", spinfo.spinfo_cwnd);
+      napi_helper_add_uint32_field_asserted(env, js_info, "srtt", spinfo.spinfo_srtt);
+      napi_helper_add_uint32_field_asserted(env, js_info, "rto", spinfo.spinfo_rto);
+      napi_helper_add_uint32_field_asserted(env, js_info, "mtu", spinfo.spinfo_mtu);
+    }
+
+    napi_helper_set_element_asserted(env, js_info_array, i, js_info, "create_peer_info_array_from_dynamic_sockaddr_array: failed to set element");
+
+    current_addr = (struct sockaddr*) ((void*) current_addr + addr_length);
+  }
+
+  return js_info_array;
+}
+
+static napi_value create_snapshot_error_result(napi_env env, int errno_value, const char* operation) {
+  napi_value js_result;
 
-  napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
-  napi_helper_add_int32_field_asserted(env, js_ret_obj, "fd", conn_fd);
+  js_result = napi_helper_create_errno_result_asserted(env, errno_value);
+  napi_helper_add_string_field_asserted(env, js_result, "operation", operation);
 
-  return js_ret_obj;
+  return js_result;
 }
 
-static napi_value do_listen(napi_env env, napi_callback_info info) {
-  int rc;
-  int32_t fd;
-  int32_t backlog;
-  napi_value js_args_obj;
-  napi_status status;
-  int errno_value;
+// adds localFamily, localAddress, localPort and localAddresses,
+// returns the errno result of the failed call, or NULL
+static napi_value add_snapshot_local_fields(napi_env env, napi_value js_result, int32_t fd) {
+  int num_addrs;
+  struct sockaddr* addrs;
+  struct sockaddr_storage primary = {0};
+  socklen_t primary_length = sizeof(primary);
 
-  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
-  if (status != napi_ok) {
-    return napi_helper_get_undefined(env);
+  if (getsockname(fd, (struct sockaddr*) &primary, &primary_length) < 0) {
+    return create_snapshot_error_result(env, errno, "getsockname()");
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_listen: fd must be provided as number");
-  backlog = napi_helper_require_named_int32_asserted(env, js_args_obj, "backlog", "do_listen: backlog must be provided as number");
-
-  rc = listen(fd, backlog);
+  num_addrs = sctp_getladdrs(fd, 0, &addrs);
+  if (num_addrs < 0) {
+    return create_snapshot_error_result(env, errno, "sctp_getladdrs()");
+  }
 
-  if (rc != 0) {
-    errno_value = errno;
+  if (primary.ss_family == AF_INET) {
+    napi_helper_add_string_field_asserted(env, js_result, "localFamily", "IPv4");
+    napi_helper_add_int32_field_asserted(env, js_result, "localPort", ntohs(((struct sockaddr_in*) &primary)->sin_port));
   } else {
-    errno_value = 0;
+    napi_helper_add_string_field_asserted(env, js_result, "localFamily", "IPv6");
+    napi_helper_add_int32_field_asserted(env, js_result, "localPort", ntohs(((struct sockaddr_in6*) &primary)->sin6_port));
   }
 
-  return napi_helper_create_errno_result_asserted(env, errno_value);
-}
-
-static napi_value do_sctp_connectx(napi_env env, napi_callback_info info) {
-  int32_t fd;
-  int rc;
-
-  void* addrs_ptr = NULL;
+  napi_helper_set_named_property_asserted(env, js_result, "localAddress", create_string_from_sockaddr(env, (struct sockaddr*) &primary));
+  napi_helper_set_named_property_asserted(env, js_result, "localAddresses", create_string_array_from_dynamic_sockaddr_array(env, addrs, num_addrs));
 
-  napi_value js_args_obj;
-  napi_value js_address_list;
+  sctp_freeladdrs(addrs);
 
-  int address_count;
-  int errno_value;
+  return NULL;
+}
 
-  napi_helper_require_args_asserted(env, info, 1, &js_args_obj, "do_sctp_connectx requires exactly one argument");
-  js_address_list = napi_helper_require_named_array_asserted(env, js_args_obj, "sockaddrs", "do_sctp_connectx: sockaddrs must be provided as array");
+// adds remoteAddress, remoteAddresses and optionally peerInfo, all left
+// out if the association is not (or no longer) established,
+// returns the errno result of the failed call, or NULL
+static napi_value add_snapshot_remote_fields(napi_env env, napi_value js_result, int32_t fd, int32_t assoc_id, int with_peer_info) {
+  int num_addrs;
+  struct sockaddr* addrs;
+  struct sockaddr_storage primary = {0};
+  socklen_t primary_length = sizeof(primary);
 
-  address_count = napi_helper_require_array_length(env, js_address_list);
+  if (getpeername(fd, (struct sockaddr*) &primary, &primary_length) < 0) {
+    if (errno != ENOTCONN) {
+      return create_snapshot_error_result(env, errno, "getpeername()");
+    }
+  } else {
+    napi_helper_set_named_property_asserted(env, js_result, "remoteAddress", create_string_from_sockaddr(env, (struct sockaddr*) &primary));
+  }
 
-  addrs_ptr = alloc_and_fill_sockaddr_list(env, js_address_list);
+  num_addrs = sctp_getpaddrs(fd, assoc_id, &addrs);
+  if (num_addrs < 0) {
+    if (errno != ENOTCONN && errno != EINVAL) {
+      return create_snapshot_error_result(env, errno, "sctp_getpaddrs()");
+    }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_connectx: fd must be provided as number");
+    return NULL;
+  }
 
-  rc = sctp_connectx(fd, addrs_ptr, address_count, NULL);
+  napi_helper_set_named_property_asserted(env, js_result, "remoteAddresses", create_string_array_from_dynamic_sockaddr_array(env, addrs, num_addrs));
 
-  if (rc != 0) {
-    errno_value = errno;
-  } else {
-    errno_value = 0;
+  if (with_peer_info) {
+    napi_helper_set_named_property_asserted(env, js_result, "peerInfo", create_peer_info_array_from_dynamic_sockaddr_array(env, fd, assoc_id, addrs, num_addrs));
   }
 
-  free(addrs_ptr);
+  sctp_freepaddrs(addrs);
 
-  return napi_helper_create_errno_result_asserted(env, errno_value);
+  return NULL;
 }
 
-napi_value get_socket_error(napi_env env, napi_callback_info info) {
-  int rc;
-  int err;
+// gathers the addresses of an association, and with withPeerInfo the path
+// info of every remote address, in one call, addresses come formatted
+static napi_value snapshot_association(napi_env env, napi_callback_info info) {
   int32_t fd;
+  int32_t assoc_id;
+  int with_local;
+  int with_peer_info;
   napi_value js_args_obj;
-  napi_value js_ret_obj;
   napi_status status;
-  socklen_t err_length = sizeof(err);
+  napi_value js_result;
+  napi_value js_error_result;
 
   status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
   if (status != napi_ok) {
     return napi_helper_get_undefined(env);
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "get_socket_error: fd must be provided as number");
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "snapshot_association: fd must be provided as number");
+  assoc_id = napi_helper_require_named_int32_asserted(env, js_args_obj, "assocId", "snapshot_association: assocId must be provided as number");
+  with_local = napi_helper_require_named_bool_asserted(env, js_args_obj, "withLocal");
+  with_peer_info = napi_helper_require_named_bool_asserted(env, js_args_obj, "withPeerInfo");
 
-  rc = getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_length);
+  js_result = napi_helper_create_errno_result_asserted(env, 0);
 
-  js_ret_obj = napi_helper_create_object_asserted(env);
+  if (with_local) {
+    js_error_result = add_snapshot_local_fields(env, js_result, fd);
+    if (js_error_result != NULL) {
+      return js_error_result;
+    }
+  }
 
-  if (rc != 0) {
-    napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", errno);
-  } else {
-    napi_helper_add_int32_field_asserted(env, js_ret_obj, "errno", 0);
-    napi_helper_add_int32_field_asserted(env, js_ret_obj, "socketError", err);
+  js_error_result = add_snapshot_remote_fields(env, js_result, fd, assoc_id, with_peer_info);
+  if (js_error_result != NULL) {
+    return js_error_result;
   }
 
-  return js_ret_obj;
+  return js_result;
 }
 
-napi_value do_getsockname(napi_env env, napi_callback_info info) {
-  int32_t fd;
-  napi_value js_args_obj;
+// association stats are written into a Float64Array of ASSOC_STATS_FIELDS
+// values, followed by ASSOC_STATS_PATH_FIELDS values per remote address in
+// a second one, so polling them often creates no objects, the 64 bit
+// counters are exact up to 2^53
+#define ASSOC_STATS_STATE 0
+#define ASSOC_STATS_RWND 1
+#define ASSOC_STATS_UNACKDATA 2
+#define ASSOC_STATS_PENDDATA 3
+#define ASSOC_STATS_INSTRMS 4
+#define ASSOC_STATS_OUTSTRMS 5
+#define ASSOC_STATS_FRAGMENTATION_POINT 6
+#define ASSOC_STATS_MAXRTO 7
+#define ASSOC_STATS_ISACKS 8
+#define ASSOC_STATS_OSACKS 9
+#define ASSOC_STATS_OPACKETS 10
+#define ASSOC_STATS_IPACKETS 11
+#define ASSOC_STATS_RTXCHUNKS 12
+#define ASSOC_STATS_OUTOFSEQTSNS 13
+#define ASSOC_STATS_IDUPCHUNKS 14
+#define ASSOC_STATS_GAPCNT 15
+#define ASSOC_STATS_OUODCHUNKS 16
+#define ASSOC_STATS_IUODCHUNKS 17
+#define ASSOC_STATS_OODCHUNKS 18
+#define ASSOC_STATS_IODCHUNKS 19
+#define ASSOC_STATS_OCTRLCHUNKS 20
+#define ASSOC_STATS_ICTRLCHUNKS 21
+#define ASSOC_STATS_FIELDS 22
+
+#define ASSOC_STATS_PATH_STATE 0
+#define ASSOC_STATS_PATH_CWND 1
+#define ASSOC_STATS_PATH_SRTT 2
+#define ASSOC_STATS_PATH_RTO 3
+#define ASSOC_STATS_PATH_MTU 4
+#define ASSOC_STATS_PATH_FIELDS 5
+
+static double* require_named_float64_array_asserted(napi_env env, napi_value obj, const char* name, size_t* length, const char* assertion_message) {
+  napi_value js_array;
   napi_status status;
-  struct sockaddr* sockaddr_ptr;
-  size_t sockaddr_length;
-  socklen_t sockaddr_length_as_socklen;
+  napi_typedarray_type array_type;
+  double* data;
 
-  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
+  status = napi_get_named_property(env, obj, name, &js_array);
   if (status != napi_ok) {
-    return napi_helper_get_undefined(env);
+    abort_with_message(assertion_message);
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_getsockname: fd must be provided as number");
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", &sockaddr_ptr, &sockaddr_length, "do_getsockname: failed to get sockaddr buffer");
+  status = napi_get_typedarray_info(env, js_array, &array_type, length, (void**) &data, NULL, NULL);
+  if (status != napi_ok || array_type != napi_float64_array) {
+    abort_with_message(assertion_message);
+  }
 
-  sockaddr_length_as_socklen = sockaddr_length;
+  return data;
+}
 
-  errno = 0;
-  getsockname(fd, sockaddr_ptr, &sockaddr_length_as_socklen);
+static int fill_association_stats(int32_t fd, int32_t assoc_id, double* stats) {
+  struct sctp_status sstat = {0};
+  struct sctp_assoc_stats sas = {0};
+  socklen_t sstat_len = sizeof(sstat);
+  socklen_t sas_len = sizeof(sas);
 
-  return napi_helper_create_errno_result_asserted(env, errno);
+  sstat.sstat_assoc_id = assoc_id;
+  if (getsockopt(fd, IPPROTO_SCTP, SCTP_STATUS, &sstat, &sstat_len) < 0) {
+    return errno;
+  }
+
+  // the kernel resets the observed max RTO with every read
+  sas.sas_assoc_id = assoc_id;
+  if (getsockopt(fd, IPPROTO_SCTP, SCTP_GET_ASSOC_STATS, &sas, &sas_len) < 0) {
+    return errno;
+  }
+
+  stats[ASSOC_STATS_STATE] = sstat.sstat_state;
+  stats[ASSOC_STATS_RWND] = sstat.sstat_rwnd;
+  stats[ASSOC_STATS_UNACKDATA] = sstat.sstat_unackdata;
+  stats[ASSOC_STATS_PENDDATA] = sstat.sstat_penddata;
+  stats[ASSOC_STATS_INSTRMS] = sstat.sstat_instrms;
+  stats[ASSOC_STATS_OUTSTRMS] = sstat.sstat_outstrms;
+  stats[ASSOC_STATS_FRAGMENTATION_POINT] = sstat.sstat_fragmentation_point;
+  stats[ASSOC_STATS_MAXRTO] = sas.sas_maxrto;
+  stats[ASSOC_STATS_ISACKS] = sas.sas_isacks;
+  stats[ASSOC_STATS_OSACKS] = sas.sas_osacks;
+  stats[ASSOC_STATS_OPACKETS] = sas.sas_opackets;
+  stats[ASSOC_STATS_IPACKETS] = sas.sas_ipackets;
+  stats[ASSOC_STATS_RTXCHUNKS] = sas.sas_rtxchunks;
+  stats[ASSOC_STATS_OUTOFSEQTSNS] = sas.sas_outofseqtsns;
+  stats[ASSOC_STATS_IDUPCHUNKS] = sas.sas_idupchunks;
+  stats[ASSOC_STATS_GAPCNT] = sas.sas_gapcnt;
+  stats[ASSOC_STATS_OUODCHUNKS] = sas.sas_ouodchunks;
+  stats[ASSOC_STATS_IUODCHUNKS] = sas.sas_iuodchunks;
+  stats[ASSOC_STATS_OODCHUNKS] = sas.sas_oodchunks;
+  stats[ASSOC_STATS_IODCHUNKS] = sas.sas_iodchunks;
+  stats[ASSOC_STATS_OCTRLCHUNKS] = sas.sas_octrlchunks;
+  stats[ASSOC_STATS_ICTRLCHUNKS] = sas.sas_ictrlchunks;
+
+  return 0;
 }
 
-static napi_value create_buffer_array_from_dynamic_sockaddr_array(napi_env env, struct sockaddr* addrs, int num_addrs) {
+// fills at most max_paths entries, NaN for a path whose info can't be
+// retrieved, returns the number of remote addresses or -errno
+static int fill_association_path_stats(int32_t fd, int32_t assoc_id, double* paths, size_t max_paths) {
   int i;
-  napi_value js_buffer_array;
-  struct sockaddr* current_addr = addrs;
+  int num_addrs;
+  struct sockaddr* addrs;
+  struct sockaddr* current_addr;
 
-  js_buffer_array = napi_helper_create_array_asserted(env, "create_buffer_array_from_dynamic_sockaddr_array: failed to create buffer array");
+  num_addrs = sctp_getpaddrs(fd, assoc_id, &addrs);
+  if (num_addrs < 0) {
+    return (errno == ENOTCONN || errno == EINVAL) ? 0 : -errno;
+  }
 
-  for(i = 0; i < num_addrs; i += 1) {
-    napi_value js_buffer;
-    size_t addr_length;
+  current_addr = addrs;
+  for(i = 0; i < num_addrs && (size_t) i < max_paths; i += 1) {
+    struct sctp_paddrinfo spinfo = {0};
+    socklen_t spinfo_len = sizeof(spinfo);
+    size_t addr_length = sockaddr_length_of_family(current_addr);
+    double* path = paths + i * ASSOC_STATS_PATH_FIELDS;
 
-    switch(current_addr->sa_family) {
-      case AF_INET: {
-        addr_length = sizeof(struct sockaddr_in);
-        break;
-      }
-      default: {
-        abort_with_message("create_buffer_array_from_dynamic_sockaddr_array: unsupported address family");
-        break;
-      }
+    if (addr_length == 0) {
+      abort_with_message("fill_association_path_stats: unsupported address family");
     }
 
-    js_buffer = napi_helper_create_buffer_copy_asserted(env, current_addr, addr_length, "create_buffer_array_from_dynamic_sockaddr_array: failed to create buffer");
-    napi_helper_set_element_asserted(env, js_buffer_array, i, js_buffer, "create_buffer_array_from_dynamic_sockaddr_array: failed to set buffer element");
+    spinfo.spinfo_assoc_id = assoc_id;
+    memcpy(&spinfo.spinfo_address, current_addr, addr_length);
+
+    if (getsockopt(fd, IPPROTO_SCTP, SCTP_GET_PEER_ADDR_INFO, &spinfo, &spinfo_len) < 0) {
+      path[ASSOC_STATS_PATH_STATE] = NAN;
+      path[ASSOC_STATS_PATH_CWND] = NAN;
+      path[ASSOC_STATS_PATH_SRTT] = NAN;
+      path[ASSOC_STATS_PATH_RTO] = NAN;
+      path[ASSOC_STATS_PATH_MTU] = NAN;
+    } else {
+      path[ASSOC_STATS_PATH_STATE] = spinfo.spinfo_state;
+      path[ASSOC_STATS_PATH_CWND] = spinfo.spinfo_cwnd;
+      path[ASSOC_STATS_PATH_SRTT] = spinfo.spinfo_srtt;
+      path[ASSOC_STATS_PATH_RTO] = spinfo.spinfo_rto;
+      path[ASSOC_STATS_PATH_MTU] = spinfo.spinfo_mtu;
+    }
 
     current_addr = (struct sockaddr*) ((void*) current_addr + addr_length);
   }
 
-  return js_buffer_array;
+  sctp_freepaddrs(addrs);
+
+  return num_addrs;
 }
 
-static napi_value do_sctp_getladdrs(napi_env env, napi_callback_info info) {
-  int num_addrs;
+// messages abandoned under PR-SCTP policies, of all streams with
+// SCTP_PR_ASSOC_STATUS, or of one with SCTP_PR_STREAM_STATUS if sid is set
+static napi_value getsockopt_pr_status(napi_env env, napi_callback_info info) {
+  int rc;
   int32_t fd;
+  int32_t assoc_id;
+  int32_t sid;
   napi_value js_args_obj;
-  napi_status status;
-  struct sockaddr* addrs;
   napi_value js_result;
-  napi_value js_addrs_array;
+  napi_value js_value;
+  napi_status status;
+  struct sctp_prstatus prstatus = {0};
+  socklen_t prstatus_len = sizeof(prstatus);
 
   status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
   if (status != napi_ok) {
     return napi_helper_get_undefined(env);
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_getladdrs: fd must be provided as number");
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "getsockopt_pr_status: fd must be provided as number");
+  assoc_id = napi_helper_require_named_int32_asserted(env, js_args_obj, "assocId", "getsockopt_pr_status: assocId must be provided as number");
+  sid = napi_helper_require_named_int32_asserted(env, js_args_obj, "sid", "getsockopt_pr_status: sid must be provided as number");
 
-  num_addrs = sctp_getladdrs(fd, 0, &addrs);
-  if (num_addrs < 0) {
+  prstatus.sprstat_assoc_id = assoc_id;
+  prstatus.sprstat_sid = sid < 0 ? 0 : sid;
+  prstatus.sprstat_policy = SCTP_PR_SCTP_ALL;
+
+  rc = getsockopt(fd, IPPROTO_SCTP, sid < 0 ? SCTP_PR_ASSOC_STATUS : SCTP_PR_STREAM_STATUS, &prstatus, &prstatus_len);
+  if (rc < 0) {
     return napi_helper_create_errno_result_asserted(env, errno);
   }
 
   js_result = napi_helper_create_object_asserted(env);
   napi_helper_add_int32_field_asserted(env, js_result, "errno", 0);
 
-  js_addrs_array = create_buffer_array_from_dynamic_sockaddr_array(env, addrs, num_addrs);
-  napi_helper_set_named_property_asserted(env, js_result, "sockaddrs", js_addrs_array);
+  // counters stay far below 2^53, plain numbers are fine
+  status = napi_create_double(env, (double) prstatus.sprstat_abandoned_unsent, &js_value);
+  napi_helper_abort_on_error_with_message(env, status, "getsockopt_pr_status: failed to create number");
+  napi_helper_add_field_asserted(env, js_result, "abandonedUnsent", js_value);
 
-  sctp_freeladdrs(addrs);
+  status = napi_create_double(env, (double) prstatus.sprstat_abandoned_sent, &js_value);
+  napi_helper_abort_on_error_with_message(env, status, "getsockopt_pr_status: failed to create number");
+  napi_helper_add_field_asserted(env, js_result, "abandonedSent", js_value);
 
   return js_result;
 }
 
-napi_value do_getpeername(napi_env env, napi_callback_info info) {
+// SCTP_STATUS, SCTP_GET_ASSOC_STATS and the path info of every remote
+// address in one call, written into the caller's stats and paths, returns
+// the number of remote addresses (paths holds as many as fit) or -errno
+static napi_value get_association_stats(napi_env env, napi_callback_info info) {
   int32_t fd;
+  int32_t assoc_id;
+  int rc;
   napi_value js_args_obj;
+  napi_value js_result;
   napi_status status;
-  struct sockaddr* sockaddr_ptr;
-  size_t sockaddr_length;
-  socklen_t sockaddr_length_as_socklen;
+  double* stats;
+  double* paths;
+  size_t stats_length;
+  size_t paths_length;
 
   status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
   if (status != napi_ok) {
     return napi_helper_get_undefined(env);
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_getpeername: fd must be provided as number");
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "sockaddr", &sockaddr_ptr, &sockaddr_length, "do_getpeername: failed to get sockaddr buffer");
-
-  sockaddr_length_as_socklen = sockaddr_length;
-
-  errno = 0;
-  getpeername(fd, sockaddr_ptr, &sockaddr_length_as_socklen);
-
-  return napi_helper_create_errno_result_asserted(env, errno);
-}
-
-static napi_value do_sctp_getpaddrs(napi_env env, napi_callback_info info) {
-  int num_addrs;
-  int32_t fd;
-  napi_value js_args_obj;
-  napi_status status;
-  struct sockaddr* addrs;
-  napi_value js_result;
-  napi_value js_addrs_array;
+  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "get_association_stats: fd must be provided as number");
+  assoc_id = napi_helper_require_named_int32_asserted(env, js_args_obj, "assocId", "get_association_stats: assocId must be provided as number");
+  stats = require_named_float64_array_asserted(env, js_args_obj, "stats", &stats_length, "get_association_stats: stats must be provided as Float64Array");
+  paths = require_named_float64_array_asserted(env, js_args_obj, "paths", &paths_length, "get_association_stats: paths must be provided as Float64Array");
 
-  status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
-  if (status != napi_ok) {
-    return napi_helper_get_undefined(env);
+  if (stats_length < ASSOC_STATS_FIELDS) {
+    abort_with_message("get_association_stats: stats is too short");
   }
 
-  fd = napi_helper_require_named_int32_asserted(env, js_args_obj, "fd", "do_sctp_getpaddrs: fd must be provided as number");
-
-  num_addrs = sctp_getpaddrs(fd, 0, &addrs);
-  if (num_addrs < 0) {
-    return napi_helper_create_errno_result_asserted(env, errno);
+  rc = fill_association_stats(fd, assoc_id, stats);
+  if (rc != 0) {
+    rc = -rc;
+  } else {
+    rc = fill_association_path_stats(fd, assoc_id, paths, paths_length / ASSOC_STATS_PATH_FIELDS);
   }
 
-  js_result = napi_helper_create_object_asserted(env);
-  napi_helper_add_int32_field_asserted(env, js_result, "errno", 0);
-
-  js_addrs_array = create_buffer_array_from_dynamic_sockaddr_array(env, addrs, num_addrs);
-  napi_helper_set_named_property_asserted(env, js_result, "sockaddrs", js_addrs_array);
-
-  sctp_freepaddrs(addrs);
+  status = napi_create_int32(env, rc, &js_result);
+  if (status != napi_ok) {
+    abort_with_message("get_association_stats: failed to create result");
+  }
 
   return js_result;
 }
@@ -1085,142 +4755,224 @@ napi_value close_fd(napi_env env, napi_callback_info info) {
   return napi_helper_create_errno_result_asserted(env, errno_value);
 }
 
-napi_value parse_sctp_assoc_change_notification(napi_env env, struct sctp_assoc_change* sn_assoc_change, size_t length) {
-  napi_value js_result;
-
-  if (length < sizeof(struct sctp_assoc_change)) {
-    napi_throw_error(env, NULL, "parse_sctp_assoc_change_notification: buffer too small");
-    return napi_helper_get_undefined(env);
-  }
-
-  js_result = napi_helper_create_object_asserted(env);
-  napi_helper_add_int32_field_asserted(env, js_result, "sac_type", sn_assoc_change->sac_type);
-  napi_helper_add_int32_field_asserted(env, js_result, "sac_flags", sn_assoc_change->sac_flags);
-  napi_helper_add_int32_field_asserted(env, js_result, "sac_state", sn_assoc_change->sac_state);
-  napi_helper_add_int32_field_asserted(env, js_result, "sac_error", sn_assoc_change->sac_error);
-  napi_helper_add_int32_field_asserted(env, js_result, "sac_outbound_streams", sn_assoc_change->sac_outbound_streams);
-  napi_helper_add_int32_field_asserted(env, js_result, "sac_inbound_streams", sn_assoc_change->sac_inbound_streams);
-
-  return js_result;
-}
+// notifications are decoded into a Uint32Array of NOTIFICATION_FIELDS
+// values instead of objects, type specific values follow the header,
+// variable length parts are given as offset and length into the notification
+#define NOTIFICATION_FIELD_TYPE 0
+#define NOTIFICATION_FIELD_FLAGS 1
+#define NOTIFICATION_FIELD_LENGTH 2
+#define NOTIFICATION_FIELD_ASSOC_ID 3
+#define NOTIFICATION_FIELD_VALUES 4
+#define NOTIFICATION_FIELDS 12
+
+#define NOTIFICATION_HAS(member) \
+  (length >= offsetof(union sctp_notification, member) + sizeof(notification->member))
+
+#define NOTIFICATION_OFFSET(member, field) \
+  (offsetof(union sctp_notification, member) + offsetof(typeof(notification->member), field))
+
+static void decode_notification_values(const union sctp_notification* notification, size_t length, uint32_t* values) {
+  switch (notification->sn_header.sn_type) {
+    case SCTP_ASSOC_CHANGE:
+      if (NOTIFICATION_HAS(sn_assoc_change)) {
+        values[0] = notification->sn_assoc_change.sac_state;
+        values[1] = notification->sn_assoc_change.sac_error;
+        values[2] = notification->sn_assoc_change.sac_outbound_streams;
+        values[3] = notification->sn_assoc_change.sac_inbound_streams;
+      }
+      break;
 
-napi_value parse_sctp_authentication_event_notifcation(napi_env env, struct sctp_authkey_event* sn_authkey_event, size_t length) {
-  napi_value js_result;
+    case SCTP_PEER_ADDR_CHANGE:
+      if (NOTIFICATION_HAS(sn_paddr_change)) {
+        values[0] = notification->sn_paddr_change.spc_state;
+        values[1] = notification->sn_paddr_change.spc_error;
+        values[2] = NOTIFICATION_OFFSET(sn_paddr_change, spc_aaddr);
+        values[3] = sizeof(notification->sn_paddr_change.spc_aaddr);
+      }
+      break;
 
-  if (length < sizeof(struct sctp_authkey_event)) {
-    napi_throw_error(env, NULL, "parse_sctp_authentication_event_notifcation: buffer too small");
-    return napi_helper_get_undefined(env);
-  }
+    case SCTP_REMOTE_ERROR:
+      if (NOTIFICATION_HAS(sn_remote_error)) {
+        values[0] = ntohs(notification->sn_remote_error.sre_error);
+        values[1] = NOTIFICATION_OFFSET(sn_remote_error, sre_data);
+        values[2] = length - values[1];
+      }
+      break;
 
-  js_result = napi_helper_create_object_asserted(env);
-  napi_helper_add_int32_field_asserted(env, js_result, "auth_type", sn_authkey_event->auth_type);
-  napi_helper_add_int32_field_asserted(env, js_result, "auth_flags", sn_authkey_event->auth_flags);
-  napi_helper_add_int32_field_asserted(env, js_result, "auth_keynumber", sn_authkey_event->auth_keynumber);
-  napi_helper_add_int32_field_asserted(env, js_result, "auth_indication", sn_authkey_event->auth_indication);
+    case SCTP_SEND_FAILED_EVENT:
+      if (NOTIFICATION_HAS(sn_send_failed_event)) {
+        values[0] = notification->sn_send_failed_event.ssf_error;
+        values[1] = notification->sn_send_failed_event.ssfe_info.snd_sid;
+        values[2] = notification->sn_send_failed_event.ssfe_info.snd_flags;
+        values[3] = notification->sn_send_failed_event.ssfe_info.snd_ppid;
+        values[4] = notification->sn_send_failed_event.ssfe_info.snd_context;
+        values[5] = NOTIFICATION_OFFSET(sn_send_failed_event, ssf_data);
+        values[6] = length - values[5];
+      }
+      break;
 
-  return js_result;
-}
+    case SCTP_ADAPTATION_INDICATION:
+      if (NOTIFICATION_HAS(sn_adaptation_event)) {
+        values[0] = notification->sn_adaptation_event.sai_adaptation_ind;
+      }
+      break;
 
-napi_value parse_sctp_peer_addr_change_notification(napi_env env, struct sctp_paddr_change* sn_paddr_change, size_t length) {
-  napi_value js_result;
-  napi_value js_spc_aaddr;
+    case SCTP_PARTIAL_DELIVERY_EVENT:
+      if (NOTIFICATION_HAS(sn_pdapi_event)) {
+        values[0] = notification->sn_pdapi_event.pdapi_indication;
+        values[1] = notification->sn_pdapi_event.pdapi_stream;
+        values[2] = notification->sn_pdapi_event.pdapi_seq;
+      }
+      break;
 
-  if (length < sizeof(struct sctp_paddr_change)) {
-    napi_throw_error(env, NULL, "parse_sctp_assoc_change_notification: buffer too small");
-    return napi_helper_get_undefined(env);
-  }
+    case SCTP_AUTHENTICATION_EVENT:
+      if (NOTIFICATION_HAS(sn_authkey_event)) {
+        values[0] = notification->sn_authkey_event.auth_keynumber;
+        values[1] = notification->sn_authkey_event.auth_indication;
+      }
+      break;
 
-  js_result = napi_helper_create_object_asserted(env);
-  napi_helper_add_int32_field_asserted(env, js_result, "spc_type", sn_paddr_change->spc_type);
-  napi_helper_add_int32_field_asserted(env, js_result, "spc_flags", sn_paddr_change->spc_flags);
+    case SCTP_STREAM_RESET_EVENT:
+      if (NOTIFICATION_HAS(sn_strreset_event)) {
+        values[0] = NOTIFICATION_OFFSET(sn_strreset_event, strreset_stream_list);
+        values[1] = (length - values[0]) / sizeof(uint16_t);
+      }
+      break;
 
-  js_spc_aaddr = napi_helper_create_buffer_copy_asserted(env, &sn_paddr_change->spc_aaddr, sizeof(sn_paddr_change->spc_aaddr), "parse_sctp_peer_addr_change_notification: failed to create buffer");
-  napi_helper_add_field_asserted(env, js_result, "spc_aaddr", js_spc_aaddr);
+    case SCTP_ASSOC_RESET_EVENT:
+      if (NOTIFICATION_HAS(sn_assocreset_event)) {
+        values[0] = notification->sn_assocreset_event.assocreset_local_tsn;
+        values[1] = notification->sn_assocreset_event.assocreset_remote_tsn;
+      }
+      break;
 
-  napi_helper_add_int32_field_asserted(env, js_result, "spc_state", sn_paddr_change->spc_state);
-  napi_helper_add_int32_field_asserted(env, js_result, "spc_error", sn_paddr_change->spc_error);
+    case SCTP_STREAM_CHANGE_EVENT:
+      if (NOTIFICATION_HAS(sn_strchange_event)) {
+        values[0] = notification->sn_strchange_event.strchange_instrms;
+        values[1] = notification->sn_strchange_event.strchange_outstrms;
+      }
+      break;
 
-  return js_result;
+    default:
+      // SCTP_SHUTDOWN_EVENT and SCTP_SENDER_DRY_EVENT carry nothing else
+      break;
+  }
 }
 
-napi_value parse_sctp_notification(napi_env env, napi_callback_info info) {
+#undef NOTIFICATION_HAS
+#undef NOTIFICATION_OFFSET
+
+// decodes a notification right where it was received, nothing is
+// allocated, returns the notification type
+static napi_value decode_sctp_notification(napi_env env, napi_callback_info info) {
   napi_value js_args_obj;
+  napi_value js_fields;
   napi_value js_result;
-  napi_value js_sn;
   napi_status status;
-  union sctp_notification* notification_addr;
-  size_t notification_length;
-  size_t remaining_length;
+  napi_typedarray_type fields_type;
+  size_t fields_length;
+  uint32_t* fields;
+  const union sctp_notification* notification;
+  size_t length;
 
   status = napi_helper_require_args_or_throw(env, info, 1, &js_args_obj);
   if (status != napi_ok) {
     return napi_helper_get_undefined(env);
   }
 
-  napi_helper_require_named_buffer_asserted(env, js_args_obj, "notification", (void**) &notification_addr, &notification_length, "parse_sctp_notification: failed to get notification buffer");
+  napi_helper_require_named_buffer_asserted(env, js_args_obj, "notification", (void**) &notification, &length, "decode_sctp_notification: notification must be provided as buffer");
+
+  status = napi_get_named_property(env, js_args_obj, "fields", &js_fields);
+  if (status != napi_ok) {
+    abort_with_message("decode_sctp_notification: fields must be provided as Uint32Array");
+  }
+
+  status = napi_get_typedarray_info(env, js_fields, &fields_type, &fields_length, (void**) &fields, NULL, NULL);
+  if (status != napi_ok || fields_type != napi_uint32_array || fields_length < NOTIFICATION_FIELDS) {
+    abort_with_message("decode_sctp_notification: fields must be provided as Uint32Array");
+  }
 
-  if (notification_length < 2) {
-    napi_throw_error(env, NULL, "parse_sctp_notification: notification buffer too small");
+  if (length < sizeof(notification->sn_header)) {
+    napi_throw_error(env, NULL, "decode_sctp_notification: notification buffer too small");
     return napi_helper_get_undefined(env);
   }
 
-  js_result = napi_helper_create_object_asserted(env);
-  napi_helper_add_int32_field_asserted(env, js_result, "sn_type", notification_addr->sn_header.sn_type);
+  memset(fields, 0, NOTIFICATION_FIELDS * sizeof(uint32_t));
+  fields[NOTIFICATION_FIELD_TYPE] = notification->sn_header.sn_type;
+  fields[NOTIFICATION_FIELD_FLAGS] = notification->sn_header.sn_flags;
+  fields[NOTIFICATION_FIELD_LENGTH] = notification->sn_header.sn_length;
+  fields[NOTIFICATION_FIELD_ASSOC_ID] = notification_assoc_id(notification, length);
 
-  switch(notification_addr->sn_header.sn_type) {
-    case SCTP_ASSOC_CHANGE: {
-      remaining_length = notification_length - offsetof(union sctp_notification, sn_assoc_change);
-      js_sn = parse_sctp_assoc_change_notification(env, &notification_addr->sn_assoc_change, remaining_length);
-      napi_helper_add_field_asserted(env, js_result, "sn_assoc_change", js_sn);
-      break;
-    }
-    case SCTP_AUTHENTICATION_EVENT: {
-      remaining_length = notification_length - offsetof(union sctp_notification, sn_authkey_event);
-      js_sn = parse_sctp_authentication_event_notifcation(env, &notification_addr->sn_authkey_event, remaining_length);
-      napi_helper_add_field_asserted(env, js_result, "sn_authkey_event", js_sn);
-      break;
-    }
-    case SCTP_PEER_ADDR_CHANGE: {
-      remaining_length = notification_length - offsetof(union sctp_notification, sn_paddr_change);
-      js_sn = parse_sctp_peer_addr_change_notification(env, &notification_addr->sn_paddr_change, remaining_length);
-      napi_helper_add_field_asserted(env, js_result, "sn_paddr_change", js_sn);
-      break;
-    }
-    default: {
-      // only return sn_type
-      break;
-    }
+  decode_notification_values(notification, length, fields + NOTIFICATION_FIELD_VALUES);
+
+  status = napi_create_uint32(env, notification->sn_header.sn_type, &js_result);
+  if (status != napi_ok) {
+    abort_with_message("decode_sctp_notification: failed to create result");
   }
 
   return js_result;
 }
 
+static void instance_data_finalizer(napi_env env, void* finalize_data, void* finalize_hint) {
+  struct instance_data* instance = (struct instance_data*) finalize_data;
+
+  if (instance->receive_slab.arraybuffer_ref != NULL) {
+    napi_delete_reference(env, instance->receive_slab.arraybuffer_ref);
+  }
+
+  free(instance);
+}
+
 NAPI_MODULE_INIT() {
+  napi_status status;
+  struct instance_data* instance;
+
+  // all state is kept per environment, so the module can be loaded
+  // by several worker threads at the same time
+  instance = (struct instance_data*) calloc(1, sizeof(*instance));
+  if (instance == NULL) {
+    abort_with_message("failed to allocate memory for instance data");
+  }
+
+  status = napi_set_instance_data(env, instance, instance_data_finalizer, NULL);
+  if (status != napi_ok) {
+    abort_with_message("failed to set instance data");
+  }
 
   napi_helper_add_function_field_asserted(env, exports, "create_socket", create_socket, NULL, "failed to add create_socket");
   napi_helper_add_function_field_asserted(env, exports, "close_fd", close_fd, NULL, "failed to add close_fd");
   napi_helper_add_function_field_asserted(env, exports, "sctp_bindx", do_sctp_bindx, NULL, "failed to add sctp_bindx");
-  napi_helper_add_function_field_asserted(env, exports, "create_poller", create_poller, NULL, "failed to add create_poller");
+  napi_helper_add_function_field_asserted(env, exports, "create_poll_dispatcher", create_poll_dispatcher, NULL, "failed to add create_poll_dispatcher");
+  napi_helper_add_function_field_asserted(env, exports, "create_io_thread", create_io_thread, NULL, "failed to add create_io_thread");
+  napi_helper_add_function_field_asserted(env, exports, "create_io_uring", create_io_uring, NULL, "failed to add create_io_uring");
   napi_helper_add_function_field_asserted(env, exports, "sctp_recvv", do_sctp_recvv, NULL, "failed to add sctp_recvv");
+  napi_helper_add_function_field_asserted(env, exports, "sctp_recvv_batch", do_sctp_recvv_batch, NULL, "failed to add sctp_recvv_batch");
   napi_helper_add_function_field_asserted(env, exports, "sctp_sendv", do_sctp_sendv, NULL, "failed to add sctp_sendmsg");
+  napi_helper_add_function_field_asserted(env, exports, "sctp_sendv_batch", do_sctp_sendv_batch, NULL, "failed to add sctp_sendv_batch");
   napi_helper_add_function_field_asserted(env, exports, "listen", do_listen, NULL, "failed to add listen");
   napi_helper_add_function_field_asserted(env, exports, "accept", do_accept, NULL, "failed to add accept");
+  napi_helper_add_function_field_asserted(env, exports, "accept_batch", do_accept_batch, NULL, "failed to add accept_batch");
+  napi_helper_add_function_field_asserted(env, exports, "sctp_peeloff", do_sctp_peeloff, NULL, "failed to add sctp_peeloff");
   napi_helper_add_function_field_asserted(env, exports, "sctp_connectx", do_sctp_connectx, NULL, "failed to add sctp_connectx");
   napi_helper_add_function_field_asserted(env, exports, "get_socket_error", get_socket_error, NULL, "failed to add get_socket_error");
   napi_helper_add_function_field_asserted(env, exports, "getsockname", do_getsockname, NULL, "failed to add getsockname");
   napi_helper_add_function_field_asserted(env, exports, "sctp_getladdrs", do_sctp_getladdrs, NULL, "failed to add do_sctp_getladdrs");
   napi_helper_add_function_field_asserted(env, exports, "getpeername", do_getpeername, NULL, "failed to add getpeername");
   napi_helper_add_function_field_asserted(env, exports, "sctp_getpaddrs", do_sctp_getpaddrs, NULL, "failed to add sctp_getpaddrs");
+  napi_helper_add_function_field_asserted(env, exports, "snapshot_association", snapshot_association, NULL, "failed to add snapshot_association");
+  napi_helper_add_function_field_asserted(env, exports, "get_association_stats", get_association_stats, NULL, "failed to add get_association_stats");
+  napi_helper_add_function_field_asserted(env, exports, "getsockopt_pr_status", getsockopt_pr_status, NULL, "failed to add getsockopt_pr_status");
   napi_helper_add_function_field_asserted(env, exports, "setsockopt_sack_info", setsockopt_sack_info, NULL, "failed to add setsockopt_sack_info");
   napi_helper_add_function_field_asserted(env, exports, "setsockopt_sctp_initmsg", setsockopt_sctp_initmsg, NULL, "failed to add setsockopt_sctp_initmsg");
   napi_helper_add_function_field_asserted(env, exports, "setsockopt_sctp_recvrcvinfo", setsockopt_sctp_recvrcvinfo, NULL, "failed to add setsockopt_sctp_recvrcvinfo");
   napi_helper_add_function_field_asserted(env, exports, "setsockopt_linger", setsockopt_linger, NULL, "failed to add setsockopt_linger");
   napi_helper_add_function_field_asserted(env, exports, "setsockopt_nodelay", setsockopt_nodelay, NULL, "failed to add setsockopt_nodelay");
+  napi_helper_add_function_field_asserted(env, exports, "setsockopt_reuseport", setsockopt_reuseport, NULL, "failed to add setsockopt_reuseport");
   napi_helper_add_function_field_asserted(env, exports, "setsockopt_sctp_event", setsockopt_sctp_event, NULL, "failed to add setsockopt_sctp_event");
+  napi_helper_add_function_field_asserted(env, exports, "configure_socket", configure_socket, NULL, "failed to add configure_socket");
   napi_helper_add_function_field_asserted(env, exports, "getsockopt_sctp_status", getsockopt_sctp_status, NULL, "failed to add getsockopt_sctp_status");
-  napi_helper_add_function_field_asserted(env, exports, "getsockopt_peer_addr_info", getsockopt_peer_addr_info, NULL, "failed to add getsockopt_peer_addr_info");
   napi_helper_add_function_field_asserted(env, exports, "shutdown", do_shutdown, NULL, "failed to add shutdown");
-  napi_helper_add_function_field_asserted(env, exports, "parse_sctp_notification", parse_sctp_notification, NULL, "failed to add parse_sctp_notification");
+  napi_helper_add_function_field_asserted(env, exports, "decode_sctp_notification", decode_sctp_notification, NULL, "failed to add decode_sctp_notification");
 
   return exports;
 }
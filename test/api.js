@@ -192,6 +192,22 @@ describe("api", () => {
         return ex.message === "localAddresses must be an array of valid IP addresses";
       });
     });
+
+    it("should throw on unknown notification types", () => {
+      assert.throws(() => {
+        lksctp.createServer({ notifications: ["SCTP_NOT_A_NOTIFICATION"] });
+      }, (ex) => {
+        return ex.message === "unknown notification type SCTP_NOT_A_NOTIFICATION";
+      });
+    });
+
+    it("should throw on unknown partialDelivery modes", () => {
+      assert.throws(() => {
+        lksctp.createServer({ partialDelivery: "stream" });
+      }, (ex) => {
+        return ex.message === "partialDelivery must be one of assemble, chunks";
+      });
+    });
   });
 
   describe("client", () => {
@@ -0,0 +1,273 @@
+const assert = require("node:assert");
+const socketpairFactory = require("./lib/socketpair.js");
+
+// make sure unhandeled rejections are thrown
+process.on("unhandledRejection", (reason) => {
+  throw reason;
+});
+
+const leanOptions = {
+  server: { socket: { lean: true } },
+  client: { lean: true }
+};
+
+describe("lean association", function () {
+  this.timeout(10000);
+
+  it("should deliver messages in order with sid and ppid", async () => {
+    await socketpairFactory.withSocketpair({
+      options: leanOptions,
+      test: async ({ server, client }) => {
+        const numberOfMessages = 2000;
+
+        const received = await new Promise((resolve, reject) => {
+          const messages = [];
+
+          server.on("error", reject);
+          client.on("error", reject);
+
+          server.onMessage = (message, sid, ppid) => {
+            messages.push({ index: message.readUInt32BE(0), length: message.length, sid, ppid });
+            if (messages.length === numberOfMessages) {
+              resolve(messages);
+            }
+          };
+
+          for (let i = 0; i < numberOfMessages; i += 1) {
+            const message = Buffer.alloc(20 + (i % 300));
+            message.writeUInt32BE(i, 0);
+            client.send(message, 1, i);
+          }
+        });
+
+        received.forEach(({ index, length, sid, ppid }, idx) => {
+          assert.strictEqual(index, idx);
+          assert.strictEqual(length, 20 + (idx % 300));
+          assert.strictEqual(sid, 1);
+          assert.strictEqual(ppid, idx);
+        });
+      }
+    });
+  });
+
+  it("should emit message events if onMessage is not replaced", async () => {
+    await socketpairFactory.withSocketpair({
+      options: leanOptions,
+      test: async ({ server, client }) => {
+        const [message, sid, ppid] = await new Promise((resolve) => {
+          server.once("message", (...args) => {
+            resolve(args);
+          });
+
+          client.send(Buffer.from("hello"), 0, 42);
+        });
+
+        assert.strictEqual(message.toString(), "hello");
+        assert.strictEqual(sid, 0);
+        assert.strictEqual(ppid, 42);
+      }
+    });
+  });
+
+  it("should report backpressure and emit drain", async () => {
+    await socketpairFactory.withSocketpair({
+      options: leanOptions,
+      test: async ({ server, client }) => {
+        let received = 0;
+        server.onMessage = () => {
+          received += 1;
+        };
+
+        let sent = 0;
+        while (client.send(Buffer.alloc(1000))) {
+          sent += 1;
+        }
+        sent += 1;
+
+        assert(client.queuedBytes >= 64 * 1024);
+
+        await new Promise((resolve) => {
+          client.once("drain", resolve);
+        });
+
+        assert(client.queuedBytes < 64 * 1024);
+
+        await new Promise((resolve) => {
+          const check = () => {
+            if (received === sent) {
+              resolve();
+              return;
+            }
+
+            setTimeout(check, 10);
+          };
+
+          check();
+        });
+      }
+    });
+  });
+
+  it("should stop calling onMessage right after pause(), and deliver the rest on resume()", async () => {
+    await socketpairFactory.withSocketpair({
+      options: leanOptions,
+      test: async ({ server, client }) => {
+        const numberOfMessages = 50;
+        const received = [];
+        let receivedWhilePaused = 0;
+        let paused = false;
+
+        const allReceived = new Promise((resolve) => {
+          server.onMessage = (message) => {
+            if (paused) {
+              receivedWhilePaused += 1;
+            }
+
+            received.push(message.readUInt32BE(0));
+
+            // the first messages arrive in one batch
+            if (received.length === 1) {
+              paused = true;
+              server.pause();
+
+              setTimeout(() => {
+                paused = false;
+                server.resume();
+              }, 50);
+            }
+
+            if (received.length === numberOfMessages) {
+              resolve();
+            }
+          };
+        });
+
+        for (let i = 0; i < numberOfMessages; i += 1) {
+          const message = Buffer.alloc(4);
+          message.writeUInt32BE(i, 0);
+          client.send(message);
+        }
+
+        await allReceived;
+
+        assert.strictEqual(receivedWhilePaused, 0);
+        received.forEach((index, idx) => {
+          assert.strictEqual(index, idx);
+        });
+      }
+    });
+  });
+
+  it("should send queued messages before shutting down on end()", async () => {
+    await socketpairFactory.withSocketpair({
+      options: leanOptions,
+      test: async ({ server, client }) => {
+        let received = 0;
+        server.onMessage = () => {
+          received += 1;
+        };
+
+        const serverEnded = new Promise((resolve) => {
+          server.once("end", resolve);
+        });
+
+        const clientClosed = new Promise((resolve) => {
+          client.once("close", resolve);
+        });
+
+        for (let i = 0; i < 500; i += 1) {
+          client.send(Buffer.alloc(100));
+        }
+        client.end();
+
+        assert.throws(() => {
+          client.send(Buffer.alloc(1));
+        });
+
+        await serverEnded;
+        assert.strictEqual(received, 500);
+
+        await clientClosed;
+      }
+    });
+  });
+
+  it("should send unordered and partially reliable messages, and count abandoned ones", async () => {
+    await socketpairFactory.withSocketpair({
+      options: leanOptions,
+      test: async ({ server, client }) => {
+        const numberOfMessages = 100;
+        const sendOptions = { unordered: true, ttl: 1000 };
+
+        const received = await new Promise((resolve) => {
+          let count = 0;
+          server.onMessage = () => {
+            count += 1;
+            if (count === numberOfMessages) {
+              resolve(count);
+            }
+          };
+
+          for (let i = 0; i < numberOfMessages; i += 1) {
+            client.send(Buffer.alloc(100), 0, 0, sendOptions);
+          }
+        });
+
+        assert.strictEqual(received, numberOfMessages);
+
+        // nothing expires on loopback within the ttl
+        assert.deepStrictEqual(client.abandoned(), { unsent: 0, sent: 0 });
+        assert.deepStrictEqual(client.abandoned(0), { unsent: 0, sent: 0 });
+
+        assert.throws(() => {
+          client.send(Buffer.alloc(1), 0, 0, { ttl: 10, priority: 1 });
+        });
+      }
+    });
+  });
+
+  it("should abandon messages whose ttl expired while the peer's receive window was closed", async () => {
+    await socketpairFactory.withSocketpair({
+      options: leanOptions,
+      test: async ({ server, client }) => {
+        let received = 0;
+        server.onMessage = () => {
+          received += 1;
+        };
+
+        // the server's receive buffer fills up, so the rest of the
+        // messages waits in the client's send buffer until it expires
+        server.pause();
+
+        const numberOfMessages = 2000;
+        for (let i = 0; i < numberOfMessages; i += 1) {
+          client.send(Buffer.alloc(1000), 0, 0, { ttl: 50 });
+        }
+
+        await new Promise((resolve) => {
+          setTimeout(resolve, 300);
+        });
+
+        // the window opens again, expired messages are dropped instead
+        // of being sent
+        server.resume();
+
+        await new Promise((resolve) => {
+          const check = () => {
+            if (client.abandoned().unsent > 0) {
+              resolve();
+              return;
+            }
+
+            setTimeout(check, 10);
+          };
+
+          check();
+        });
+
+        assert(client.abandoned(0).unsent > 0);
+        assert(received < numberOfMessages);
+      }
+    });
+  });
+});
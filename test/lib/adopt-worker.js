@@ -0,0 +1,18 @@
+const nodeWorkerThreadsModule = require("node:worker_threads");
+const lksctp = require("../../lib/index.js");
+
+const { parentPort } = nodeWorkerThreadsModule;
+
+// takes over the association posted by the test and echoes every message,
+// prefixed to tell it apart from what the original thread sent
+parentPort.once("message", (transfer) => {
+  const connection = lksctp.adopt(transfer);
+
+  connection.on("data", (message) => {
+    connection.write(Buffer.concat([Buffer.from("adopted:"), message]));
+  });
+
+  connection.on("close", () => {
+    parentPort.close();
+  });
+});
@@ -0,0 +1,8 @@
+const lksctp = require("../../lib/index.js");
+
+// echoes every message back, prefixed with the index of this shard
+const { index } = lksctp.shards.listen((connection) => {
+  connection.on("data", (message) => {
+    connection.write(Buffer.concat([Buffer.from(`${index}:`), message]));
+  });
+});
@@ -0,0 +1,60 @@
+const assert = require("node:assert");
+const constants = require("../lib/constants.js");
+const messageAssembler = require("../lib/message-assembler.js");
+
+describe("message assembler", () => {
+  it("should pass complete messages through without copying", () => {
+    const assembler = messageAssembler.create();
+    const piece = Buffer.from("complete");
+
+    assert.strictEqual(assembler.receive({ piece, flags: constants.MSG_EOR }), piece);
+    assert.strictEqual(assembler.pending(), false);
+  });
+
+  it("should join pieces once the last one arrives", () => {
+    const assembler = messageAssembler.create();
+
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("ab"), flags: 0 }), undefined);
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("cd"), flags: 0 }), undefined);
+    assert.strictEqual(assembler.pending(), true);
+
+    const message = assembler.receive({ piece: Buffer.from("ef"), flags: constants.MSG_EOR });
+    assert.strictEqual(message.toString(), "abcdef");
+    assert.strictEqual(assembler.pending(), false);
+  });
+
+  it("should join pieces split by a receive buffer, also when passing chunks on", () => {
+    const assembler = messageAssembler.create({ partialDelivery: "chunks" });
+
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("ab"), flags: constants.RECEIVE_FLAG_CONTINUED }), undefined);
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("cd"), flags: 0 }).toString(), "abcd");
+
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("ef"), flags: constants.RECEIVE_FLAG_CONTINUED }), undefined);
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("gh"), flags: constants.MSG_EOR }).toString(), "efgh");
+    assert.strictEqual(assembler.pending(), false);
+  });
+
+  it("should return the end of the stream as such, and drop a message it cut off", () => {
+    const assembler = messageAssembler.create();
+
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("ab"), flags: 0 }), undefined);
+
+    const eof = assembler.receive({ piece: Buffer.alloc(0), flags: 0 });
+    assert.strictEqual(eof.length, 0);
+    assert.strictEqual(assembler.pending(), false);
+  });
+
+  it("should pass data pieces on as chunks, but join notifications", () => {
+    const assembler = messageAssembler.create({ partialDelivery: "chunks" });
+    const piece = Buffer.from("ab");
+
+    assert.strictEqual(assembler.receive({ piece, flags: 0 }), piece);
+    assert.strictEqual(assembler.receive({ piece: Buffer.from("cd"), flags: constants.MSG_NOTIFICATION }), undefined);
+
+    const notification = assembler.receive({
+      piece: Buffer.from("ef"),
+      flags: constants.MSG_NOTIFICATION | constants.MSG_EOR
+    });
+    assert.strictEqual(notification.toString(), "cdef");
+  });
+});
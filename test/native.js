@@ -1,5 +1,7 @@
 const native = require("../lib/native.js");
 const assert = require("node:assert");
+const sockaddrTranscoder = require("../lib/sockaddr.js");
+const constants = require("../lib/constants.js");
 
 describe("native", () => {
   it("should create and close a socket correclty", () => {
@@ -11,4 +13,60 @@ describe("native", () => {
     const { errno: closeErrno } = native.close_fd({ fd });
     assert(closeErrno === 0);
   });
+
+  it("should create and close a one-to-many socket correclty", () => {
+    const { errno: createErrno, fd } = native.create_socket({ oneToMany: true });
+
+    assert(createErrno === 0);
+    assert(typeof fd === "number");
+
+    const { errno: closeErrno } = native.close_fd({ fd });
+    assert(closeErrno === 0);
+  });
+
+  it("should apply socket options in one call and report the failing one", () => {
+    const { fd } = native.create_socket({ oneToMany: false });
+    const stride = native.CONFIGURE_SOCKET_STRIDE;
+
+    const options = new Uint32Array(3 * stride);
+    options.set([native.CONFIGURE_SOCKET_RECVRCVINFO, 1], 0);
+    options.set([native.CONFIGURE_SOCKET_NODELAY, 1], stride);
+    // the kernel rejects unknown event types with EINVAL
+    options.set([native.CONFIGURE_SOCKET_EVENT, 0xffff, 1], 2 * stride);
+
+    const { errno, failedIndex } = native.configure_socket({ fd, options });
+    assert(errno !== 0);
+    assert.strictEqual(failedIndex, 2);
+
+    const { errno: okErrno, failedIndex: noFailure } = native.configure_socket({ fd, options: options.subarray(0, 2 * stride) });
+    assert.strictEqual(okErrno, 0);
+    assert.strictEqual(noFailure, -1);
+
+    native.close_fd({ fd });
+  });
+
+  it("should snapshot the addresses of a bound socket", () => {
+    const { fd } = native.create_socket({ oneToMany: false });
+
+    const { errno: bindErrno } = native.sctp_bindx({
+      fd,
+      sockaddrs: [sockaddrTranscoder.format({ family: "IPv4", address: "127.0.0.1", port: 0 })],
+      flags: constants.SCTP_BINDX_ADD_ADDR
+    });
+    assert.strictEqual(bindErrno, 0);
+
+    const snapshot = native.snapshot_association({ fd, withLocal: true, withPeerInfo: true });
+    assert.strictEqual(snapshot.errno, 0);
+    assert.strictEqual(snapshot.localFamily, "IPv4");
+    assert.strictEqual(snapshot.localAddress, "127.0.0.1");
+    assert(snapshot.localPort > 0);
+    assert.deepStrictEqual(snapshot.localAddresses, ["127.0.0.1"]);
+
+    // not connected, so there is nothing to report about the remote side
+    assert.strictEqual(snapshot.remoteAddress, undefined);
+    assert.strictEqual(snapshot.remoteAddresses, undefined);
+    assert.strictEqual(snapshot.peerInfo, undefined);
+
+    native.close_fd({ fd });
+  });
 });
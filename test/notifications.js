@@ -0,0 +1,82 @@
+const assert = require("node:assert");
+const notifications = require("../lib/notifications.js");
+const constants = require("../lib/constants.js");
+
+// notifications as the kernel lays them out, host byte order is assumed
+// to be little endian here
+const assocChange = ({ state, outboundStreams, inboundStreams, assocId }) => {
+  const notification = Buffer.alloc(20);
+  notification.writeUInt16LE(constants.SCTP_ASSOC_CHANGE, 0);
+  notification.writeUInt32LE(notification.length, 4);
+  notification.writeUInt16LE(state, 8);
+  notification.writeUInt16LE(outboundStreams, 12);
+  notification.writeUInt16LE(inboundStreams, 14);
+  notification.writeInt32LE(assocId, 16);
+  return notification;
+};
+
+const streamReset = ({ assocId, streams }) => {
+  const notification = Buffer.alloc(12 + streams.length * 2);
+  notification.writeUInt16LE(constants.SCTP_STREAM_RESET_EVENT, 0);
+  notification.writeUInt32LE(notification.length, 4);
+  notification.writeInt32LE(assocId, 8);
+  streams.forEach((stream, idx) => {
+    notification.writeUInt16LE(stream, 12 + idx * 2);
+  });
+  return notification;
+};
+
+describe("notifications", () => {
+  it("should decode the type and the fields needed right away", () => {
+    const notification = assocChange({ state: constants.SCTP_COMM_LOST, outboundStreams: 1, inboundStreams: 1, assocId: 3 });
+
+    assert.strictEqual(notifications.decode({ notification }), constants.SCTP_ASSOC_CHANGE);
+    assert.strictEqual(notifications.assocChangeState(), constants.SCTP_COMM_LOST);
+  });
+
+  it("should parse and interpret lazily", () => {
+    const notification = assocChange({ state: constants.SCTP_COMM_UP, outboundStreams: 7, inboundStreams: 9, assocId: 42 });
+    const event = notifications.createEvent({ notification });
+
+    // decoding another one in between must not affect the event
+    notifications.decode({ notification: streamReset({ assocId: 1, streams: [] }) });
+
+    assert.strictEqual(event.raw, notification);
+    assert.strictEqual(event.parsed.sn_type, constants.SCTP_ASSOC_CHANGE);
+    assert.deepStrictEqual(event.parsed.sn_assoc_change, {
+      sac_type: constants.SCTP_ASSOC_CHANGE,
+      sac_flags: 0,
+      sac_length: 20,
+      sac_state: constants.SCTP_COMM_UP,
+      sac_error: 0,
+      sac_outbound_streams: 7,
+      sac_inbound_streams: 9,
+      sac_assoc_id: 42
+    });
+    assert.strictEqual(event.parsed, event.parsed);
+    assert.strictEqual(event.interpreted, "SCTP_ASSOC_CHANGE: SCTP_COMM_UP, MIS 9 / OS 7");
+  });
+
+  it("should parse variable length parts", () => {
+    const parsed = notifications.parse({ notification: streamReset({ assocId: 5, streams: [3, 4] }) });
+
+    assert.deepStrictEqual(parsed.sn_strreset_event.strreset_stream_list, [3, 4]);
+    assert.strictEqual(parsed.sn_strreset_event.strreset_assoc_id, 5);
+  });
+
+  it("should not build an event without listeners", () => {
+    let emitted = 0;
+    const emitter = {
+      listenerCount: () => {
+        return 0;
+      },
+      emit: () => {
+        emitted += 1;
+      }
+    };
+
+    notifications.emit({ emitter, notification: assocChange({ state: 0, outboundStreams: 1, inboundStreams: 1, assocId: 1 }) });
+
+    assert.strictEqual(emitted, 0);
+  });
+});
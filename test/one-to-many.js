@@ -0,0 +1,177 @@
+const assert = require("node:assert");
+const lksctp = require("../lib/index.js");
+
+// make sure unhandeled rejections are thrown
+process.on("unhandledRejection", (reason) => {
+  throw reason;
+});
+
+const listen = () => {
+  return new Promise((resolve, reject) => {
+    const server = lksctp.createServer({ oneToMany: true });
+
+    server.on("error", reject);
+    server.listen({ host: "127.0.0.1", port: 0 }, () => {
+      resolve(server);
+    });
+  });
+};
+
+const connect = ({ server }) => {
+  return new Promise((resolve, reject) => {
+    const { address, port } = server.address();
+    const client = lksctp.connect({ host: address, port });
+
+    client.on("error", reject);
+    client.on("connect", () => {
+      resolve(client);
+    });
+  });
+};
+
+const receiveOne = ({ client }) => {
+  return new Promise((resolve) => {
+    client.once("data", resolve);
+  });
+};
+
+describe("one-to-many server", function () {
+  this.timeout(10000);
+
+  it("should route messages of several associations over one socket", async () => {
+    const server = await listen();
+    const associations = new Set();
+
+    server.on("connection", (association) => {
+      associations.add(association);
+
+      association.onMessage = (message, sid, ppid) => {
+        association.send(message, sid, ppid + 1);
+      };
+    });
+
+    const clients = [];
+    for (let i = 0; i < 5; i += 1) {
+      clients.push(await connect({ server }));
+    }
+
+    const replies = await Promise.all(clients.map((client, idx) => {
+      const reply = receiveOne({ client });
+
+      const message = Buffer.from(`client ${idx}`);
+      message.sid = 1;
+      message.ppid = idx;
+      client.write(message);
+
+      return reply;
+    }));
+
+    replies.forEach((reply, idx) => {
+      assert.strictEqual(reply.toString(), `client ${idx}`);
+      assert.strictEqual(reply.sid, 1);
+      assert.strictEqual(reply.ppid, idx + 1);
+    });
+
+    assert.strictEqual(associations.size, 5);
+
+    const closed = [...associations].map((association) => {
+      return new Promise((resolve) => {
+        association.once("close", resolve);
+      });
+    });
+
+    clients.forEach((client) => {
+      client.end();
+    });
+
+    await Promise.all(closed);
+
+    server.close();
+  });
+
+  it("should peel off an association into its own socket", async () => {
+    const server = await listen();
+
+    const peeledPromise = new Promise((resolve) => {
+      server.on("connection", (association) => {
+        association.once("message", () => {
+          resolve(association.peeloff());
+        });
+      });
+    });
+
+    const client = await connect({ server });
+    client.write(Buffer.from("first"));
+
+    const peeled = await peeledPromise;
+
+    const reply = receiveOne({ client });
+    peeled.onMessage = (message) => {
+      peeled.send(message);
+    };
+    client.write(Buffer.from("second"));
+
+    assert.strictEqual((await reply).toString(), "second");
+
+    const peeledClosed = new Promise((resolve) => {
+      peeled.once("close", resolve);
+    });
+
+    client.end();
+    await peeledClosed;
+
+    server.close();
+  });
+
+  it("should hand the rest of a received batch to an association peeled off from onMessage", async () => {
+    const server = await listen();
+    const numberOfMessages = 20;
+
+    const receivedPromise = new Promise((resolve) => {
+      const received = [];
+
+      server.on("connection", (association) => {
+        association.onMessage = (message) => {
+          received.push(message.toString());
+
+          const peeled = association.peeloff();
+          const remoteAddress = peeled.remoteAddress();
+
+          peeled.onMessage = (peeledMessage) => {
+            received.push(peeledMessage.toString());
+            if (received.length === numberOfMessages) {
+              resolve({ received, peeled, remoteAddress });
+            }
+          };
+        };
+      });
+    });
+
+    const client = await connect({ server });
+
+    // written at once, so they arrive in one batch
+    client.cork();
+    for (let i = 0; i < numberOfMessages; i += 1) {
+      client.write(Buffer.from(`message ${i}`));
+    }
+    client.uncork();
+
+    const { received, peeled, remoteAddress } = await receivedPromise;
+
+    received.forEach((message, idx) => {
+      assert.strictEqual(message, `message ${idx}`);
+    });
+
+    assert.strictEqual(remoteAddress.address, "127.0.0.1");
+    assert.strictEqual(remoteAddress.port, client.localPort);
+
+    const peeledClosed = new Promise((resolve) => {
+      peeled.once("close", resolve);
+    });
+
+    client.end();
+    await peeledClosed;
+
+    server.close();
+  });
+});
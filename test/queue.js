@@ -0,0 +1,180 @@
+const assert = require("node:assert");
+const queueFactory = require("../lib/queue.js");
+const microtaskSchedulerFactory = require("../lib/microtask-scheduler.js");
+
+describe("queue", () => {
+  it("should return items in FIFO order", () => {
+    const queue = queueFactory.create();
+
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+
+    assert.strictEqual(queue.length, 3);
+    assert.strictEqual(queue.peek(), 1);
+    assert.strictEqual(queue.shift(), 1);
+    assert.strictEqual(queue.shift(), 2);
+    assert.strictEqual(queue.shift(), 3);
+    assert.strictEqual(queue.length, 0);
+    assert.strictEqual(queue.shift(), undefined);
+    assert.strictEqual(queue.peek(), undefined);
+  });
+
+  it("should keep order when growing while wrapped around", () => {
+    const queue = queueFactory.create();
+    let expected = 0;
+    let next = 0;
+
+    // interleave pushes and shifts, so head moves through the buffer
+    for (let round = 0; round < 100; round += 1) {
+      for (let i = 0; i < 7; i += 1) {
+        queue.push(next);
+        next += 1;
+      }
+
+      for (let i = 0; i < 5; i += 1) {
+        assert.strictEqual(queue.shift(), expected);
+        expected += 1;
+      }
+    }
+
+    assert.strictEqual(queue.length, next - expected);
+    for (let i = 0; i < queue.length; i += 1) {
+      assert.strictEqual(queue.get(i), expected + i);
+    }
+    assert.strictEqual(queue.get(queue.length), undefined);
+  });
+});
+
+describe("microtask scheduler", () => {
+  it("should run microtasks in order and report pending correctly", async () => {
+    const scheduler = microtaskSchedulerFactory.create({ maxMicrotasksPerMacrotask: 10 });
+    let executed = [];
+
+    const first = scheduler.scheduleMicrotask(() => {
+      executed = [...executed, 1];
+    });
+    const second = scheduler.scheduleMicrotask(() => {
+      executed = [...executed, 2];
+    });
+
+    assert(first.pending());
+    assert(second.pending());
+
+    await new Promise((resolve) => {
+      setTimeout(resolve, 10);
+    });
+
+    assert.deepStrictEqual(executed, [1, 2]);
+    assert(!first.pending());
+    assert(!second.pending());
+  });
+
+  it("should not run cancelled microtasks", async () => {
+    const scheduler = microtaskSchedulerFactory.create({ maxMicrotasksPerMacrotask: 10 });
+    let executed = [];
+
+    const first = scheduler.scheduleMicrotask(() => {
+      executed = [...executed, 1];
+    });
+    scheduler.scheduleMicrotask(() => {
+      executed = [...executed, 2];
+    });
+
+    first.cancel();
+    assert(!first.pending());
+
+    await new Promise((resolve) => {
+      setTimeout(resolve, 10);
+    });
+
+    assert.deepStrictEqual(executed, [2]);
+  });
+
+  it("should interleave sockets which keep rescheduling themselves", async () => {
+    const scheduler = microtaskSchedulerFactory.create({ maxMicrotasksPerMacrotask: 100 });
+    let executed = [];
+
+    const createSocket = ({ name, steps }) => {
+      let remaining = steps;
+
+      const next = () => {
+        executed = [...executed, name];
+        remaining -= 1;
+        if (remaining > 0) {
+          scheduler.scheduleMicrotask(next);
+        }
+      };
+
+      scheduler.scheduleMicrotask(next);
+    };
+
+    createSocket({ name: "busy", steps: 5 });
+    createSocket({ name: "quiet", steps: 2 });
+
+    await new Promise((resolve) => {
+      setTimeout(resolve, 10);
+    });
+
+    assert.deepStrictEqual(executed, ["busy", "quiet", "busy", "quiet", "busy", "busy", "busy"]);
+  });
+
+  it("should continue in the next event loop turn once the budget is used up", async () => {
+    const scheduler = microtaskSchedulerFactory.create({ maxMicrotasksPerMacrotask: 2 });
+    let executed = 0;
+
+    for (let i = 0; i < 5; i += 1) {
+      scheduler.scheduleMicrotask(() => {
+        executed += 1;
+      });
+    }
+
+    await Promise.resolve();
+    assert.strictEqual(executed, 2);
+
+    await new Promise((resolve) => {
+      setImmediate(resolve);
+    });
+    assert.strictEqual(executed, 4);
+
+    await new Promise((resolve) => {
+      setTimeout(resolve, 10);
+    });
+    assert.strictEqual(executed, 5);
+  });
+
+  it("should keep running tasks after one of them threw, and still report the exception", async () => {
+    const scheduler = microtaskSchedulerFactory.create({ maxMicrotasksPerMacrotask: 10 });
+    let executed = [];
+
+    // the exception is raised as uncaught exception, collect it instead
+    // of letting mocha fail the test
+    const listeners = process.listeners("uncaughtException");
+    process.removeAllListeners("uncaughtException");
+
+    const reported = new Promise((resolve) => {
+      process.once("uncaughtException", resolve);
+    });
+
+    try {
+      scheduler.scheduleMicrotask(() => {
+        executed = [...executed, 1];
+      });
+      scheduler.scheduleMicrotask(() => {
+        throw Error("failing task");
+      });
+      scheduler.scheduleMicrotask(() => {
+        executed = [...executed, 3];
+      });
+
+      const reason = await reported;
+      assert.strictEqual(reason.message, "failing task");
+    } finally {
+      listeners.forEach((listener) => {
+        process.on("uncaughtException", listener);
+      });
+    }
+
+    assert.deepStrictEqual(executed, [1, 3]);
+  });
+});
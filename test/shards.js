@@ -0,0 +1,89 @@
+const assert = require("node:assert");
+const path = require("node:path");
+const nodeWorkerThreadsModule = require("node:worker_threads");
+const lksctp = require("../lib/index.js");
+
+// make sure unhandeled rejections are thrown
+process.on("unhandledRejection", (reason) => {
+  throw reason;
+});
+
+const request = ({ port, message }) => {
+  return new Promise((resolve, reject) => {
+    const client = lksctp.connect({ host: "127.0.0.1", port });
+
+    client.on("error", reject);
+    client.on("connect", () => {
+      client.write(Buffer.from(message));
+    });
+    client.once("data", (reply) => {
+      client.destroy();
+      resolve(reply.toString());
+    });
+  });
+};
+
+describe("shards", function () {
+  this.timeout(20000);
+
+  it("should load the native module in several worker threads at once", async () => {
+    const workers = [];
+
+    for (let i = 0; i < 4; i += 1) {
+      workers.push(new Promise((resolve, reject) => {
+        const worker = new nodeWorkerThreadsModule.Worker(`
+          const { parentPort } = require("node:worker_threads");
+          const native = require(${JSON.stringify(path.join(__dirname, "../lib/native.js"))});
+
+          const { errno, fd } = native.create_socket();
+          native.close_fd({ fd });
+          parentPort.postMessage(errno);
+        `, { eval: true });
+
+        worker.once("message", resolve);
+        worker.once("error", reject);
+      }));
+    }
+
+    const results = await Promise.all(workers);
+    results.forEach((errno) => {
+      assert.strictEqual(errno, 0);
+    });
+  });
+
+  it("should spread associations across listeners sharing a port", async () => {
+    const port = 20000 + Math.floor(Math.random() * 20000);
+
+    const shards = lksctp.shards.start({
+      filename: path.join(__dirname, "lib/shard-worker.js"),
+      count: 2,
+      listenOptions: { host: "127.0.0.1", port }
+    });
+
+    try {
+      await shards.listening;
+
+      const replies = [];
+      for (let i = 0; i < 20; i += 1) {
+        replies.push(await request({ port, message: `request ${i}` }));
+      }
+
+      const shardIndices = new Set();
+      replies.forEach((reply, idx) => {
+        const [shardIndex, message] = reply.split(":");
+        assert.strictEqual(message, `request ${idx}`);
+        shardIndices.add(shardIndex);
+      });
+
+      assert.deepStrictEqual([...shardIndices].sort(), ["0", "1"]);
+    } finally {
+      await shards.close();
+    }
+  });
+
+  it("should reject a start without a fixed port", () => {
+    assert.throws(() => {
+      lksctp.shards.start({ filename: "unused.js", count: 2, listenOptions: { port: 0 } });
+    });
+  });
+});
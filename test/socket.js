@@ -1,6 +1,12 @@
 /* eslint-disable max-statements */
 
 const assert = require("node:assert");
+const nodeWorkerThreadsModule = require("node:worker_threads");
+const lksctp = require("../lib/index.js");
+const constants = require("../lib/constants.js");
+const socketCommon = require("../lib/socket-common.js");
+const ioPoll = require("../lib/io-poll.js");
+const ioUring = require("../lib/io-uring.js");
 const socketpairFactory = require("./lib/socketpair.js");
 const { doesErrorRelateToCode } = require("./lib/error-util.js");
 
@@ -57,6 +63,39 @@ const buffersEqual = ({ buffer1, buffer2 }) => {
   return Buffer.compare(buffer1, buffer2) === 0;
 };
 
+// messages of varying size, more than one receive batch takes
+const receiveBurst = async ({ ioBackend, sid, numberOfMessages }) => {
+  await socketpairFactory.withSocketpair({
+    options: {
+      server: { socket: { ioBackend } },
+      client: { ioBackend }
+    },
+    test: async ({ server, client }) => {
+      const packetsToSend = [];
+      for (let i = 0; i < numberOfMessages; i += 1) {
+        const packet = Buffer.alloc(20 + (i % 500));
+        packet.writeUInt32BE(i, 0);
+        packet.ppid = i;
+        packet.sid = sid;
+        packetsToSend.push(packet);
+      }
+
+      const { packetsReceived } = await transmitAndShutdown({
+        sender: client,
+        receiver: server,
+        packetsToSend
+      });
+
+      assert.strictEqual(packetsReceived.length, packetsToSend.length);
+      packetsReceived.forEach((packetReceived, idx) => {
+        assert(buffersEqual({ buffer1: packetReceived, buffer2: packetsToSend[idx] }));
+        assert.strictEqual(packetReceived.ppid, idx);
+        assert.strictEqual(packetReceived.sid, sid);
+      });
+    }
+  });
+};
+
 describe("socket", function () {
   this.timeout(20000);
 
@@ -71,6 +110,46 @@ describe("socket", function () {
     });
   });
 
+  describe("accept", () => {
+    it("should accept a burst of connections larger than one accept batch", async () => {
+      const numberOfClients = 150;
+
+      const server = lksctp.createServer();
+      await new Promise((resolve) => {
+        server.listen({ host: "127.0.0.1", port: 0, backlog: numberOfClients }, resolve);
+      });
+
+      const { address, port } = server.address();
+      const serverConnections = [];
+
+      const allAccepted = new Promise((resolve, reject) => {
+        server.on("error", reject);
+        server.on("connection", (connection) => {
+          serverConnections.push(connection);
+          if (serverConnections.length === numberOfClients) {
+            resolve();
+          }
+        });
+      });
+
+      const clients = [];
+      for (let i = 0; i < numberOfClients; i += 1) {
+        clients.push(lksctp.connect({ host: address, port }));
+      }
+
+      await allAccepted;
+
+      serverConnections.forEach((connection) => {
+        assert.strictEqual(connection.remoteAddress, "127.0.0.1");
+        connection.destroy();
+      });
+      clients.forEach((client) => {
+        client.destroy();
+      });
+      server.close();
+    });
+  });
+
   describe("status", () => {
     it("should allow to retrieve stcp status", async () => {
       await socketpairFactory.withSocketpair({
@@ -126,6 +205,46 @@ describe("socket", function () {
     });
   });
 
+  describe("stats", () => {
+    it("should fill association and path stats into the given buffers", async () => {
+      await socketpairFactory.withSocketpair({
+        test: async ({ server, client }) => {
+          const buffers = lksctp.stats.create({ maxPaths: 2 });
+          const { FIELDS, PATH_FIELDS } = lksctp.stats;
+
+          await new Promise((resolve) => {
+            server.once("data", resolve);
+            client.write(Buffer.from("stats"));
+          });
+
+          const numberOfPaths = client.stats(buffers);
+
+          assert.strictEqual(numberOfPaths, 1);
+          assert.strictEqual(buffers.stats[FIELDS.state], client.status().state);
+          assert(buffers.stats[FIELDS.numberOfOutgoingStreams] > 0);
+          assert(buffers.stats[FIELDS.packetsSent] > 0);
+          assert(buffers.stats[FIELDS.orderedChunksSent] >= 1);
+          assert(buffers.paths[PATH_FIELDS.cwnd] > 0);
+          assert(buffers.paths[PATH_FIELDS.mtu] > 0);
+
+          // the same buffers are reused
+          assert.strictEqual(server.stats(buffers), 1);
+          assert(buffers.stats[FIELDS.orderedChunksReceived] >= 1);
+        }
+      });
+    });
+
+    it("should throw on buffers of the wrong type", async () => {
+      await socketpairFactory.withSocketpair({
+        test: ({ server }) => {
+          assert.throws(() => {
+            server.stats({ stats: new Uint32Array(32), paths: new Float64Array(5) });
+          });
+        }
+      });
+    });
+  });
+
   describe("MIS / OS", () => {
     describe("client", () => {
 
@@ -366,6 +485,105 @@ describe("socket", function () {
       });
     });
 
+    describe("large messages", () => {
+      const partialDeliveryPoint = 4096;
+      const messageSize = 100000;
+
+      it("should join the pieces of messages larger than the partial delivery point", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            server: { socket: { partialDeliveryPoint } }
+          },
+          test: async ({ server, client }) => {
+            const packetToSend = generatePseudoRandomBuffer({ size: messageSize });
+
+            const { packetsReceived } = await transmitAndShutdown({
+              sender: client,
+              receiver: server,
+              packetsToSend: [packetToSend]
+            });
+
+            assert.strictEqual(packetsReceived.length, 1);
+            assert(buffersEqual({ buffer1: packetsReceived[0], buffer2: packetToSend }));
+          }
+        });
+      });
+
+      it("should pass the pieces of messages larger than the partial delivery point on as chunks", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            server: { socket: { partialDeliveryPoint, partialDelivery: "chunks" } }
+          },
+          test: async ({ server, client }) => {
+            const packetToSend = generatePseudoRandomBuffer({ size: messageSize });
+
+            const { packetsReceived } = await transmitAndShutdown({
+              sender: client,
+              receiver: server,
+              packetsToSend: [packetToSend]
+            });
+
+            assert(packetsReceived.length > 1);
+            packetsReceived.forEach((chunk, idx) => {
+              assert.strictEqual(chunk.partial === true, idx < packetsReceived.length - 1);
+            });
+            assert(buffersEqual({ buffer1: Buffer.concat(packetsReceived), buffer2: packetToSend }));
+          }
+        });
+      });
+
+      it("should not split messages below the partial delivery point into chunks", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            server: { socket: { partialDelivery: "chunks" } }
+          },
+          test: async ({ server, client }) => {
+            // together larger than a receive slab
+            const packetsToSend = [1000, 20000, 30000, 40000, 50000].map((size) => {
+              return generatePseudoRandomBuffer({ size });
+            });
+
+            const { packetsReceived } = await transmitAndShutdown({
+              sender: client,
+              receiver: server,
+              packetsToSend
+            });
+
+            assert.strictEqual(packetsReceived.length, packetsToSend.length);
+            packetsReceived.forEach((packetReceived, idx) => {
+              assert.strictEqual(packetReceived.partial, undefined);
+              assert(buffersEqual({ buffer1: packetReceived, buffer2: packetsToSend[idx] }));
+            });
+          }
+        });
+      });
+
+      ["thread", "io_uring"].forEach((ioBackend) => {
+        it(`should not split messages larger than half the receive ring into chunks with the ${ioBackend} backend`, async () => {
+          await socketpairFactory.withSocketpair({
+            options: {
+              server: { socket: { ioBackend, partialDelivery: "chunks" } },
+              client: { ioBackend }
+            },
+            test: async ({ server, client }) => {
+              // the default ring is 64 KiB
+              const packetToSend = generatePseudoRandomBuffer({ size: 40 * 1024 });
+
+              const { packetsReceived } = await transmitAndShutdown({
+                sender: client,
+                receiver: server,
+                packetsToSend: [packetToSend]
+              });
+
+              assert.strictEqual(packetsReceived.length, 1);
+              assert.strictEqual(packetsReceived[0].partial, undefined);
+              assert(buffersEqual({ buffer1: packetsReceived[0], buffer2: packetToSend }));
+            }
+          });
+        });
+      });
+    });
+
     describe("shutdown", () => {
 
       const testGracefulShutdown = async ({ sender, receiver }) => {
@@ -623,6 +841,447 @@ describe("socket", function () {
       });
     });
 
+    describe("unordered / PR-SCTP", () => {
+      it("should send chunks with unordered and PR-SCTP attributes", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ server, client }) => {
+            const packetToSend = generatePseudoRandomBuffer({ size: 1000 });
+            packetToSend.unordered = true;
+            packetToSend.maxRetransmissions = 2;
+
+            const { packetsReceived } = await transmitAndShutdown({
+              sender: client,
+              receiver: server,
+              packetsToSend: [packetToSend]
+            });
+
+            assert.strictEqual(packetsReceived.length, 1);
+            assert(packetsReceived[0].equals(packetToSend));
+          }
+        });
+      });
+
+      it("should fail writes with more than one PR-SCTP policy", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ client }) => {
+            const packetToSend = Buffer.alloc(10);
+            packetToSend.ttl = 10;
+            packetToSend.priority = 1;
+
+            const error = await new Promise((resolve) => {
+              client.once("error", resolve);
+              client.write(packetToSend);
+            });
+
+            assert.strictEqual(error.message, "only one of ttl, maxRetransmissions and priority can be set");
+          }
+        });
+      });
+    });
+
+    describe("burst", () => {
+      it("should receive a burst of messages completely and in order", async () => {
+        await receiveBurst({ ioBackend: "poll", sid: 0, numberOfMessages: 2000 });
+      });
+
+      it("should send corked writes as separate messages in order", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ server, client }) => {
+            const packetsToSend = [];
+            for (let i = 0; i < 500; i += 1) {
+              const packet = Buffer.alloc(100 + i);
+              packet.writeUInt32BE(i, 0);
+              packet.ppid = i;
+              packetsToSend.push(packet);
+            }
+
+            let writeCallbacksCalled = 0;
+
+            const packetsReceived = await new Promise((resolve, reject) => {
+              let received = [];
+
+              client.on("error", reject);
+              server.on("error", reject);
+
+              server.on("data", (packetReceived) => {
+                received = [...received, packetReceived];
+                if (received.length === packetsToSend.length) {
+                  resolve(received);
+                }
+              });
+
+              client.cork();
+              packetsToSend.forEach((packetToSend) => {
+                client.write(packetToSend, (err) => {
+                  if (err) {
+                    reject(err);
+                    return;
+                  }
+
+                  writeCallbacksCalled += 1;
+                });
+              });
+              client.uncork();
+            });
+
+            assert.strictEqual(writeCallbacksCalled, packetsToSend.length);
+            packetsReceived.forEach((packetReceived, idx) => {
+              assert(buffersEqual({ buffer1: packetReceived, buffer2: packetsToSend[idx] }));
+              assert.strictEqual(packetReceived.ppid, idx);
+            });
+          }
+        });
+      });
+    });
+
+    describe("io backends", () => {
+      it("should receive a burst of messages through the rings of the io thread", async () => {
+        await receiveBurst({ ioBackend: "thread", sid: 1, numberOfMessages: 2000 });
+      });
+
+      it("should send and receive messages larger than the rings", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            server: { socket: { ioBackend: "thread", ioRingSize: 4096 } },
+            client: { ioBackend: "thread", ioRingSize: 4096 }
+          },
+          test: async ({ server, client }) => {
+            const packetsToSend = [100, 5000, 20000, 3000].map((size) => {
+              return generatePseudoRandomBuffer({ size });
+            });
+
+            const { packetsReceived } = await transmitAndShutdown({
+              sender: client,
+              receiver: server,
+              packetsToSend
+            });
+
+            assert.strictEqual(packetsReceived.length, packetsToSend.length);
+            packetsReceived.forEach((packetReceived, idx) => {
+              assert(buffersEqual({ buffer1: packetReceived, buffer2: packetsToSend[idx] }));
+            });
+          }
+        });
+      });
+
+      it("should reject ring sizes which are no power of two", () => {
+        assert.throws(() => {
+          lksctp.connect({ host: "127.0.0.1", port: 1, ioBackend: "thread", ioRingSize: 5000 });
+        });
+      });
+
+      const itWithIoUring = ioUring.isAvailable() ? it : it.skip;
+      const itWithoutIoUring = ioUring.isAvailable() ? it.skip : it;
+
+      itWithIoUring("should receive a burst of messages through the rings of io_uring", async () => {
+        assert.strictEqual(socketCommon.resolveIoBackend({ ioBackend: "io_uring" }), ioUring);
+        await receiveBurst({ ioBackend: "io_uring", sid: 1, numberOfMessages: 2000 });
+      });
+
+      itWithoutIoUring("should fall back to polling without io_uring", async () => {
+        assert.strictEqual(socketCommon.resolveIoBackend({ ioBackend: "io_uring" }), ioPoll);
+        await receiveBurst({ ioBackend: "io_uring", sid: 1, numberOfMessages: 2000 });
+      });
+
+      it("should reject unknown backends", () => {
+        assert.throws(() => {
+          lksctp.connect({ host: "127.0.0.1", port: 1, ioBackend: "unknown" });
+        });
+      });
+    });
+
+    describe("writeMessage", () => {
+      it("should send parts as one message, ordered with write()", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ server, client }) => {
+            const header = Buffer.from([1, 2, 3, 4]);
+            const payload = generatePseudoRandomBuffer({ size: 1000 });
+            const parts = [header, payload, Buffer.alloc(0), header];
+            parts.ppid = 7;
+
+            const before = Buffer.from("before");
+            const after = Buffer.from("after");
+
+            const packetsReceived = await new Promise((resolve, reject) => {
+              let received = [];
+
+              client.on("error", reject);
+              server.on("error", reject);
+
+              server.on("data", (packetReceived) => {
+                received = [...received, packetReceived];
+                if (received.length === 3) {
+                  resolve(received);
+                }
+              });
+
+              client.write(before);
+              client.writeMessage(parts);
+              client.write(after);
+            });
+
+            assert(buffersEqual({ buffer1: packetsReceived[0], buffer2: before }));
+            assert(buffersEqual({ buffer1: packetsReceived[1], buffer2: Buffer.concat(parts) }));
+            assert.strictEqual(packetsReceived[1].ppid, 7);
+            assert(buffersEqual({ buffer1: packetsReceived[2], buffer2: after }));
+          }
+        });
+      });
+
+      it("should count all parts towards writableLength", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ server, client }) => {
+            const parts = [Buffer.alloc(10), Buffer.alloc(100), Buffer.alloc(1000)];
+
+            await new Promise((resolve, reject) => {
+              client.on("error", reject);
+              server.on("error", reject);
+
+              client.writeMessage(parts, () => {
+                assert.strictEqual(client.writableLength, 0);
+                resolve();
+              });
+              assert.strictEqual(client.writableLength, 1110);
+            });
+          }
+        });
+      });
+
+      it("should report backpressure of large messages and emit drain", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ client }) => {
+            const parts = [Buffer.alloc(client.writableHighWaterMark), Buffer.alloc(1)];
+
+            assert.strictEqual(client.writeMessage(parts), false);
+
+            await new Promise((resolve) => {
+              client.once("drain", resolve);
+            });
+
+            assert(client.writableLength < client.writableHighWaterMark);
+          }
+        });
+      });
+
+      it("should reject invalid parts", async () => {
+        await socketpairFactory.withSocketpair({
+          test: ({ client }) => {
+            assert.throws(() => {
+              client.writeMessage([]);
+            });
+
+            assert.throws(() => {
+              client.writeMessage([Buffer.alloc(1), "not a buffer"]);
+            });
+          }
+        });
+      });
+    });
+
+    describe("notifications", () => {
+      const waitForSenderDry = ({ connection }) => {
+        return new Promise((resolve) => {
+          const listener = ({ parsed }) => {
+            if (parsed.sn_type === constants.SCTP_SENDER_DRY_EVENT) {
+              connection.removeListener("notification", listener);
+              resolve();
+            }
+          };
+
+          connection.on("notification", listener);
+        });
+      };
+
+      it("should deliver listed notification types", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            client: { notifications: ["SCTP_SENDER_DRY_EVENT"] }
+          },
+          test: async ({ client }) => {
+            const senderDry = waitForSenderDry({ connection: client });
+            client.write(Buffer.from("data"));
+            await senderDry;
+          }
+        });
+      });
+
+      it("should subscribe on demand once there is a notification listener", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            client: { notifications: "auto" }
+          },
+          test: async ({ client }) => {
+            const senderDry = waitForSenderDry({ connection: client });
+            client.write(Buffer.from("data"));
+            await senderDry;
+          }
+        });
+      });
+
+      it("should not deliver notification types which are not listed", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            client: { notifications: ["SCTP_ASSOC_CHANGE"] }
+          },
+          test: async ({ server, client }) => {
+            const types = [];
+            client.on("notification", ({ parsed }) => {
+              types.push(parsed.sn_type);
+            });
+
+            // a round trip, after which the send queue of the client
+            // is empty, which would raise SCTP_SENDER_DRY_EVENT
+            const reply = new Promise((resolve) => {
+              client.once("data", resolve);
+            });
+            server.once("data", (message) => {
+              server.write(message);
+            });
+            client.write(Buffer.from("data"));
+            await reply;
+
+            await new Promise((resolve) => {
+              setTimeout(resolve, 100);
+            });
+
+            assert(!types.includes(constants.SCTP_PEER_ADDR_CHANGE));
+            assert(!types.includes(constants.SCTP_SENDER_DRY_EVENT));
+          }
+        });
+      });
+    });
+
+    describe("detach / adopt", () => {
+      it("should hand an association over to a worker thread without losing messages", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ server, client }) => {
+            const worker = new nodeWorkerThreadsModule.Worker(`${__dirname}/lib/adopt-worker.js`);
+            const workerExited = new Promise((resolve) => {
+              worker.once("exit", resolve);
+            });
+
+            server.once("data", () => {
+              // the second message is either buffered on this thread
+              // or still in the socket, the worker gets it either way
+              server.pause();
+              server.write(Buffer.from("queued"));
+
+              worker.postMessage(server.detach());
+            });
+
+            const received = [];
+            const allReceived = new Promise((resolve, reject) => {
+              client.on("error", reject);
+              client.on("data", (message) => {
+                received.push(message.toString());
+
+                if (received.length === 2) {
+                  client.write(Buffer.from("third"));
+                } else if (received.length === 3) {
+                  resolve();
+                }
+              });
+            });
+
+            client.write(Buffer.from("first"));
+            client.write(Buffer.from("second"));
+
+            await allReceived;
+
+            assert.deepStrictEqual(received, ["queued", "adopted:second", "adopted:third"]);
+
+            client.end();
+            await workerExited;
+          }
+        });
+      });
+
+      it("should not detach associations of other io backends", async () => {
+        await socketpairFactory.withSocketpair({
+          options: {
+            server: { socket: { ioBackend: "thread" } }
+          },
+          test: ({ server }) => {
+            assert.throws(() => {
+              server.detach();
+            });
+          }
+        });
+      });
+    });
+
+    describe("stream channels", () => {
+      it("should deliver a stream without delay while another one is stalled", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ server, client }) => {
+            // never read, so it stalls once its high water mark is reached
+            const stalled = server.stream(3, { highWaterMark: 1024 });
+            const live = server.stream(1);
+
+            for (let i = 0; i < 100; i += 1) {
+              const message = Buffer.alloc(1000);
+              message.sid = 3;
+              client.write(message);
+            }
+
+            const received = new Promise((resolve) => {
+              live.once("data", resolve);
+            });
+
+            const start = performance.now();
+            client.stream(1).write(Buffer.from("fresh"));
+
+            const message = await received;
+            const latency = performance.now() - start;
+
+            assert.strictEqual(message.toString(), "fresh");
+            assert.strictEqual(message.sid, 1);
+            assert(stalled.readableLength > 1024);
+            assert(latency < 500, `took ${latency} ms`);
+
+            // nothing of the stalled stream is lost once it is read
+            await new Promise((resolve) => {
+              let stalledReceived = 0;
+              stalled.on("data", (data) => {
+                stalledReceived += data.length;
+                if (stalledReceived === 100 * 1000) {
+                  resolve();
+                }
+              });
+            });
+          }
+        });
+      });
+
+      it("should send with the sid of the channel, other streams arrive on the duplex", async () => {
+        await socketpairFactory.withSocketpair({
+          test: async ({ server, client }) => {
+            const received = new Promise((resolve) => {
+              server.once("data", resolve);
+            });
+
+            client.stream(2, { ppid: 42 }).write(Buffer.from("channel"));
+
+            const message = await received;
+
+            assert.strictEqual(message.toString(), "channel");
+            assert.strictEqual(message.sid, 2);
+            assert.strictEqual(message.ppid, 42);
+          }
+        });
+      });
+
+      it("should reject invalid stream ids", async () => {
+        await socketpairFactory.withSocketpair({
+          test: ({ server }) => {
+            assert.throws(() => {
+              server.stream(65536);
+            });
+          }
+        });
+      });
+    });
+
     describe("socket parameters", () => {
       it(`should support setNoDelay`, async () => {
         await socketpairFactory.withSocketpair({
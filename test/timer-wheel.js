@@ -0,0 +1,34 @@
+const assert = require("node:assert");
+const timerWheel = require("../lib/timer-wheel.js");
+
+describe("timer wheel", () => {
+  it("should run every entry about once per interval until cancelled", (done) => {
+    const interval = 100;
+    const counts = [0, 0, 0];
+
+    const entries = counts.map((_, idx) => {
+      return timerWheel.schedule({
+        interval,
+        callback: () => {
+          counts[idx] += 1;
+        }
+      });
+    });
+
+    setTimeout(() => {
+      entries.forEach((entry) => {
+        entry.cancel();
+      });
+
+      counts.forEach((count) => {
+        assert.ok(count >= 3 && count <= 6, `ran ${count} times`);
+      });
+
+      const cancelledCounts = [...counts];
+      setTimeout(() => {
+        assert.deepStrictEqual(counts, cancelledCounts);
+        done();
+      }, 2 * interval);
+    }, 4.5 * interval);
+  });
+});